@@ -0,0 +1,42 @@
+#pragma once
+
+// Demonstrator
+#include <demonstrator>
+
+// The demonstrator is wired to two Raspberry Pis, each with its own board profile. Any pin conflict within a profile is reported at compile time.
+// **Note:** The distance sensors use pins 10 and 11, which are part of the SPI block. Therefore, SPI can't be used on the sensors Pi.
+
+/**
+ * Trigger/echo pins of the six HC-SR04 distance sensors.
+ */
+using DistanceSensorPins = demo::Pins<17, 27, 22, 10, 25, 11>;
+
+/**
+ * Data pins of the six LED bars (one per distance sensor).
+ */
+using DistanceIndicatorDataPins = demo::Pins<12, 5, 6, 13, 19, 26>;
+
+/**
+ * Shared clock pin of all LED bars.
+ */
+using DistanceIndicatorClockPin = demo::Pins<21>;
+
+using SensorsPi = demo::BoardProfile<DistanceSensorPins, DistanceIndicatorDataPins, DistanceIndicatorClockPin>;
+
+/**
+ * Protocol timings of the devices attached to the sensors Pi, to be passed to `demo::DistanceIndicators`.
+ */
+constexpr demo::BoardTimings sensorsPiTimings = demo::BoardTimings();
+
+/**
+ * Direction pins of the six servo controllers.
+ */
+using DirectionPins = demo::Pins<22, 5, 6, 13, 19, 26>;
+
+// The motors Pi reads the extension sensors via SPI, sets the servo speeds via I2C and reads the attitude sensor via UART.
+using MotorsPi = demo::BoardProfile<DirectionPins, demo::SpiPins, demo::I2cPins, demo::UartPins>;
+
+/**
+ * Protocol timings of the devices attached to the motors Pi, to be passed to `demo::ServoControllers`.
+ */
+constexpr demo::BoardTimings motorsPiTimings = demo::BoardTimings();
@@ -3,13 +3,11 @@
 #include <iomanip>
 #include <thread>
 
-// WiringPi
-#include <wiringPi.h>
-
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 void showHelp();
@@ -30,9 +28,9 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
 
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
 
   demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
   extensionSensors.setNumberOfSamplesPerMeasurment(3);
@@ -44,14 +42,8 @@ int main (const int argc, const char* argv[]) {
     std::cout << "Could not find extension sensor correction file. Displaying uncorrected measurements." << std::endl;
   }
   
-  std::vector<demo::Pin> directionPins;
-  directionPins.push_back(demo::Gpio::allocatePin(22));
-  directionPins.push_back(demo::Gpio::allocatePin(5));
-  directionPins.push_back(demo::Gpio::allocatePin(6));
-  directionPins.push_back(demo::Gpio::allocatePin(13));
-  directionPins.push_back(demo::Gpio::allocatePin(19));
-  directionPins.push_back(demo::Gpio::allocatePin(26));
-  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0);
+  std::vector<demo::Pin> directionPins = MotorsPi::allocate<DirectionPins>();
+  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0, motorsPiTimings);
   
   demo::LinearActuators linearActuators(std::move(servoControllers), std::move(extensionSensors), 0.178, 0.248);
   linearActuators.setAcceptableExtensionDeviation(0.005);
@@ -85,6 +77,7 @@ void showHelp() {
   std::cout << "    Sets the current attitudes as (0, 0, 0).\n";
   std::cout << "\n";
   std::cout << "  Options:\n";
+  std::cout << "         --simulate   Uses simulated devices instead of the Raspberry Pi's hardware\n";
   std::cout << "         --verbose    Prints additional (debug) information\n";
   std::cout << "    -h | --help       Displays this help\n";
   std::cout << std::flush; 
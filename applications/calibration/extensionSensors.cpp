@@ -2,13 +2,11 @@
 #include <chrono>
 #include <thread>
 
-// WiringPi
-#include <wiringPi.h>
-
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 void showHelp();
@@ -28,21 +26,15 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
 
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
 
   demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
   extensionSensors.setNumberOfSamplesPerMeasurment(1);
 
-  std::vector<demo::Pin> directionPins;
-  directionPins.push_back(demo::Gpio::allocatePin(22));
-  directionPins.push_back(demo::Gpio::allocatePin(5));
-  directionPins.push_back(demo::Gpio::allocatePin(6));
-  directionPins.push_back(demo::Gpio::allocatePin(13));
-  directionPins.push_back(demo::Gpio::allocatePin(19));
-  directionPins.push_back(demo::Gpio::allocatePin(26));
-  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0);
+  std::vector<demo::Pin> directionPins = MotorsPi::allocate<DirectionPins>();
+  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0, motorsPiTimings);
 
   demo::LinearActuators linearActuators(std::move(servoControllers), std::move(extensionSensors), 0.178, 0.248);
   linearActuators.setAcceptableExtensionDeviation(0.005);
@@ -58,6 +50,7 @@ void showHelp() {
             << "    Moves all actuators up by 10%, then expects the user to measure and enter the true extension to calculate adjustments.\n"
             << "\n"
             << "  Options:\n"
+            << "         --simulate   Uses simulated devices instead of the Raspberry Pi's hardware\n"
             << "         --verbose    Prints additional (debug) information\n"
             << "    -h | --help       Displays this help\n"
             << std::flush;
@@ -2,6 +2,8 @@
 
 // C++ standard library
 #include <algorithm>
+#include <iostream>
+#include <stdexcept>
 
 bool hasOption(
     const int argc,
@@ -10,6 +12,18 @@ bool hasOption(
   return std::find(argv, argv + argc, option) != argv + argc;
 }
 
+std::string getOptionValue(
+    const int argc,
+    const char* argv[],
+    const std::string& option) {
+  const char** position = std::find(argv, argv + argc, option);
+  if (position == argv + argc || position + 1 == argv + argc) {
+    return "";
+  }
+
+  return *(position + 1);
+}
+
 bool isNumber(
     const std::string& text) {
   try {
@@ -42,4 +56,18 @@ arma::Row<double> stringToVector(
   }
   
   return vector;
-}
\ No newline at end of file
+}
+
+demo::Spi allocateSpi(
+    const std::string& clockFrequency) {
+  demo::Spi spi = demo::Gpio::allocateSpi();
+  if (isNumber(clockFrequency)) {
+    try {
+      spi.useSpiDevice(std::stoul(clockFrequency));
+    } catch (const std::runtime_error& exception) {
+      std::cout << exception.what() << " Falling back to bit-banging." << std::endl;
+    }
+  }
+
+  return spi;
+}
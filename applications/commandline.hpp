@@ -6,11 +6,22 @@
 // Armadillo
 #include <armadillo>
 
+// Demonstrator
+#include <demonstrator>
+
 bool hasOption(
     const int argc,
     const char* argv[],
     const std::string& option);
 
+/**
+ * Returns the argument following `option` (e.g. `path` for `--gpiomem path`), or an empty string if `option` is missing or the last argument.
+ */
+std::string getOptionValue(
+    const int argc,
+    const char* argv[],
+    const std::string& option);
+
 bool isNumber(
     const std::string& text);
     
@@ -18,4 +29,10 @@ std::string vectorToString(
     const arma::Row<double>& vector);
     
 arma::Row<double> stringToVector(
-    std::string string);
\ No newline at end of file
+    std::string string);
+
+/**
+ * Allocates the SPI bus and switches it to /dev/spidev0.0, clocked at `clockFrequency` Hz (e.g. the value of `--spidev hz`). Keeps bit-banging if `clockFrequency` isn't a number or the device can't be opened.
+ */
+demo::Spi allocateSpi(
+    const std::string& clockFrequency);
\ No newline at end of file
@@ -4,21 +4,19 @@
 #include <atomic>
 #include <thread>
 
-// Wiring Pi
-#include <wiringPi.h>
-
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 arma::Col<double>::fixed<6> endEffectorPose = {0.0, 0.0, 0.24, 0.0, 0.0, 0.0};
 
-int main(int argc, char **argv) {
-  // Initializes WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+int main(const int argc, const char* argv[]) {
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
 
   demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
   extensionSensors.setNumberOfSamplesPerMeasurment(3);
@@ -30,14 +28,8 @@ int main(int argc, char **argv) {
     std::cout << "Could not find extension sensor correction file. Displaying uncorrected measurements." << std::endl;
   }
 
-  std::vector<demo::Pin> directionPins;
-  directionPins.push_back(demo::Gpio::allocatePin(22));
-  directionPins.push_back(demo::Gpio::allocatePin( 5));
-  directionPins.push_back(demo::Gpio::allocatePin( 6));
-  directionPins.push_back(demo::Gpio::allocatePin(13));
-  directionPins.push_back(demo::Gpio::allocatePin(19));
-  directionPins.push_back(demo::Gpio::allocatePin(26));
-  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0);
+  std::vector<demo::Pin> directionPins = MotorsPi::allocate<DirectionPins>();
+  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0, motorsPiTimings);
 
   demo::LinearActuators linearActuators(std::move(servoControllers), std::move(extensionSensors), 0.178, 0.248);
   linearActuators.setAcceptableExtensionDeviation(0.005);
@@ -2,23 +2,22 @@
 #include <string>
 #include <iostream>
 #include <atomic>
+#include <memory>
 #include <thread>
 
-// Wiring Pi
-#include <wiringPi.h>
-
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 arma::Col<double>::fixed<6> endEffectorPose = {0.0, 0.0, 0.24, 0.0, 0.0, 0.0};
 
-int main(const int argc, const char **argv) {
-  // Initializes WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+int main(const int argc, const char* argv[]) {
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
 
   double maximalSpeed;
   double acceptableExtensionDeviation;
@@ -48,14 +47,11 @@ int main(const int argc, const char **argv) {
     std::cout << "Could not find extension sensor correction file. Displaying uncorrected measurements." << std::endl;
   }
 
-  std::vector<demo::Pin> directionPins;
-  directionPins.push_back(demo::Gpio::allocatePin(22));
-  directionPins.push_back(demo::Gpio::allocatePin( 5));
-  directionPins.push_back(demo::Gpio::allocatePin( 6));
-  directionPins.push_back(demo::Gpio::allocatePin(13));
-  directionPins.push_back(demo::Gpio::allocatePin(19));
-  directionPins.push_back(demo::Gpio::allocatePin(26));
-  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, maximalSpeed);
+  std::vector<demo::Pin> directionPins = MotorsPi::allocate<DirectionPins>();
+  // The actuators' control loop only submits its updates, instead of waiting for the I2C bus.
+  std::shared_ptr<demo::I2cBus> i2cBus = demo::Gpio::allocateI2cBus();
+  i2cBus->runAsynchronous();
+  demo::ServoControllers servoControllers(std::move(directionPins), i2cBus->getDevice(0x40), {0, 1, 2, 3, 4, 5}, maximalSpeed, motorsPiTimings);
 
   demo::LinearActuators linearActuators(std::move(servoControllers), std::move(extensionSensors), 0.178, 0.248);
   linearActuators.setAcceptableExtensionDeviation(acceptableExtensionDeviation);
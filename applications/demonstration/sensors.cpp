@@ -1,70 +1,66 @@
 // C++ standard library
 #include <string>
 #include <iostream>
-#include <atomic>
-#include <thread>
-
-// Wiring Pi
-#include <wiringPi.h>
+#include <chrono>
+#include <cstddef>
 
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
-void networkControl();
-
-std::atomic<bool> running;
-arma::Row<double> distances;
+void networkControl(
+    const demo::DistanceSensors& distanceSensors);
 
-int main(int argc, char **argv) {
-  // Initializes WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+int main(const int argc, const char* argv[]) {
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
 
-  std::vector<demo::Pin> sensorPins;
-  sensorPins.push_back(demo::Gpio::allocatePin(17));
-  sensorPins.push_back(demo::Gpio::allocatePin(27));
-  sensorPins.push_back(demo::Gpio::allocatePin(22));
-  sensorPins.push_back(demo::Gpio::allocatePin(10));
-  sensorPins.push_back(demo::Gpio::allocatePin(25));
-  sensorPins.push_back(demo::Gpio::allocatePin(11));
+  std::vector<demo::Pin> sensorPins = SensorsPi::allocate<DistanceSensorPins>();
   demo::DistanceSensors distanceSensors(std::move(sensorPins), 0.03, 0.35);
+  // Publishes the median of each sensor's last 3 ranges, so that a single missed echo doesn't flash the bars.
   distanceSensors.setNumberOfSamplesPerMeasurment(3);
+  if (hasOption(argc, argv, "--concurrent")) {
+    // Opposite sensors face away from each other and therefore don't hear each other's bursts.
+    distanceSensors.setRangingGroups({{0, 3}, {1, 4}, {2, 5}});
+  }
 
-  std::vector<demo::Pin> dataPins;
-  dataPins.push_back(demo::Gpio::allocatePin(12));
-  dataPins.push_back(demo::Gpio::allocatePin( 5));
-  dataPins.push_back(demo::Gpio::allocatePin( 6));
-  dataPins.push_back(demo::Gpio::allocatePin(13));
-  dataPins.push_back(demo::Gpio::allocatePin(19));
-  dataPins.push_back(demo::Gpio::allocatePin(26));
-  demo::DistanceIndicators distanceIndicators(demo::Gpio::allocatePin(21), std::move(dataPins), 0.05, 0.08, 0.20);
+  std::vector<demo::Pin> dataPins = SensorsPi::allocate<DistanceIndicatorDataPins>();
+  demo::DistanceIndicators distanceIndicators(SensorsPi::allocatePin<DistanceIndicatorClockPin>(), std::move(dataPins), 0.05, 0.08, 0.20, sensorsPiTimings);
 
-  running = true;
-  std::thread networkThread(networkControl);
+  // Sends the indications in a separate thread (at most 50 frames per second), so that the ranging thread doesn't wait for the LED bars.
+  distanceIndicators.runAsynchronous(std::chrono::milliseconds(20));
 
-  while (running) {
-    distances = distanceSensors.measure();
-    distanceIndicators.setIndication(distances);
-  }
+  // Each bar follows its sensor's latest range, but is only resent if its band changed.
+  distanceSensors.subscribe([&distanceIndicators](const std::size_t n, const double distance) {
+    distanceIndicators.setIndication(n, distance);
+  });
+
+  // Ranges each sensor every 60 milliseconds, as suggested by the data sheet.
+  distanceSensors.runAsynchronous(std::chrono::milliseconds(60));
 
-  networkThread.join();
+  networkControl(distanceSensors);
+
+  distanceSensors.stopAsynchronous();
   return EXIT_SUCCESS;
 }
 
-void networkControl() {
+void networkControl(
+    const demo::DistanceSensors& distanceSensors) {
   std::string message = "";
   demo::Network network(31415);
+  arma::Row<double> distances(DistanceSensorPins::size);
+  std::chrono::steady_clock::time_point rangeTime;
 
   do {
     message = network.receive();
 
-    if (message.substr(0, 3) == "get") {
+    // Served from the latest snapshot, instead of waiting for the echoes.
+    if (message.substr(0, 3) == "get" && distanceSensors.getLatestDistances(distances, rangeTime)) {
       network.send("192.168.0.16", 31415, vectorToString(distances));
     }
-  } while (message != "exit" && running);
-
-  running = false;
+  } while (message != "exit");
 }
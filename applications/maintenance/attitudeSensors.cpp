@@ -3,9 +3,6 @@
 #include <iomanip>
 #include <thread>
 
-// WiringPi
-#include <wiringPi.h>
-
 // Demonstrator
 #include <demonstrator>
 
@@ -27,9 +24,9 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
 
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
 
   demo::AttitudeSensors attitudeSensors(demo::Gpio::allocateUart(), -arma::datum::pi, arma::datum::pi);
 
@@ -47,6 +44,7 @@ void showHelp() {
   std::cout << "    Starts the sensor calibration\n";
   std::cout << "\n";
   std::cout << "  Options:\n";
+  std::cout << "         --simulate   Uses simulated devices instead of the Raspberry Pi's hardware\n";
   std::cout << "         --verbose    Prints additional (debug) information\n";
   std::cout << "    -h | --help       Displays this help\n";
   std::cout << std::flush;
@@ -1,15 +1,18 @@
 // C++ standard library
+#include <bitset>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iomanip>
+#include <string>
 #include <thread>
-
-// WiringPi
-#include <wiringPi.h>
+#include <vector>
 
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 void showHelp();
@@ -18,6 +21,8 @@ void runDefault(
 void runSensor(
     demo::DistanceIndicators& distanceIndicators,
     demo::DistanceSensors& distanceSensors);
+void runBenchmark(
+    const std::size_t numberOfFrames);
 
 int main (const int argc, const char* argv[]) {
   if (hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
@@ -30,26 +35,26 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
   
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
-  
-  std::vector<demo::Pin> dataPins;
-  dataPins.push_back(demo::Gpio::allocatePin(12));
-  dataPins.push_back(demo::Gpio::allocatePin(5));
-  dataPins.push_back(demo::Gpio::allocatePin(6));
-  dataPins.push_back(demo::Gpio::allocatePin(13));
-  dataPins.push_back(demo::Gpio::allocatePin(19));
-  dataPins.push_back(demo::Gpio::allocatePin(26));
-  demo::DistanceIndicators distanceIndicators(demo::Gpio::allocatePin(21), std::move(dataPins), 0.05, 0.08, 0.20);
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
+
+  if (hasOption(argc, argv, "benchmark")) {
+    // A file-backed stand-in allows to run this benchmark on any Linux machine.
+    const std::string& gpiomemPath = getOptionValue(argc, argv, "--gpiomem");
+    if (!gpiomemPath.empty()) {
+      demo::GpioRegisters::map(gpiomemPath);
+      demo::Gpio::setBackend(std::make_shared<demo::GpioMemBackend>());
+    }
+
+    runBenchmark(isNumber(getOptionValue(argc, argv, "--frames")) ? std::stoul(getOptionValue(argc, argv, "--frames")) : 1000);
+    return 0;
+  }
+
+  std::vector<demo::Pin> dataPins = SensorsPi::allocate<DistanceIndicatorDataPins>();
+  demo::DistanceIndicators distanceIndicators(SensorsPi::allocatePin<DistanceIndicatorClockPin>(), std::move(dataPins), 0.05, 0.08, 0.20, sensorsPiTimings);
   
-  std::vector<demo::Pin> pins;
-  pins.push_back(demo::Gpio::allocatePin(17));
-  pins.push_back(demo::Gpio::allocatePin(27));
-  pins.push_back(demo::Gpio::allocatePin(22));
-  pins.push_back(demo::Gpio::allocatePin(10));
-  pins.push_back(demo::Gpio::allocatePin(25));
-  pins.push_back(demo::Gpio::allocatePin(11));
+  std::vector<demo::Pin> pins = SensorsPi::allocate<DistanceSensorPins>();
   demo::DistanceSensors distanceSensors(std::move(pins), 0.03, 0.35);
   distanceSensors.setNumberOfSamplesPerMeasurment(3);
   
@@ -70,7 +75,13 @@ void showHelp() {
   std::cout << "  program sensor [options ...]\n";
   std::cout << "    Uses the distance sensors as input devices\n";
   std::cout << "\n";
+  std::cout << "  program benchmark [options ...]\n";
+  std::cout << "    Prints the average time to send a frame to all LED bars, writing the data pins one by one, as a precompiled group and through the board profile\n";
+  std::cout << "      --frames n       Number of frames per measurement (default: 1000)\n";
+  std::cout << "      --gpiomem path   Maps `path` instead of /dev/gpiomem, e.g. a file of at least 4 KiB on a non-Raspberry Pi machine\n";
+  std::cout << "\n";
   std::cout << "  Options:\n";
+  std::cout << "         --simulate   Uses simulated devices instead of the Raspberry Pi's hardware\n";
   std::cout << "         --verbose    Prints additional (debug) information\n";
   std::cout << "    -h | --help       Displays this help\n";
   std::cout << std::flush;
@@ -109,3 +120,118 @@ void runSensor(
     }
   }
 }
+
+void runBenchmark(
+    const std::size_t numberOfFrames) {
+  // Verbose output would dominate the measurement.
+  ::demo::isVerbose = false;
+
+  // Every bar shows a different pattern, so that the data pins don't change all together.
+  std::vector<std::bitset<12>> states;
+  for (std::size_t n = 0; n < DistanceIndicatorDataPins::size; ++n) {
+    states.push_back(0b001111111100 >> n);
+  }
+
+  double pinByPinFrameTime;
+  {
+    demo::Pin clockPin = SensorsPi::allocatePin<DistanceIndicatorClockPin>();
+    std::vector<demo::Pin> dataPins = SensorsPi::allocate<DistanceIndicatorDataPins>();
+
+    // Sends the same frame as `demo::DistanceIndicators::setIndication`, but sets one data pin after another.
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0; frame < numberOfFrames; ++frame) {
+      unsigned int clock = 0;
+      for (unsigned int i = 16; i > 0; --i) {
+        for (auto& pin : dataPins) {
+          pin.set(0x310 & (1 << (i - 1)));
+        }
+        clockPin.set(++clock % 2);
+      }
+
+      for (unsigned int led = 0; led < 12; ++led) {
+        for (std::size_t bar = 0; bar < dataPins.size(); ++bar) {
+          dataPins.at(bar).set(states.at(bar).test(led));
+        }
+        for (unsigned int i = 0; i < 16; ++i) {
+          clockPin.set(++clock % 2);
+        }
+      }
+
+      demo::timing::wait(sensorsPiTimings.indicatorLatchDelay);
+      for (auto& pin : dataPins) {
+        pin.set(demo::Pin::Digital::Low);
+        for (unsigned int i = 0; i < 4; ++i) {
+          pin.set(demo::Pin::Digital::High);
+          pin.set(demo::Pin::Digital::Low);
+        }
+      }
+    }
+    pinByPinFrameTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfFrames);
+  }
+
+  double groupedFrameTime;
+  {
+    std::vector<demo::Pin> dataPins = SensorsPi::allocate<DistanceIndicatorDataPins>();
+    demo::DistanceIndicators distanceIndicators(SensorsPi::allocatePin<DistanceIndicatorClockPin>(), std::move(dataPins), 0.05, 0.08, 0.20, sensorsPiTimings);
+    const arma::Row<double>& distances = arma::linspace<arma::Row<double>>(distanceIndicators.minimalDistance_, distanceIndicators.maximalDistance_, distanceIndicators.numberOfIndicators_);
+
+    distanceIndicators.setIndication(distances);
+
+    // Unchanged frames are skipped by `setIndication()`, so each frame is resent instead.
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0; frame < numberOfFrames; ++frame) {
+      distanceIndicators.refreshIndication();
+    }
+    groupedFrameTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfFrames);
+  }
+
+  double boardProfileFrameTime;
+  {
+    // Holds the ownership of the pins, while they are accessed through the board profile's unchecked accessors.
+    demo::Pin clockPin = SensorsPi::allocatePin<DistanceIndicatorClockPin>();
+    std::vector<demo::Pin> dataPins = SensorsPi::allocate<DistanceIndicatorDataPins>();
+    DistanceIndicatorClockPin::setMode(demo::Backend::Mode::Output);
+    DistanceIndicatorDataPins::setMode(demo::Backend::Mode::Output);
+
+    const std::uint32_t allDataPins = (1u << DistanceIndicatorDataPins::size) - 1;
+    std::vector<std::uint32_t> ledDataPins(12, 0);
+    for (unsigned int led = 0; led < 12; ++led) {
+      for (std::size_t bar = 0; bar < DistanceIndicatorDataPins::size; ++bar) {
+        ledDataPins.at(led) |= static_cast<std::uint32_t>(states.at(bar).test(led)) << bar;
+      }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0; frame < numberOfFrames; ++frame) {
+      unsigned int clock = 0;
+      for (unsigned int i = 16; i > 0; --i) {
+        DistanceIndicatorDataPins::write(0x310 & (1 << (i - 1)) ? allDataPins : 0);
+        DistanceIndicatorClockPin::write(++clock % 2);
+      }
+
+      for (unsigned int led = 0; led < 12; ++led) {
+        DistanceIndicatorDataPins::write(ledDataPins.at(led));
+        for (unsigned int i = 0; i < 16; ++i) {
+          DistanceIndicatorClockPin::write(++clock % 2);
+        }
+      }
+
+      demo::timing::wait(sensorsPiTimings.indicatorLatchDelay);
+      DistanceIndicatorDataPins::write(0);
+      for (unsigned int i = 0; i < 4; ++i) {
+        DistanceIndicatorDataPins::write(allDataPins);
+        DistanceIndicatorDataPins::write(0);
+      }
+    }
+    boardProfileFrameTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfFrames);
+  }
+
+  std::cout << "+----------------------+-----------------+\n"
+            << "| Data pins            | Frame time [us] |\n"
+            << "+----------------------+-----------------+\n"
+            << "| One by one           | " << std::setw(15) << pinByPinFrameTime << " |\n"
+            << "| Precompiled group    | " << std::setw(15) << groupedFrameTime << " |\n"
+            << "| Board profile        | " << std::setw(15) << boardProfileFrameTime << " |\n"
+            << "+----------------------+-----------------+" << std::endl;
+  std::cout << "**Note:** All frame times include the " << sensorsPiTimings.indicatorLatchDelay.count() << "us latch delay." << std::endl;
+}
@@ -1,15 +1,21 @@
 // C++ standard library
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <iomanip>
+#include <memory>
+#include <ratio>
+#include <string>
 #include <thread>
-
-// WiringPi
-#include <wiringPi.h>
+#include <utility>
+#include <vector>
 
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 bool useDistanceIndicators = false;
@@ -17,6 +23,9 @@ bool useDistanceIndicators = false;
 void showHelp();
 void runDefault(
     demo::DistanceSensors&, demo::DistanceIndicators&);
+void runBenchmark(
+    demo::DistanceSensors& distanceSensors,
+    const std::size_t numberOfMeasurements);
 
 int main (const int argc, const char* argv[]) {
   if (hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
@@ -33,28 +42,39 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
 
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
-
-  std::vector<demo::Pin> pins;
-  pins.push_back(demo::Gpio::allocatePin(17));
-  pins.push_back(demo::Gpio::allocatePin(27));
-  pins.push_back(demo::Gpio::allocatePin(22));
-  pins.push_back(demo::Gpio::allocatePin(10));
-  pins.push_back(demo::Gpio::allocatePin(25));
-  pins.push_back(demo::Gpio::allocatePin(11));
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
+
+  const std::string& tracePath = getOptionValue(argc, argv, "--trace");
+  if (!tracePath.empty()) {
+    demo::trace::start(tracePath);
+  }
+
+  std::vector<demo::Pin> pins = SensorsPi::allocate<DistanceSensorPins>();
   demo::DistanceSensors distanceSensors(std::move(pins), 0.03, 0.35);
-  distanceSensors.setNumberOfSamplesPerMeasurment(3);
+  if (hasOption(argc, argv, "--filter")) {
+    // A single missed echo reads as the maximal distance, so outliers are clipped before the running median removes them.
+    distanceSensors.setSampleFilter(std::unique_ptr<demo::SampleFilter>(new demo::SampleFilterPipeline<demo::sampleFilters::OutlierClipping<std::ratio<5, 100>>, demo::sampleFilters::RunningMedian<5>, demo::sampleFilters::ExponentialMovingAverage<std::ratio<1, 2>>>(distanceSensors.numberOfSensors_)));
+  } else {
+    distanceSensors.setNumberOfSamplesPerMeasurment(3);
+  }
+  if (hasOption(argc, argv, "--gpiochip")) {
+    distanceSensors.useGpioChipEdgeEvents(getOptionValue(argc, argv, "--gpiochip"));
+  }
 
-  std::vector<demo::Pin> dataPins;
-  dataPins.push_back(demo::Gpio::allocatePin(12));
-  dataPins.push_back(demo::Gpio::allocatePin(5));
-  dataPins.push_back(demo::Gpio::allocatePin(6));
-  dataPins.push_back(demo::Gpio::allocatePin(13));
-  dataPins.push_back(demo::Gpio::allocatePin(19));
-  dataPins.push_back(demo::Gpio::allocatePin(26));
-  demo::DistanceIndicators distanceIndicators(demo::Gpio::allocatePin(21), std::move(dataPins), 0.05, 0.08, 0.20);
+  if (hasOption(argc, argv, "benchmark")) {
+    runBenchmark(distanceSensors, isNumber(getOptionValue(argc, argv, "--measurements")) ? std::stoul(getOptionValue(argc, argv, "--measurements")) : 100);
+    return 0;
+  }
+
+  if (hasOption(argc, argv, "--concurrent")) {
+    // Opposite sensors face away from each other and therefore don't hear each other's bursts.
+    distanceSensors.setRangingGroups({{0, 3}, {1, 4}, {2, 5}});
+  }
+
+  std::vector<demo::Pin> dataPins = SensorsPi::allocate<DistanceIndicatorDataPins>();
+  demo::DistanceIndicators distanceIndicators(SensorsPi::allocatePin<DistanceIndicatorClockPin>(), std::move(dataPins), 0.05, 0.08, 0.20, sensorsPiTimings);
 
   runDefault(distanceSensors, distanceIndicators);
 
@@ -72,8 +92,18 @@ void showHelp() {
   std::cout << "  program evasion [options ...]\n";
   std::cout << "    Sends the measured distances to the motor Pi\n";
   std::cout << "\n";
+  std::cout << "  program benchmark [options ...]\n";
+  std::cout << "    Prints the average measurement time when ranging sequentially, in opposite pairs and all at once,\n";
+  std::cout << "    as well as how far the mean distances deviate from sequential ranging (i.e. the crosstalk)\n";
+  std::cout << "      --measurements n Number of measurements per schedule (default: 100)\n";
+  std::cout << "\n";
   std::cout << "  Options:\n";
   std::cout << "         --indicators    Uses the distance indicators as additional output devices\n";
+  std::cout << "         --concurrent    Triggers opposite sensors together, instead of one sensor after another\n";
+  std::cout << "         --filter        Reads each sensor once per measurement, filtered over the previous ones, instead of taking the median of 3 reads\n";
+  std::cout << "         --gpiochip path Uses kernel-timestamped edge events of `path` (e.g. /dev/gpiochip0) instead of polling the echo pins\n";
+  std::cout << "         --simulate      Uses simulated devices instead of the Raspberry Pi's hardware\n";
+  std::cout << "         --trace path    Records all pin, SPI and I2C accesses into `path`, to be decoded by maintainTrace\n";
   std::cout << "         --verbose       Prints additional (debug) information\n";
   std::cout << "    -h | --help          Displays this help\n";
   std::cout << std::flush;
@@ -100,3 +130,45 @@ void runDefault(
     }
   }
 }
+
+void runBenchmark(
+    demo::DistanceSensors& distanceSensors,
+    const std::size_t numberOfMeasurements) {
+  std::cout << "+-----------------+------------------+------------+------------------------------+\n"
+            << "| Schedule        | Measurement [ms] | Guard [ms] | Max. mean deviation [m]      |\n"
+            << "+-----------------+------------------+------------+------------------------------+" << std::endl;
+
+  arma::Row<double> sequentialMeanDistances;
+  const std::vector<std::pair<std::string, std::vector<std::vector<std::size_t>>>> schedules = {
+    {"Sequential", {{0}, {1}, {2}, {3}, {4}, {5}}},
+    {"Opposite pairs", {{0, 3}, {1, 4}, {2, 5}}},
+    {"All at once", {{0, 1, 2, 3, 4, 5}}}};
+  for (const auto& schedule : schedules) {
+    distanceSensors.setRangingGroups(schedule.second);
+
+    arma::Row<double> distances(distanceSensors.numberOfSensors_);
+    arma::Row<double> meanDistances(distanceSensors.numberOfSensors_);
+    meanDistances.zeros();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < numberOfMeasurements; ++n) {
+      distanceSensors.measureInto(distances);
+      meanDistances += distances / static_cast<double>(numberOfMeasurements);
+    }
+    const double measurementTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfMeasurements);
+
+    if (sequentialMeanDistances.n_elem == 0) {
+      sequentialMeanDistances = meanDistances;
+    }
+    double maximalMeanDeviation = 0.0;
+    for (std::size_t k = 0; k < distanceSensors.numberOfSensors_; ++k) {
+      maximalMeanDeviation = std::max(maximalMeanDeviation, std::abs(meanDistances(k) - sequentialMeanDistances(k)));
+    }
+
+    std::cout << "| " << std::left << std::setw(15) << schedule.first << std::right << std::fixed << std::setprecision(2)
+              << " | " << std::setw(16) << measurementTime
+              << " | " << std::setw(10) << static_cast<double>(distanceSensors.getRangingGroupGuardTime().count()) / 1000.0
+              << " | " << std::setw(28) << std::setprecision(4) << maximalMeanDeviation << " |" << std::endl;
+  }
+  std::cout << "+-----------------+------------------+------------+------------------------------+" << std::endl;
+  std::cout << "The measurement time includes the guard time before each ranging group (by default, only if a group holds more than one sensor)." << std::endl;
+}
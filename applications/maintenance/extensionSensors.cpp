@@ -1,10 +1,15 @@
 // C++ standard library
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <thread>
-
-// WiringPi
-#include <wiringPi.h>
+#include <utility>
+#include <vector>
 
 // Demonstrator
 #include <demonstrator>
@@ -15,6 +20,15 @@
 void showHelp();
 void runDefault(
     demo::ExtensionSensors&);
+void runBenchmark(
+    const std::string& clockFrequency,
+    const std::size_t numberOfMeasurements,
+    const std::chrono::microseconds samplingInterval);
+void runMeasurementBenchmark(
+    const std::size_t numberOfMeasurements,
+    const std::chrono::microseconds samplingInterval);
+void runAdaptiveSamplingBenchmark(
+    const std::size_t numberOfMeasurements);
 
 int main (const int argc, const char* argv[]) {
   if (hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
@@ -27,11 +41,26 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
 
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
+
+  const std::string& tracePath = getOptionValue(argc, argv, "--trace");
+  if (!tracePath.empty()) {
+    demo::trace::start(tracePath);
+  }
+
+  if (hasOption(argc, argv, "adaptive")) {
+    runAdaptiveSamplingBenchmark(isNumber(getOptionValue(argc, argv, "--measurements")) ? std::stoul(getOptionValue(argc, argv, "--measurements")) : 1000);
+    return 0;
+  }
+
+  if (hasOption(argc, argv, "benchmark")) {
+    runBenchmark(getOptionValue(argc, argv, "--spidev"), isNumber(getOptionValue(argc, argv, "--measurements")) ? std::stoul(getOptionValue(argc, argv, "--measurements")) : 1000, std::chrono::microseconds(isNumber(getOptionValue(argc, argv, "--interval")) ? std::stoul(getOptionValue(argc, argv, "--interval")) : 1000));
+    return 0;
+  }
   
-  demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
+  demo::ExtensionSensors extensionSensors(allocateSpi(getOptionValue(argc, argv, "--spidev")), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
   extensionSensors.setNumberOfSamplesPerMeasurment(3);
   arma::Mat<double> extensionSensorsCorrection;
   if (extensionSensorsCorrection.load("extensionSensors.correction")) {
@@ -54,7 +83,22 @@ void showHelp() {
   std::cout << "  program calibrate [options ...]\n";
   std::cout << "    Starts the sensor calibration\n";
   std::cout << "\n";
+  std::cout << "  program benchmark [options ...]\n";
+  std::cout << "    Prints the average time of a measurement (6 sensors, 1 sample each), bit-banged and (if `--spidev` is set) through /dev/spidev0.0,\n";
+  std::cout << "    as well as the achieved sampling rate and the measurement time when sampling asynchronously.\n";
+  std::cout << "    Afterwards, compares `measure()` with the allocation-free `measureInto()` for different numbers of samples and corrections\n";
+  std::cout << "      --measurements n Number of measurements per transport (default: 1000)\n";
+  std::cout << "      --interval us    Asynchronous sampling interval (default: 1000)\n";
+  std::cout << "\n";
+  std::cout << "  program adaptive [options ...]\n";
+  std::cout << "    Compares fixed and adaptive numbers of samples per measurement on a simulated ADC, which is noisy 20% of the time,\n";
+  std::cout << "    by the average number of reads and the RMS error of the measurements\n";
+  std::cout << "      --measurements n Number of measurements per sampling (default: 1000)\n";
+  std::cout << "\n";
   std::cout << "  Options:\n";
+  std::cout << "         --simulate   Uses simulated devices instead of the Raspberry Pi's hardware\n";
+  std::cout << "         --spidev hz  Reads the sensors through /dev/spidev0.0, clocked at `hz`, instead of bit-banging\n";
+  std::cout << "         --trace path Records all pin, SPI and I2C accesses into `path`, to be decoded by maintainTrace\n";
   std::cout << "         --verbose    Prints additional (debug) information\n";
   std::cout << "    -h | --help       Displays this help\n";
   std::cout << std::flush;
@@ -78,3 +122,156 @@ void runDefault(
     }
   }
 }
+
+void runBenchmark(
+    const std::string& clockFrequency,
+    const std::size_t numberOfMeasurements,
+    const std::chrono::microseconds samplingInterval) {
+  std::cout << "+----------------------+------------------+-----------------+-------------------+\n"
+            << "| Transport            | Synchronous [us] | Sampling [Hz]   | Asynchronous [us] |\n"
+            << "+----------------------+------------------+-----------------+-------------------+" << std::endl;
+
+  for (const bool useSpiDevice : {false, true}) {
+    if (useSpiDevice && !isNumber(clockFrequency)) {
+      break;
+    }
+
+    demo::Spi spi = allocateSpi(useSpiDevice ? clockFrequency : "");
+    if (spi.isUsingSpiDevice() != useSpiDevice) {
+      break;
+    }
+    demo::ExtensionSensors extensionSensors(std::move(spi), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
+    extensionSensors.setNumberOfSamplesPerMeasurment(1);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < numberOfMeasurements; ++n) {
+      extensionSensors.measure();
+    }
+    const double synchronousMeasurementTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfMeasurements);
+
+    // The sampling rate is derived from the samples taken within a second, with the sampling thread running undisturbed.
+    extensionSensors.runAsynchronous(samplingInterval);
+    start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const double samplingRate = static_cast<double>(extensionSensors.getNumberOfAsynchronousSamples()) / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < numberOfMeasurements; ++n) {
+      extensionSensors.measure();
+    }
+    const double asynchronousMeasurementTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfMeasurements);
+    extensionSensors.stopAsynchronous();
+
+    std::cout << "| " << std::left << std::setw(20) << (useSpiDevice ? "spidev (" + clockFrequency + "Hz)" : "Bit-banged") << std::right
+              << " | " << std::setw(16) << std::fixed << std::setprecision(2) << synchronousMeasurementTime
+              << " | " << std::setw(15) << samplingRate
+              << " | " << std::setw(17) << asynchronousMeasurementTime << " |" << std::endl;
+  }
+
+  std::cout << "+----------------------+------------------+-----------------+-------------------+" << std::endl;
+
+  runMeasurementBenchmark(numberOfMeasurements, samplingInterval);
+}
+
+void runMeasurementBenchmark(
+    const std::size_t numberOfMeasurements,
+    const std::chrono::microseconds samplingInterval) {
+  // Sampling asynchronously excludes the conversions, leaving only the median and correction of the latest sample.
+  demo::ExtensionSensors extensionSensors(allocateSpi(""), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
+  extensionSensors.runAsynchronous(samplingInterval);
+
+  std::cout << "+---------+-------------+----------------+--------------------+\n"
+            << "| Samples | Corrections | measure() [us] | measureInto() [us] |\n"
+            << "+---------+-------------+----------------+--------------------+" << std::endl;
+
+  for (const arma::uword numberOfCorrections : {2, 101}) {
+    arma::Mat<double> measurementCorrections(numberOfCorrections, extensionSensors.numberOfSensors_);
+    measurementCorrections.each_col() = arma::linspace<arma::Col<double>>(extensionSensors.minimalMeasurableValue_, extensionSensors.maximalMeasurableValue_, numberOfCorrections);
+    extensionSensors.setMeasurementCorrections(measurementCorrections);
+
+    for (const std::size_t numberOfSamples : {1, 3, 9}) {
+      extensionSensors.setNumberOfSamplesPerMeasurment(numberOfSamples);
+
+      auto start = std::chrono::steady_clock::now();
+      for (std::size_t n = 0; n < numberOfMeasurements; ++n) {
+        extensionSensors.measure();
+      }
+      const double measurementTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfMeasurements);
+
+      arma::Row<double> extensions(extensionSensors.numberOfSensors_);
+      start = std::chrono::steady_clock::now();
+      for (std::size_t n = 0; n < numberOfMeasurements; ++n) {
+        extensionSensors.measureInto(extensions);
+      }
+      const double preallocatedMeasurementTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfMeasurements);
+
+      std::cout << "| " << std::setw(7) << numberOfSamples
+                << " | " << std::setw(11) << numberOfCorrections
+                << " | " << std::setw(14) << std::fixed << std::setprecision(2) << measurementTime
+                << " | " << std::setw(18) << preallocatedMeasurementTime << " |" << std::endl;
+    }
+  }
+
+  std::cout << "+---------+-------------+----------------+--------------------+" << std::endl;
+}
+
+void runAdaptiveSamplingBenchmark(
+    const std::size_t numberOfMeasurements) {
+  std::shared_ptr<demo::SimulatedBackend> simulatedBackend = std::make_shared<demo::SimulatedBackend>();
+  demo::Gpio::setBackend(simulatedBackend);
+
+  const double minimalExtension = 0.168;
+  const double maximalExtension = 0.268;
+  const double leastSignificantBit = (maximalExtension - minimalExtension) / 1023.0;
+  demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, minimalExtension, maximalExtension);
+
+  arma::Row<double> expectedExtensions(extensionSensors.numberOfSensors_);
+  for (unsigned int n = 0; n < extensionSensors.numberOfSensors_; ++n) {
+    const unsigned int analogValue = 200 + 120 * n;
+    simulatedBackend->setAnalogValue(n, analogValue);
+    expectedExtensions(n) = minimalExtension + analogValue * leastSignificantBit;
+  }
+
+  std::cout << "+------------------+---------------------+----------------+-----------------+\n"
+            << "| Samples          | Reads / measurement | RMS error [um] | Max. error [um] |\n"
+            << "+------------------+---------------------+----------------+-----------------+" << std::endl;
+
+  // The ADC is quiet (0.5 LSB) most of the time, but picks up noise (6 LSB) while the actuators are moving, in 20% of the time.
+  for (const auto& sampling : std::vector<std::pair<std::size_t, std::size_t>>({{3, 3}, {9, 9}, {16, 16}, {3, 25}})) {
+    extensionSensors.setAdaptiveNumberOfSamplesPerMeasurement(sampling.first, sampling.second, 1.5 * leastSignificantBit);
+    extensionSensors.resetNoiseStatistics();
+
+    double sumOfSquaredErrors = 0.0;
+    double maximalError = 0.0;
+    arma::Row<double> extensions(extensionSensors.numberOfSensors_);
+    for (std::size_t n = 0; n < numberOfMeasurements; ++n) {
+      if (n % 50 == 0) {
+        for (unsigned int k = 0; k < extensionSensors.numberOfSensors_; ++k) {
+          simulatedBackend->setAnalogNoise(k, (n / 50) % 5 == 4 ? 6.0 : 0.5);
+        }
+      }
+
+      extensionSensors.measureInto(extensions);
+      for (std::size_t k = 0; k < extensionSensors.numberOfSensors_; ++k) {
+        const double error = std::abs(extensions(k) - expectedExtensions(k));
+        sumOfSquaredErrors += error * error;
+        maximalError = std::max(maximalError, error);
+      }
+    }
+
+    std::cout << "| " << std::left << std::setw(16) << (sampling.first == sampling.second ? "Fixed (" + std::to_string(sampling.first) + ")" : "Adaptive (" + std::to_string(sampling.first) + "-" + std::to_string(sampling.second) + ")") << std::right
+              << " | " << std::setw(19) << std::fixed << std::setprecision(2) << extensionSensors.getAverageNumberOfSamplesPerMeasurement()
+              << " | " << std::setw(14) << 1e6 * std::sqrt(sumOfSquaredErrors / static_cast<double>(numberOfMeasurements * extensionSensors.numberOfSensors_))
+              << " | " << std::setw(15) << 1e6 * maximalError << " |" << std::endl;
+  }
+
+  std::cout << "+------------------+---------------------+----------------+-----------------+" << std::endl;
+
+  const arma::Row<double>& noiseStandardDeviations = extensionSensors.getNoiseStandardDeviations();
+  const arma::Row<double>& expectedNumbersOfSamples = extensionSensors.getExpectedNumbersOfSamplesPerMeasurement();
+  std::cout << "Pooled noise [LSB] (expected samples) per sensor, when sampling adaptively:";
+  for (std::size_t n = 0; n < extensionSensors.numberOfSensors_; ++n) {
+    std::cout << " " << noiseStandardDeviations(n) / leastSignificantBit << " (" << std::setprecision(0) << expectedNumbersOfSamples(n) << std::setprecision(2) << ")";
+  }
+  std::cout << std::endl;
+}
@@ -0,0 +1,143 @@
+// C++ standard library
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <string>
+
+// Demonstrator
+#include <demonstrator>
+
+#if defined(USE_WIRINGPI)
+// WiringPi
+#include <wiringPi.h>
+#endif
+
+// Application
+#include "../commandline.hpp"
+
+void showHelp();
+void runBenchmark(
+    const unsigned int pinNumber,
+    const std::size_t numberOfToggles,
+    const bool useWiringPi);
+void printToggleRate(
+    const std::string& backend,
+    const std::size_t numberOfToggles,
+    const std::chrono::steady_clock::duration duration);
+
+int main (const int argc, const char* argv[]) {
+  if (argc < 2 || hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
+    showHelp();
+    // Terminates the program after the help is shown.
+    return 0;
+  }
+
+  if (hasOption(argc, argv, "--verbose")) {
+    ::demo::isVerbose = true;
+  }
+
+  std::size_t numberOfToggles = 1000000;
+  if (isNumber(getOptionValue(argc, argv, "--toggles"))) {
+    numberOfToggles = std::stoul(getOptionValue(argc, argv, "--toggles"));
+  }
+
+  // A file-backed stand-in allows to run this benchmark on any Linux machine. As wiringPi can only be used on a Raspberry Pi, it is skipped in this case and `demo::Pin` is benchmarked with the GPIO registers backend.
+  const std::string& gpiomemPath = getOptionValue(argc, argv, "--gpiomem");
+  if (gpiomemPath.empty()) {
+#if defined(USE_WIRINGPI)
+    // Initialises WiringPi and uses the BCM pin layout.
+    // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
+    ::wiringPiSetupGpio();
+#endif
+    demo::GpioRegisters::map("/dev/gpiomem");
+  } else {
+    demo::GpioRegisters::map(gpiomemPath);
+    demo::Gpio::setBackend(std::make_shared<demo::GpioMemBackend>());
+  }
+
+  runBenchmark(std::stoul(argv[1]), numberOfToggles, gpiomemPath.empty());
+
+  return 0;
+}
+
+void showHelp() {
+  std::cout << "Usage:\n";
+  std::cout << "  program pin [options ...]\n";
+  std::cout << "    Toggles the pin (using BCM GPIO numbering) as fast as possible and prints the toggle rate of each GPIO backend\n";
+  std::cout << "\n";
+  std::cout << "  Options:\n";
+  std::cout << "         --toggles n     Number of toggles per backend (default: 1000000)\n";
+  std::cout << "         --gpiomem path  Maps `path` instead of /dev/gpiomem, e.g. a file of at least 4 KiB on a non-Raspberry Pi machine\n";
+  std::cout << "                         **Note:** wiringPi is not benchmarked in this case\n";
+  std::cout << "         --verbose       Prints additional (debug) information\n";
+  std::cout << "    -h | --help          Displays this help\n";
+  std::cout << std::flush;
+}
+
+void runBenchmark(
+    const unsigned int pinNumber,
+    const std::size_t numberOfToggles,
+    const bool useWiringPi) {
+  std::cout << "+------------------------------+------------------+--------------+\n"
+            << "| Backend                      | Toggles per [s]  | Toggle [ns]  |\n"
+            << "+------------------------------+------------------+--------------+" << std::endl;
+
+  // Verbose output would dominate the measurement.
+  const bool wasVerbose = ::demo::isVerbose;
+  ::demo::isVerbose = false;
+
+#if defined(USE_WIRINGPI)
+  if (useWiringPi) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < numberOfToggles; ++n) {
+      // This was the former implementation of `demo::Pin::set`.
+      ::pinMode(static_cast<int>(pinNumber), OUTPUT);
+      ::digitalWrite(static_cast<int>(pinNumber), static_cast<int>(n % 2));
+    }
+    printToggleRate("wiringPi (pinMode + write)", numberOfToggles, std::chrono::steady_clock::now() - start);
+
+    ::pinMode(static_cast<int>(pinNumber), OUTPUT);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < numberOfToggles; ++n) {
+      ::digitalWrite(static_cast<int>(pinNumber), static_cast<int>(n % 2));
+    }
+    printToggleRate("wiringPi (write only)", numberOfToggles, std::chrono::steady_clock::now() - start);
+  }
+#else
+  static_cast<void>(useWiringPi);
+#endif
+
+  demo::GpioRegisters::setMode(pinNumber, demo::GpioRegisters::Mode::Output);
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < numberOfToggles; ++n) {
+    if (n % 2) {
+      demo::GpioRegisters::set(1u << pinNumber);
+    } else {
+      demo::GpioRegisters::clear(1u << pinNumber);
+    }
+  }
+  printToggleRate("GPIO registers", numberOfToggles, std::chrono::steady_clock::now() - start);
+
+  const std::string pinBackend = dynamic_cast<demo::GpioMemBackend*>(&demo::Gpio::getBackend()) ? "demo::Pin (GPIO registers)" : "demo::Pin (wiringPi)";
+  demo::Pin pin = demo::Gpio::allocatePin(pinNumber);
+  start = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < numberOfToggles; ++n) {
+    pin.set(static_cast<unsigned int>(n % 2));
+  }
+  printToggleRate(pinBackend, numberOfToggles, std::chrono::steady_clock::now() - start);
+  pin.set(demo::Pin::Digital::Low);
+
+  ::demo::isVerbose = wasVerbose;
+  std::cout << "+------------------------------+------------------+--------------+" << std::endl;
+}
+
+void printToggleRate(
+    const std::string& backend,
+    const std::size_t numberOfToggles,
+    const std::chrono::steady_clock::duration duration) {
+  const double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+  std::cout << "| " << std::left << std::setw(28) << backend << std::right
+            << " | " << std::setw(16) << std::fixed << std::setprecision(0) << 1e9 * static_cast<double>(numberOfToggles) / nanoseconds
+            << " | " << std::setw(12) << std::setprecision(2) << nanoseconds / static_cast<double>(numberOfToggles) << " |" << std::endl;
+}
@@ -1,16 +1,46 @@
 // C++ standard library
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <thread>
-
-// WiringPi
-#include <wiringPi.h>
+#include <vector>
 
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
+/**
+ * A simulated actuator, driven by the PCA9685's duty cycle and the direction pins and measured by the MCP3008. Its speed is proportional to the duty cycle (up to `fullSpeed`), follows it with a first-order lag of `timeConstant` and is zero below `stictionDutyCycle`.
+ */
+struct ActuatorModel {
+  static constexpr double fullSpeed = 0.05;
+  static constexpr double timeConstant = 0.03;
+  static constexpr double stictionDutyCycle = 0.02;
+  static constexpr double minimalExtension = 0.168;
+  static constexpr double maximalExtension = 0.268;
+
+  std::array<std::atomic<double>, DirectionPins::size> extensions;
+  std::atomic<bool> killSimulationThread;
+};
+
+constexpr double ActuatorModel::fullSpeed;
+constexpr double ActuatorModel::timeConstant;
+constexpr double ActuatorModel::stictionDutyCycle;
+constexpr double ActuatorModel::minimalExtension;
+constexpr double ActuatorModel::maximalExtension;
+
 void showHelp();
 void runDefault(
     demo::LinearActuators& linearActuators);
@@ -22,6 +52,19 @@ void runSingle(
     const std::size_t n,
     const double extension);
 arma::Cube<double> measure();
+void runBenchmark(
+    demo::LinearActuators& linearActuators,
+    demo::SimulatedBackend& simulatedBackend,
+    const std::size_t numberOfSteps);
+void benchmarkController(
+    demo::LinearActuators& linearActuators,
+    const ActuatorModel& actuatorModel,
+    const std::string& controller,
+    const double acceptableExtensionDeviation,
+    const std::size_t numberOfSteps);
+void simulateActuators(
+    demo::SimulatedBackend& simulatedBackend,
+    ActuatorModel& actuatorModel);
 
 int main (const int argc, const char* argv[]) {
   if (hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
@@ -34,11 +77,15 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
 
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+  // The benchmark always runs against the simulated actuators.
+  const bool isBenchmark = (argc > 1 && std::string(argv[1]) == "benchmark");
+  std::shared_ptr<demo::SimulatedBackend> simulatedBackend;
+  if (isBenchmark || hasOption(argc, argv, "--simulate")) {
+    simulatedBackend = std::make_shared<demo::SimulatedBackend>();
+    demo::Gpio::setBackend(simulatedBackend);
+  }
 
-  demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
+  demo::ExtensionSensors extensionSensors(allocateSpi(getOptionValue(argc, argv, "--spidev")), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
   extensionSensors.setNumberOfSamplesPerMeasurment(3);
   arma::Mat<double> extensionSensorsCorrection;
   if (extensionSensorsCorrection.load("extensionSensors.correction")) {
@@ -48,19 +95,25 @@ int main (const int argc, const char* argv[]) {
     std::cout << "Could not find extension sensor correction file. Displaying uncorrected measurements." << std::endl;
   }
   
-  std::vector<demo::Pin> directionPins;
-  directionPins.push_back(demo::Gpio::allocatePin(22));
-  directionPins.push_back(demo::Gpio::allocatePin(5));
-  directionPins.push_back(demo::Gpio::allocatePin(6));
-  directionPins.push_back(demo::Gpio::allocatePin(13));
-  directionPins.push_back(demo::Gpio::allocatePin(19));
-  directionPins.push_back(demo::Gpio::allocatePin(26));
-  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0);
+  std::vector<demo::Pin> directionPins = MotorsPi::allocate<DirectionPins>();
+  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0, motorsPiTimings);
   
   demo::LinearActuators linearActuators(std::move(servoControllers), std::move(extensionSensors), 0.178, 0.248);
   linearActuators.setAcceptableExtensionDeviation(0.005);
+  linearActuators.setControllerGains(
+      isNumber(getOptionValue(argc, argv, "--proportional-gain")) ? std::stod(getOptionValue(argc, argv, "--proportional-gain")) : linearActuators.getProportionalGain(),
+      isNumber(getOptionValue(argc, argv, "--integral-gain")) ? std::stod(getOptionValue(argc, argv, "--integral-gain")) : linearActuators.getIntegralGain(),
+      isNumber(getOptionValue(argc, argv, "--derivative-gain")) ? std::stod(getOptionValue(argc, argv, "--derivative-gain")) : linearActuators.getDerivativeGain());
+  if (isNumber(getOptionValue(argc, argv, "--acceleration"))) {
+    linearActuators.setMaximalAcceleration(std::stod(getOptionValue(argc, argv, "--acceleration")));
+  }
+  if (isNumber(getOptionValue(argc, argv, "--control-interval"))) {
+    linearActuators.setControlInterval(std::chrono::microseconds(std::stoul(getOptionValue(argc, argv, "--control-interval"))));
+  }
   
-  if (argc > 2 && isNumber(argv[1]) && isNumber(argv[2])) {
+  if (isBenchmark) {
+    runBenchmark(linearActuators, *simulatedBackend, isNumber(getOptionValue(argc, argv, "--steps")) ? std::stoul(getOptionValue(argc, argv, "--steps")) : 10);
+  } else if (argc > 2 && isNumber(argv[1]) && isNumber(argv[2])) {
     runSingle(linearActuators, std::stoi(argv[1]), std::stod(argv[2]));
   } else if (argc > 1 && isNumber(argv[1])) {
     runAll(linearActuators, std::stod(argv[1]));
@@ -82,9 +135,21 @@ void showHelp() {
   std::cout << "  program n extension [options ...]\n";
   std::cout << "    Moves the `n`-th actuator to `extension`\n";
   std::cout << "\n";
+  std::cout << "  program benchmark [options ...]\n";
+  std::cout << "    Moves all simulated actuators back and forth by 40 millimetres, once with the former bang-bang control and\n";
+  std::cout << "    once with the PID controllers, and prints their settling time, overshoot and final error per tolerance\n";
+  std::cout << "\n";
   std::cout << "  Options:\n";
-  std::cout << "         --verbose    Prints additional (debug) information\n";
-  std::cout << "    -h | --help       Displays this help\n";
+  std::cout << "         --spidev hz                Reads the extension sensors through /dev/spidev0.0, clocked at `hz`, instead of bit-banging\n";
+  std::cout << "         --proportional-gain g      Proportional gain of the PID controllers, in 1/m (default: 150)\n";
+  std::cout << "         --integral-gain g          Integral gain of the PID controllers, in 1/(m*s) (default: 5)\n";
+  std::cout << "         --derivative-gain g        Derivative gain of the PID controllers, in s/m (default: 0)\n";
+  std::cout << "         --acceleration a           Maximal change of the speeds per second, as a fraction of the full speed (default: 10)\n";
+  std::cout << "         --control-interval us      Interval of the control loop (default: 10000)\n";
+  std::cout << "         --steps n                  Number of moves per benchmarked controller and tolerance (default: 10)\n";
+  std::cout << "         --simulate                 Uses simulated devices instead of the Raspberry Pi's hardware\n";
+  std::cout << "         --verbose                  Prints additional (debug) information\n";
+  std::cout << "    -h | --help                     Displays this help\n";
   std::cout << std::flush;
 }
 
@@ -131,3 +196,139 @@ void runSingle(
   linearActuators.setExtensions(extensions, maximalSpeeds);
   linearActuators.waitTillExtensionIsReached(std::chrono::seconds(10));
 }
+
+void runBenchmark(
+    demo::LinearActuators& linearActuators,
+    demo::SimulatedBackend& simulatedBackend,
+    const std::size_t numberOfSteps) {
+  ActuatorModel actuatorModel;
+  for (std::size_t n = 0; n < linearActuators.numberOfActuators_; ++n) {
+    actuatorModel.extensions.at(n) = (ActuatorModel::minimalExtension + ActuatorModel::maximalExtension) / 2;
+    simulatedBackend.setAnalogNoise(n, 1.0);
+  }
+  actuatorModel.killSimulationThread = false;
+  std::thread simulationThread(simulateActuators, std::ref(simulatedBackend), std::ref(actuatorModel));
+
+  const double proportionalGain = linearActuators.getProportionalGain();
+  const double integralGain = linearActuators.getIntegralGain();
+  const double derivativeGain = linearActuators.getDerivativeGain();
+  const double maximalAcceleration = linearActuators.getMaximalAcceleration();
+
+  std::cout << "+------------+----------------+-------------------+-------------------+----------------+--------------------+---------+\n"
+            << "| Controller | Tolerance [mm] | Mean settling [ms]| Max. settling [ms]| Overshoot [mm] | Final error [mm]   | Settled |\n"
+            << "+------------+----------------+-------------------+-------------------+----------------+--------------------+---------+" << std::endl;
+  for (const double acceptableExtensionDeviation : {0.005, 0.002, 0.001, 0.0005}) {
+    // Drives each actuator at full speed until its extension is reached, as before the PID controllers.
+    linearActuators.setControllerGains(1e9, 0.0, 0.0);
+    linearActuators.setMaximalAcceleration(std::numeric_limits<double>::infinity());
+    benchmarkController(linearActuators, actuatorModel, "Bang-bang", acceptableExtensionDeviation, numberOfSteps);
+
+    linearActuators.setControllerGains(proportionalGain, integralGain, derivativeGain);
+    linearActuators.setMaximalAcceleration(maximalAcceleration);
+    benchmarkController(linearActuators, actuatorModel, "PID", acceptableExtensionDeviation, numberOfSteps);
+  }
+  std::cout << "+------------+----------------+-------------------+-------------------+----------------+--------------------+---------+" << std::endl;
+
+  actuatorModel.killSimulationThread = true;
+  simulationThread.join();
+}
+
+void benchmarkController(
+    demo::LinearActuators& linearActuators,
+    const ActuatorModel& actuatorModel,
+    const std::string& controller,
+    const double acceptableExtensionDeviation,
+    const std::size_t numberOfSteps) {
+  // Each move is observed for 2 seconds, which is more than twice the duration of a move at full speed.
+  const std::chrono::milliseconds observationDuration(2000);
+  const arma::Row<double> maximalSpeeds(linearActuators.numberOfActuators_, arma::fill::ones);
+  linearActuators.setAcceptableExtensionDeviation(acceptableExtensionDeviation);
+
+  // Starts each benchmark at the lower extension, without measuring this move.
+  arma::Row<double> extensions(linearActuators.numberOfActuators_);
+  extensions.fill(0.193);
+  linearActuators.setExtensions(extensions, maximalSpeeds);
+  linearActuators.waitTillExtensionIsReached(observationDuration);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  double sumOfSettlingTimes = 0.0;
+  double maximalSettlingTime = 0.0;
+  double maximalOvershoot = 0.0;
+  double maximalFinalError = 0.0;
+  std::size_t numberOfSettledMoves = 0;
+  for (std::size_t k = 0; k < numberOfSteps; ++k) {
+    const double direction = (k % 2 == 0 ? 1.0 : -1.0);
+    extensions += direction * 0.04;
+
+    const auto start = std::chrono::steady_clock::now();
+    linearActuators.setExtensions(extensions, maximalSpeeds);
+
+    // The last time each actuator was outside the tolerance, as simulated (not as measured).
+    std::vector<double> settlingTimes(linearActuators.numberOfActuators_, 0.0);
+    auto now = start;
+    while (now - start < observationDuration) {
+      demo::timing::sleepUntil(now + std::chrono::milliseconds(1));
+      now = std::chrono::steady_clock::now();
+
+      for (std::size_t n = 0; n < linearActuators.numberOfActuators_; ++n) {
+        const double error = actuatorModel.extensions.at(n) - extensions(n);
+        if (std::abs(error) > acceptableExtensionDeviation) {
+          settlingTimes.at(n) = std::chrono::duration<double, std::milli>(now - start).count();
+        }
+        maximalOvershoot = std::max(maximalOvershoot, direction * error);
+      }
+    }
+
+    for (std::size_t n = 0; n < linearActuators.numberOfActuators_; ++n) {
+      const double finalError = std::abs(actuatorModel.extensions.at(n) - extensions(n));
+      maximalFinalError = std::max(maximalFinalError, finalError);
+      if (finalError <= acceptableExtensionDeviation) {
+        ++numberOfSettledMoves;
+        sumOfSettlingTimes += settlingTimes.at(n);
+        maximalSettlingTime = std::max(maximalSettlingTime, settlingTimes.at(n));
+      }
+    }
+  }
+
+  std::cout << "| " << std::left << std::setw(10) << controller << std::right << std::fixed << std::setprecision(2)
+            << " | " << std::setw(14) << acceptableExtensionDeviation * 1000
+            << " | " << std::setw(17) << (numberOfSettledMoves > 0 ? sumOfSettlingTimes / static_cast<double>(numberOfSettledMoves) : 0.0)
+            << " | " << std::setw(17) << maximalSettlingTime
+            << " | " << std::setw(14) << maximalOvershoot * 1000
+            << " | " << std::setw(18) << maximalFinalError * 1000
+            << " | " << std::setw(3) << numberOfSettledMoves * 100 / (numberOfSteps * linearActuators.numberOfActuators_) << " % |" << std::endl;
+}
+
+void simulateActuators(
+    demo::SimulatedBackend& simulatedBackend,
+    ActuatorModel& actuatorModel) {
+  std::array<double, DirectionPins::size> velocities;
+  velocities.fill(0.0);
+
+  auto previousUpdate = std::chrono::steady_clock::now();
+  while (!actuatorModel.killSimulationThread) {
+    demo::timing::sleepUntil(previousUpdate + std::chrono::milliseconds(1));
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsedTime = std::chrono::duration<double>(now - previousUpdate).count();
+    previousUpdate = now;
+
+    const std::uint32_t levels = simulatedBackend.getLevels();
+    for (std::size_t n = 0; n < DirectionPins::size; ++n) {
+      // The duty cycle is set in LEDn_OFF_L and the lower 4 bits of LEDn_OFF_H, while each output turns on at 0.
+      const double dutyCycle = static_cast<double>(((simulatedBackend.getPca9685Register(0x06 + 4 * n + 3) & 0x0F) << 8) | simulatedBackend.getPca9685Register(0x06 + 4 * n + 2)) / 4095.0;
+      const bool forwards = (levels & DirectionPins::toRegisterMask(1u << n)) == 0;
+
+      const double speed = (dutyCycle < ActuatorModel::stictionDutyCycle ? 0.0 : (forwards ? 1.0 : -1.0) * dutyCycle * ActuatorModel::fullSpeed);
+      velocities.at(n) += (speed - velocities.at(n)) * (1.0 - std::exp(-elapsedTime / ActuatorModel::timeConstant));
+
+      double extension = actuatorModel.extensions.at(n) + velocities.at(n) * elapsedTime;
+      if (extension < ActuatorModel::minimalExtension || extension > ActuatorModel::maximalExtension) {
+        extension = std::min(std::max(extension, ActuatorModel::minimalExtension), ActuatorModel::maximalExtension);
+        velocities.at(n) = 0.0;
+      }
+      actuatorModel.extensions.at(n) = extension;
+
+      simulatedBackend.setAnalogValue(n, static_cast<unsigned int>(std::round((extension - ActuatorModel::minimalExtension) / (ActuatorModel::maximalExtension - ActuatorModel::minimalExtension) * 1023)));
+    }
+  }
+}
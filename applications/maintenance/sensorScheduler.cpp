@@ -0,0 +1,111 @@
+// C++ standard library
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+// Demonstrator
+#include <demonstrator>
+
+// Application
+#include "../commandline.hpp"
+
+void showHelp();
+void printStatistics(
+    const demo::SensorScheduler& sensorScheduler,
+    const std::chrono::steady_clock::duration runtime);
+void printSlotStatistics(
+    const demo::SensorScheduler& sensorScheduler,
+    const std::size_t slot,
+    const std::string& sensors,
+    const std::chrono::steady_clock::duration runtime);
+
+int main (const int argc, const char* argv[]) {
+  if (hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
+    showHelp();
+    // Terminates the program after the help is shown.
+    return 0;
+  }
+
+  if (hasOption(argc, argv, "--verbose")) {
+    ::demo::isVerbose = true;
+  }
+
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
+
+  const std::chrono::microseconds extensionInterval(isNumber(getOptionValue(argc, argv, "--extension-interval")) ? std::stoul(getOptionValue(argc, argv, "--extension-interval")) : 2000);
+  const std::chrono::microseconds attitudeInterval(isNumber(getOptionValue(argc, argv, "--attitude-interval")) ? std::stoul(getOptionValue(argc, argv, "--attitude-interval")) : 20000);
+  const std::size_t duration = isNumber(getOptionValue(argc, argv, "--duration")) ? std::stoul(getOptionValue(argc, argv, "--duration")) : 10;
+
+  demo::ExtensionSensors extensionSensors(demo::Gpio::allocateSpi(), {0, 1, 2, 3, 4, 5}, 0.168, 0.268);
+  if (hasOption(argc, argv, "--sample-asynchronously")) {
+    // Samples at twice the measurement rate, so that the latest sample is at most half an interval old.
+    extensionSensors.runAsynchronous(extensionInterval / 2);
+  }
+
+  demo::AttitudeSensors attitudeSensors(demo::Gpio::allocateUart(), -arma::datum::pi, arma::datum::pi);
+  attitudeSensors.runAsynchronous();
+
+  demo::SensorScheduler sensorScheduler;
+  sensorScheduler.addSensors(extensionSensors, extensionInterval);
+  sensorScheduler.addSensors(attitudeSensors, attitudeInterval);
+
+  const auto start = std::chrono::steady_clock::now();
+  sensorScheduler.runAsynchronous();
+  for (std::size_t n = 1; n <= duration; ++n) {
+    demo::timing::sleepUntil(start + std::chrono::seconds(n));
+    printStatistics(sensorScheduler, std::chrono::steady_clock::now() - start);
+  }
+  sensorScheduler.stopAsynchronous();
+
+  return 0;
+}
+
+void showHelp() {
+  std::cout << "Usage:\n";
+  std::cout << "  program [options ...]\n";
+  std::cout << "    Measures the extension and attitude sensors within a single scheduling thread, at individual rates,\n";
+  std::cout << "    and prints the achieved rates, overruns and lateness of each once per second\n";
+  std::cout << "\n";
+  std::cout << "  Options:\n";
+  std::cout << "         --extension-interval us Measurement interval of the extension sensors (default: 2000)\n";
+  std::cout << "         --attitude-interval us  Measurement interval of the attitude sensors (default: 20000)\n";
+  std::cout << "         --sample-asynchronously Samples the extension sensors in their own thread, instead of within the scheduler\n";
+  std::cout << "         --duration s            Number of seconds to run (default: 10)\n";
+  std::cout << "         --simulate              Uses simulated devices instead of the Raspberry Pi's hardware\n";
+  std::cout << "         --verbose               Prints additional (debug) information\n";
+  std::cout << "    -h | --help                  Displays this help\n";
+  std::cout << std::flush;
+}
+
+void printStatistics(
+    const demo::SensorScheduler& sensorScheduler,
+    const std::chrono::steady_clock::duration runtime) {
+  std::cout << "+------------+---------------+--------------+-------------+-----------+--------+---------------------+\n"
+            << "| Sensors    | Interval [us] | Measurements | Rate [Hz]   | Overruns  | Failed | Max. lateness [us]  |\n"
+            << "+------------+---------------+--------------+-------------+-----------+--------+---------------------+" << std::endl;
+  // The slots are numbered in the order the sensors were added in.
+  printSlotStatistics(sensorScheduler, 0, "Extension", runtime);
+  printSlotStatistics(sensorScheduler, 1, "Attitude", runtime);
+  std::cout << "+------------+---------------+--------------+-------------+-----------+--------+---------------------+" << std::endl;
+}
+
+void printSlotStatistics(
+    const demo::SensorScheduler& sensorScheduler,
+    const std::size_t slot,
+    const std::string& sensors,
+    const std::chrono::steady_clock::duration runtime) {
+  const std::uint64_t numberOfMeasurements = sensorScheduler.getNumberOfMeasurements(slot);
+
+  std::cout << "| " << std::left << std::setw(10) << sensors << std::right << std::fixed << std::setprecision(2)
+            << " | " << std::setw(13) << sensorScheduler.getMeasurementInterval(slot).count()
+            << " | " << std::setw(12) << numberOfMeasurements
+            << " | " << std::setw(11) << static_cast<double>(numberOfMeasurements) / std::chrono::duration<double>(runtime).count()
+            << " | " << std::setw(9) << sensorScheduler.getNumberOfOverruns(slot)
+            << " | " << std::setw(6) << sensorScheduler.getNumberOfFailedMeasurements(slot)
+            << " | " << std::setw(19) << std::chrono::duration<double, std::micro>(sensorScheduler.getMaximalLateness(slot)).count() << " |" << std::endl;
+}
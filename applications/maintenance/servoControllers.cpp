@@ -1,14 +1,19 @@
 // C++ standard library
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <string>
 #include <thread>
-
-// WiringPi
-#include <wiringPi.h>
+#include <utility>
+#include <vector>
 
 // Demonstrator
 #include <demonstrator>
 
 // Application
+#include "../boardProfiles.hpp"
 #include "../commandline.hpp"
 
 void showHelp();
@@ -16,7 +21,15 @@ void runDefault(
     demo::ServoControllers& servoControllers,
     const std::size_t n);
 void runStop(
-    demo::ServoControllers& servoControllers);
+    demo::ServoControllers& servoControllers,
+    const bool isImmediate);
+void runBenchmark(
+    std::vector<demo::Pin>&& directionPins,
+    const std::size_t numberOfCycles,
+    const bool isAsynchronous);
+double getBusTime(
+    const std::size_t numberOfTransactions,
+    const std::size_t numberOfBytes);
 
 int main (const int argc, const char* argv[]) {
   if (argc < 2) {
@@ -34,22 +47,26 @@ int main (const int argc, const char* argv[]) {
     ::demo::isVerbose = true;
   }
   
-  // Initialises WiringPi and uses the BCM pin layout.
-  // For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
-  ::wiringPiSetupGpio();
+  if (hasOption(argc, argv, "--simulate")) {
+    demo::Gpio::setBackend(std::make_shared<demo::SimulatedBackend>());
+  }
+
+  const std::string& tracePath = getOptionValue(argc, argv, "--trace");
+  if (!tracePath.empty()) {
+    demo::trace::start(tracePath);
+  }
   
-  std::vector<demo::Pin> directionPins;
-  directionPins.push_back(demo::Gpio::allocatePin(22));
-  directionPins.push_back(demo::Gpio::allocatePin(5));
-  directionPins.push_back(demo::Gpio::allocatePin(6));
-  directionPins.push_back(demo::Gpio::allocatePin(13));
-  directionPins.push_back(demo::Gpio::allocatePin(19));
-  directionPins.push_back(demo::Gpio::allocatePin(26));
+  std::vector<demo::Pin> directionPins = MotorsPi::allocate<DirectionPins>();
+
+  if (hasOption(argc, argv, "benchmark")) {
+    runBenchmark(std::move(directionPins), isNumber(getOptionValue(argc, argv, "--cycles")) ? std::stoul(getOptionValue(argc, argv, "--cycles")) : 1000, hasOption(argc, argv, "--asynchronous"));
+    return 0;
+  }
   
-  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0);
+  demo::ServoControllers servoControllers(std::move(directionPins), demo::Gpio::allocateI2c(), {0, 1, 2, 3, 4, 5}, 1.0, motorsPiTimings);
   
   if (hasOption(argc, argv, "stop")) {
-    runStop(servoControllers);
+    runStop(servoControllers, hasOption(argc, argv, "--immediately"));
   } else {
     runDefault(servoControllers, std::stoi(argv[1]));
   }
@@ -64,7 +81,19 @@ void showHelp() {
   std::cout << "    Pressing `+` will move the servo one step up and pressing `-` will move it one step down\n";
   std::cout << "    **Note:** The servo is automatically stopped after 500ms\n";
   std::cout << "\n";
+  std::cout << "  program stop [options ...]\n";
+  std::cout << "    Stops all servo controllers\n";
+  std::cout << "      --immediately    Turns all outputs off within a single transaction (they remain off until the next regular stop)\n";
+  std::cout << "\n";
+  std::cout << "  program benchmark [options ...]\n";
+  std::cout << "    Prints the average time to set the PWM registers of all 6 controllers, register by register (as before), as a single block write and with unchanged speeds,\n";
+  std::cout << "    as well as the latency of a regular and an immediate stop\n";
+  std::cout << "      --cycles n       Number of updates per transport (default: 1000)\n";
+  std::cout << "      --asynchronous   Submits the block writes to the I2C bus thread, measuring the submission instead of the bus time\n";
+  std::cout << "\n";
   std::cout << "  Options:\n";
+  std::cout << "         --simulate   Uses simulated devices instead of the Raspberry Pi's hardware\n";
+  std::cout << "         --trace path Records all pin, SPI and I2C accesses into `path`, to be decoded by maintainTrace\n";
   std::cout << "         --verbose    Prints additional (debug) information\n";
   std::cout << "    -h | --help       Displays this help\n";
   std::cout << std::flush;
@@ -108,6 +137,135 @@ void runDefault(
 }
 
 void runStop(
-    demo::ServoControllers& servoControllers) {
-  servoControllers.stop();
+    demo::ServoControllers& servoControllers,
+    const bool isImmediate) {
+  if (isImmediate) {
+    if (!servoControllers.stopImmediately()) {
+      std::cout << "Could not stop the servo controllers." << std::endl;
+    }
+  } else {
+    servoControllers.stop();
+  }
+}
+
+void runBenchmark(
+    std::vector<demo::Pin>&& directionPins,
+    const std::size_t numberOfCycles,
+    const bool isAsynchronous) {
+  const std::vector<unsigned int> channels = {0, 1, 2, 3, 4, 5};
+
+  // The speeds alternate between two duty cycles that differ in both bytes, so that each update actually changes the LEDn_OFF registers of all channels.
+  const auto getDutyCycle = [](const std::size_t cycle) {
+    return (cycle % 2 == 0 ? 0x0555u : 0x0AAAu);
+  };
+
+  double perRegisterTime;
+  {
+    demo::I2c i2c = demo::Gpio::allocateI2c();
+    // Enables the auto-increment, as done by `demo::ServoControllers`.
+    i2c.set(0x00, 0xA1);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < numberOfCycles; ++n) {
+      for (const auto channel : channels) {
+        i2c.set(0x06 + 4 * channel, 0);
+        i2c.set(0x07 + 4 * channel, 0);
+        i2c.set(0x08 + 4 * channel, getDutyCycle(n) & 0xFF);
+        i2c.set(0x09 + 4 * channel, getDutyCycle(n) >> 8);
+      }
+    }
+    perRegisterTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfCycles);
+  }
+
+  std::shared_ptr<demo::I2cBus> i2cBus = demo::Gpio::allocateI2cBus();
+  if (isAsynchronous) {
+    i2cBus->runAsynchronous();
+  }
+  demo::ServoControllers servoControllers(std::move(directionPins), i2cBus->getDevice(0x40), channels, 1.0, motorsPiTimings);
+  const std::vector<bool> forwards(channels.size(), true);
+  arma::Row<double> speeds(channels.size());
+
+  // The first update also writes the (unchanged) LEDn_ON registers, as their values are not yet known.
+  speeds.fill(static_cast<double>(getDutyCycle(1)) / 4095.0);
+  servoControllers.run(forwards, speeds);
+
+  std::uint64_t numberOfIssuedRegisterWrites = servoControllers.getNumberOfIssuedRegisterWrites();
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < numberOfCycles; ++n) {
+    speeds.fill(static_cast<double>(getDutyCycle(n)) / 4095.0);
+    servoControllers.run(forwards, speeds);
+  }
+  const double blockTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfCycles);
+  // Only the changed registers are written, with the unchanged LEDn_ON registers in between being merged into the same block.
+  const std::uint64_t blockRegisterWrites = (servoControllers.getNumberOfIssuedRegisterWrites() - numberOfIssuedRegisterWrites) / numberOfCycles;
+
+  // Repeating the same speeds is skipped entirely by the shadowed registers.
+  speeds.fill(0.5);
+  servoControllers.run(forwards, speeds);
+  numberOfIssuedRegisterWrites = servoControllers.getNumberOfIssuedRegisterWrites();
+  const auto unchangedStart = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < numberOfCycles; ++n) {
+    servoControllers.run(forwards, speeds);
+  }
+  const double unchangedTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - unchangedStart).count() / static_cast<double>(numberOfCycles);
+  const std::uint64_t unchangedRegisterWrites = servoControllers.getNumberOfIssuedRegisterWrites() - numberOfIssuedRegisterWrites;
+
+  // The stop latency is the time from the call until the last output was turned off, measured from a running state each time.
+  double stopLatency = 0.0;
+  double immediateStopLatency = 0.0;
+  std::uint64_t stopRegisterWrites = 0;
+  for (std::size_t n = 0; n < numberOfCycles; ++n) {
+    servoControllers.run(forwards, speeds);
+    numberOfIssuedRegisterWrites = servoControllers.getNumberOfIssuedRegisterWrites();
+    auto stopStart = std::chrono::steady_clock::now();
+    servoControllers.stop();
+    stopLatency += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stopStart).count();
+    stopRegisterWrites += servoControllers.getNumberOfIssuedRegisterWrites() - numberOfIssuedRegisterWrites;
+
+    servoControllers.run(forwards, speeds);
+    stopStart = std::chrono::steady_clock::now();
+    servoControllers.stopImmediately();
+    immediateStopLatency += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stopStart).count();
+    // Re-enables `run()` for the next cycle.
+    servoControllers.stop();
+  }
+  stopLatency /= static_cast<double>(numberOfCycles);
+  immediateStopLatency /= static_cast<double>(numberOfCycles);
+  stopRegisterWrites /= numberOfCycles;
+
+  // Each register write is a transaction of its own (slave address, register number and value), while the block write sends the register number only once.
+  std::cout << "+----------------------+--------------+---------+-----------------+------------------+\n"
+            << "| Transport            | Transactions | Bytes   | Time [us]       | Bus time [us]    |\n"
+            << "+----------------------+--------------+---------+-----------------+------------------+\n"
+            << "| Register by register | " << std::setw(12) << 4 * channels.size() << " | " << std::setw(7) << 4 * channels.size() * 3
+            << " | " << std::setw(15) << std::fixed << std::setprecision(2) << perRegisterTime << " | " << std::setw(16) << getBusTime(4 * channels.size(), 4 * channels.size() * 3) << " |\n"
+            << "| Block write          | " << std::setw(12) << 1 << " | " << std::setw(7) << 2 + blockRegisterWrites
+            << " | " << std::setw(15) << blockTime << " | " << std::setw(16) << getBusTime(1, 2 + blockRegisterWrites) << " |\n"
+            << "| Unchanged speeds     | " << std::setw(12) << 0 << " | " << std::setw(7) << unchangedRegisterWrites / numberOfCycles
+            << " | " << std::setw(15) << unchangedTime << " | " << std::setw(16) << getBusTime(0, unchangedRegisterWrites / numberOfCycles) << " |\n"
+            << "+----------------------+--------------+---------+-----------------+------------------+" << std::endl;
+  std::cout << "The time of a block write includes setting the direction pins. The bus time is the minimal time on a 100kHz bus (as configured by default on a Raspberry Pi)." << std::endl;
+  std::cout << "Register writes issued: " << servoControllers.getNumberOfIssuedRegisterWrites() << ", suppressed (unchanged): " << servoControllers.getNumberOfSuppressedRegisterWrites() << std::endl;
+
+  // `stopImmediately()` only writes the 4 ALL_LED registers. `stop()` writes all registers of its own channels as a single block (as it forgets their shadowed values), leaving the other channels untouched.
+  std::cout << "\n"
+            << "+----------------------+--------------+---------+-----------------+------------------+\n"
+            << "| Stop                 | Transactions | Bytes   | Latency [us]    | Bus time [us]    |\n"
+            << "+----------------------+--------------+---------+-----------------+------------------+\n"
+            << "| stop()               | " << std::setw(12) << 1 << " | " << std::setw(7) << 2 + stopRegisterWrites
+            << " | " << std::setw(15) << stopLatency << " | " << std::setw(16) << getBusTime(1, 2 + stopRegisterWrites) << " |\n"
+            << "| stopImmediately()    | " << std::setw(12) << 1 << " | " << std::setw(7) << 2 + 4
+            << " | " << std::setw(15) << immediateStopLatency << " | " << std::setw(16) << getBusTime(1, 2 + 4) << " |\n"
+            << "+----------------------+--------------+---------+-----------------+------------------+" << std::endl;
+  std::cout << "The latency of `stop()` includes setting the direction pins." << std::endl;
+  if (isAsynchronous) {
+    std::cout << "The I2C bus ran asynchronously, so that the times and latencies only include the submission. Failed writes: " << i2cBus->getNumberOfFailedWrites() << std::endl;
+  }
+}
+
+double getBusTime(
+    const std::size_t numberOfTransactions,
+    const std::size_t numberOfBytes) {
+  // Each byte takes 9 clock cycles (8 data bits and the acknowledge), each transaction another 2 for its start and stop condition.
+  return static_cast<double>(9 * numberOfBytes + 2 * numberOfTransactions) / 100000.0 * 1e6;
 }
@@ -0,0 +1,104 @@
+// C++ standard library
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Demonstrator
+#include <demonstrator>
+
+// Application
+#include "../commandline.hpp"
+
+void showHelp();
+void runBenchmark(
+    const std::size_t numberOfRepetitions);
+void printJitter(
+    const std::string& method,
+    const std::chrono::nanoseconds delay,
+    const std::size_t numberOfRepetitions,
+    const std::function<void(std::chrono::nanoseconds)>& wait);
+
+int main (const int argc, const char* argv[]) {
+  if (hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
+    showHelp();
+    // Terminates the program after the help is shown.
+    return 0;
+  }
+
+  if (hasOption(argc, argv, "--verbose")) {
+    ::demo::isVerbose = true;
+  }
+
+  std::size_t numberOfRepetitions = 1000;
+  if (isNumber(getOptionValue(argc, argv, "--repetitions"))) {
+    numberOfRepetitions = std::max<std::size_t>(1, std::stoul(getOptionValue(argc, argv, "--repetitions")));
+  }
+
+  runBenchmark(numberOfRepetitions);
+
+  return 0;
+}
+
+void showHelp() {
+  std::cout << "Usage:\n";
+  std::cout << "  program [options ...]\n";
+  std::cout << "    Prints the achieved vs. requested delays of each timing method, for the delays used by the library\n";
+  std::cout << "\n";
+  std::cout << "  Options:\n";
+  std::cout << "         --repetitions n Number of delays per method and duration (default: 1000)\n";
+  std::cout << "         --verbose       Prints additional (debug) information\n";
+  std::cout << "    -h | --help          Displays this help\n";
+  std::cout << std::flush;
+}
+
+void runBenchmark(
+    const std::size_t numberOfRepetitions) {
+  demo::timing::calibrate();
+  std::cout << "Clock read duration: " << demo::timing::getClockReadDuration().count() << "ns\n"
+            << "Wake-up latency:     " << demo::timing::getWakeUpLatency().count() << "ns" << std::endl;
+
+  std::cout << "+-----------------------------+--------------+--------------+--------------+--------------+\n"
+            << "| Method                      | Request [us] | Mean [us]    | Median [us]  | Max [us]     |\n"
+            << "+-----------------------------+--------------+--------------+--------------+--------------+" << std::endl;
+
+  // 2us and 10us: HC-SR04 reset and trigger pulse, 20us: echo settle time, 220us: distance indicator latch, 5ms: PCA9685 oscillator wake-up.
+  for (const std::chrono::nanoseconds delay : {std::chrono::nanoseconds(std::chrono::microseconds(2)), std::chrono::nanoseconds(std::chrono::microseconds(10)), std::chrono::nanoseconds(std::chrono::microseconds(20)), std::chrono::nanoseconds(std::chrono::microseconds(220)), std::chrono::nanoseconds(std::chrono::milliseconds(5))}) {
+    // This was the former implementation.
+    printJitter("std::this_thread::sleep_for", delay, numberOfRepetitions, [](const std::chrono::nanoseconds delay) {std::this_thread::sleep_for(delay);});
+    printJitter("demo::timing::sleepUntil", delay, numberOfRepetitions, [](const std::chrono::nanoseconds delay) {demo::timing::sleepUntil(std::chrono::steady_clock::now() + delay);});
+    printJitter("demo::timing::busyWait", delay, numberOfRepetitions, [](const std::chrono::nanoseconds delay) {demo::timing::busyWait(delay);});
+    printJitter("demo::timing::wait", delay, numberOfRepetitions, [](const std::chrono::nanoseconds delay) {demo::timing::wait(delay);});
+    std::cout << "+-----------------------------+--------------+--------------+--------------+--------------+" << std::endl;
+  }
+}
+
+void printJitter(
+    const std::string& method,
+    const std::chrono::nanoseconds delay,
+    const std::size_t numberOfRepetitions,
+    const std::function<void(std::chrono::nanoseconds)>& wait) {
+  std::vector<double> achievedDelays;
+  achievedDelays.reserve(numberOfRepetitions);
+  for (std::size_t n = 0; n < numberOfRepetitions; ++n) {
+    const auto start = std::chrono::steady_clock::now();
+    wait(delay);
+    achievedDelays.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::sort(achievedDelays.begin(), achievedDelays.end());
+
+  double mean = 0.0;
+  for (const auto achievedDelay : achievedDelays) {
+    mean += achievedDelay / static_cast<double>(achievedDelays.size());
+  }
+
+  std::cout << "| " << std::left << std::setw(27) << method << std::right << std::fixed << std::setprecision(2)
+            << " | " << std::setw(12) << std::chrono::duration<double, std::micro>(delay).count()
+            << " | " << std::setw(12) << mean
+            << " | " << std::setw(12) << achievedDelays.at(achievedDelays.size() / 2)
+            << " | " << std::setw(12) << achievedDelays.back() << " |" << std::endl;
+}
@@ -0,0 +1,151 @@
+// C++ standard library
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Demonstrator
+#include <demonstrator>
+
+// Application
+#include "../commandline.hpp"
+
+void showHelp();
+void runDecoder(
+    const std::string& path);
+void runSummary(
+    const std::string& path);
+void runBenchmark(
+    const std::size_t numberOfRecords);
+
+int main (const int argc, const char* argv[]) {
+  if (argc < 2 || hasOption(argc, argv, "-h") || hasOption(argc, argv, "--help")) {
+    showHelp();
+    // Terminates the program after the help is shown.
+    return 0;
+  }
+
+  if (hasOption(argc, argv, "--verbose")) {
+    ::demo::isVerbose = true;
+  }
+
+  if (static_cast<std::string>(argv[1]) == "benchmark") {
+    runBenchmark(isNumber(getOptionValue(argc, argv, "--records")) ? std::stoul(getOptionValue(argc, argv, "--records")) : 1000000);
+  } else if (hasOption(argc, argv, "--summary")) {
+    runSummary(argv[1]);
+  } else {
+    runDecoder(argv[1]);
+  }
+
+  return 0;
+}
+
+void showHelp() {
+  std::cout << "Usage:\n";
+  std::cout << "  program file [options ...]\n";
+  std::cout << "    Decodes a trace file (as recorded via the `--trace` option of the maintenance applications) and prints one line per record\n";
+  std::cout << "      --summary        Prints the number of records per component and operation instead\n";
+  std::cout << "\n";
+  std::cout << "  program benchmark [options ...]\n";
+  std::cout << "    Prints the average time to record a trace record, with tracing stopped and started\n";
+  std::cout << "      --records n      Number of records per measurement (default: 1000000)\n";
+  std::cout << "\n";
+  std::cout << "  Options:\n";
+  std::cout << "         --verbose    Prints additional (debug) information\n";
+  std::cout << "    -h | --help       Displays this help\n";
+  std::cout << std::flush;
+}
+
+void runDecoder(
+    const std::string& path) {
+  const std::vector<demo::trace::Record>& records = demo::trace::readFile(path);
+  if (records.empty()) {
+    std::cout << "The trace is empty." << std::endl;
+    return;
+  }
+
+  std::cout << "+--------------+------------+--------+-----------+----------------------+---------+------------+\n"
+            << "| Time [us]    | Delta [us] | Thread | Component | Operation            | Address | Value      |\n"
+            << "+--------------+------------+--------+-----------+----------------------+---------+------------+" << std::endl;
+
+  // The delta is measured to the previous record of the same thread, e.g. the time between two SPI clock edges.
+  std::map<std::uint32_t, std::uint64_t> previousTimestamps;
+  for (const auto& record : records) {
+    const auto previousTimestamp = previousTimestamps.find(record.threadNumber);
+    const double delta = (previousTimestamp != previousTimestamps.end() ? static_cast<double>(record.timestamp - previousTimestamp->second) / 1000.0 : 0.0);
+    previousTimestamps[record.threadNumber] = record.timestamp;
+
+    std::cout << "| " << std::setw(12) << std::fixed << std::setprecision(3) << static_cast<double>(record.timestamp - records.front().timestamp) / 1000.0
+              << " | " << std::setw(10) << delta
+              << " | " << std::setw(6) << record.threadNumber
+              << " | " << std::left << std::setw(9) << demo::trace::getComponentName(record.component)
+              << " | " << std::setw(20) << demo::trace::getOperationName(record.operation) << std::right
+              << " | " << std::setw(7) << record.address
+              << " | " << std::setw(10) << record.value << " |\n";
+  }
+
+  std::cout << "+--------------+------------+--------+-----------+----------------------+---------+------------+" << std::endl;
+}
+
+void runSummary(
+    const std::string& path) {
+  const std::vector<demo::trace::Record>& records = demo::trace::readFile(path);
+
+  std::map<std::pair<demo::trace::Component, demo::trace::Operation>, std::size_t> numberOfRecords;
+  for (const auto& record : records) {
+    ++numberOfRecords[{record.component, record.operation}];
+  }
+
+  std::cout << "+-----------+----------------------+--------------+\n"
+            << "| Component | Operation            | Records      |\n"
+            << "+-----------+----------------------+--------------+" << std::endl;
+  for (const auto& count : numberOfRecords) {
+    std::cout << "| " << std::left << std::setw(9) << demo::trace::getComponentName(count.first.first)
+              << " | " << std::setw(20) << demo::trace::getOperationName(count.first.second) << std::right
+              << " | " << std::setw(12) << count.second << " |\n";
+  }
+  std::cout << "+-----------+----------------------+--------------+" << std::endl;
+
+  if (!records.empty()) {
+    std::cout << "Duration: " << std::fixed << std::setprecision(3) << static_cast<double>(records.back().timestamp - records.front().timestamp) / 1000.0 << "us" << std::endl;
+  }
+}
+
+void runBenchmark(
+    const std::size_t numberOfRecords) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < numberOfRecords; ++n) {
+    demo::trace::record(demo::trace::Component::Pin, demo::trace::Operation::Set, 17, static_cast<unsigned int>(n % 2));
+  }
+  const double stoppedRecordTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfRecords);
+
+  try {
+    // The records are drained into nothing, as only the time spent by the recording thread is of interest.
+    demo::trace::start("/dev/null", std::chrono::milliseconds(1));
+  } catch (const std::logic_error&) {
+    std::cout << "Record (stopped): " << std::fixed << std::setprecision(2) << stoppedRecordTime << "ns\n"
+              << "**Note:** The Demonstrator library was built without `USE_TRACE`, so all records are compiled out." << std::endl;
+    return;
+  }
+
+  start = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < numberOfRecords; ++n) {
+    demo::trace::record(demo::trace::Component::Pin, demo::trace::Operation::Set, 17, static_cast<unsigned int>(n % 2));
+  }
+  const double startedRecordTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numberOfRecords);
+
+  demo::trace::stop();
+
+  std::cout << "+----------------------+-----------------+\n"
+            << "| Tracing              | Record [ns]     |\n"
+            << "+----------------------+-----------------+\n"
+            << "| Stopped              | " << std::setw(15) << std::fixed << std::setprecision(2) << stoppedRecordTime << " |\n"
+            << "| Started              | " << std::setw(15) << startedRecordTime << " |\n"
+            << "+----------------------+-----------------+" << std::endl;
+  std::cout << "Dropped records: " << demo::trace::getNumberOfDroppedRecords() << " (the drainer couldn't keep up)" << std::endl;
+}
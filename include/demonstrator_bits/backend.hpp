@@ -0,0 +1,169 @@
+#pragma once
+
+// C++ standard library
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace demo {
+  /**
+   * The hardware access layer behind `::demo::Pin`, `::demo::PinGroup`, `::demo::Spi`, `::demo::I2cBus` and `::demo::Uart`.
+   *
+   * All pins use BCM GPIO numbering. A backend provides GPIO access, access to the I2C bus, the path of the UART device and (optionally) the hardware SPI controller. Without the latter, the SPI bus is bit-banged over the GPIO pins.
+   *
+   * The backend in use is selected via `::demo::Gpio::setBackend`. Unless another backend is set, `::demo::Gpio` uses a `::demo::WiringPiBackend` (if `USE_WIRINGPI` is defined and `USE_GPIOMEM` isn't) or a `::demo::GpioMemBackend`. A `::demo::SimulatedBackend` runs everything without any Raspberry Pi hardware.
+   */
+  class Backend {
+   public:
+    enum class Mode : unsigned int {
+      Input = 0,
+      Output = 1,
+      /**
+       * Hands the pin over to the SoC's peripheral, e.g. the SPI controller for pins 7 to 11.
+       */
+      Alternate0 = 4
+    };
+
+    /**
+     * The SPI clock polarity (bit 1, CPOL) and phase (bit 0, CPHA). With CPOL 0, the clock idles low; with CPHA 0, data is sampled on the leading clock edge and changed on the trailing one.
+     */
+    enum class SpiMode : unsigned int {
+      Mode0 = 0,
+      Mode1 = 1,
+      Mode2 = 2,
+      Mode3 = 3
+    };
+
+    /**
+     * A single full-duplex transfer of `length` bytes, as part of a SPI message. The slave is selected during the transfer and deselected afterwards.
+     */
+    struct SpiTransfer {
+      const std::uint8_t* transmitted;
+      std::uint8_t* received;
+      std::size_t length;
+      /**
+       * The slave's number, as counted by `::demo::Spi`. Ignored by `transferSpi()`, as its handle already determines the slave.
+       */
+      unsigned int slave = 0;
+    };
+
+    /**
+     * Switches the pin to input or output mode. May be called before every access, so implementations should skip unchanged modes, if this is cheaper than setting it again.
+     */
+    virtual void setMode(
+        const unsigned int pinNumber,
+        const Mode mode) = 0;
+
+    /**
+     * Sets all pins whose bit is set in `mask` (bit `n` represents pin `n`) high. The other pins remain unchanged.
+     */
+    virtual void set(
+        const std::uint32_t mask) = 0;
+
+    /**
+     * Sets all pins whose bit is set in `mask` low. The other pins remain unchanged.
+     */
+    virtual void clear(
+        const std::uint32_t mask) = 0;
+
+    /**
+     * Returns the current levels of pins 0 to 31 (bit `n` represents pin `n`).
+     */
+    virtual std::uint32_t getLevels() = 0;
+
+    /**
+     * Returns the current level of a single pin. Defaults to reading all levels via `getLevels()`, which implementations may override if reading a single pin is cheaper.
+     */
+    virtual bool get(
+        const unsigned int pinNumber);
+
+    /**
+     * The maximal number of values written by a single `setI2cRegisters()` call.
+     */
+    static const std::size_t MAXIMAL_NUMBER_OF_I2C_VALUES = 64;
+
+    /**
+     * Opens the I2C bus and returns a handle, which is shared by all slaves on the bus. The 7-bit slave address is instead passed with each access.
+     *
+     * Throws a `std::runtime_error` if the bus could not be opened.
+     */
+    virtual int openI2cBus() = 0;
+
+    /**
+     * Writes `numberOfValues` bytes into consecutive registers of the slave at `address`, starting at `firstRegisterNumber`, within a single bus transaction (i.e. the register number followed by all values). This relies on the slave to increment its register pointer after each byte (such as the PCA9685 with its auto-increment bit set).
+     *
+     * Defaults to `trySetI2cRegisters()`.
+     *
+     * Throws a `std::invalid_argument` if there are more than `MAXIMAL_NUMBER_OF_I2C_VALUES` values.
+     * Throws a `std::runtime_error` if the transaction failed.
+     */
+    virtual void setI2cRegisters(
+        const int handle,
+        const unsigned int address,
+        const unsigned int firstRegisterNumber,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues);
+
+    /**
+     * Same as `setI2cRegisters`, but async-signal-safe (i.e. without allocating memory, taking locks or throwing), as needed to stop the actuators from a signal handler. Returns false if the transaction failed, or if there are more than `MAXIMAL_NUMBER_OF_I2C_VALUES` values.
+     *
+     * Defaults to a single `I2C_RDWR` message of the Linux i2c-dev interface, which requires the handle to be an i2c-dev file descriptor (as returned by the hardware backends).
+     */
+    virtual bool trySetI2cRegisters(
+        const int handle,
+        const unsigned int address,
+        const unsigned int firstRegisterNumber,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues) noexcept;
+
+    /**
+     * Reads a single register of the slave at `address`.
+     *
+     * Defaults to an `I2C_RDWR` message pair of the Linux i2c-dev interface, writing the register number and reading its value, separated by a repeated start condition.
+     *
+     * Throws a `std::runtime_error` if the transaction failed.
+     */
+    virtual unsigned int getI2cRegister(
+        const int handle,
+        const unsigned int address,
+        const unsigned int registerNumber);
+
+    /**
+     * Defaults to closing the handle as a file descriptor.
+     */
+    virtual void closeI2cBus(
+        const int handle);
+
+    /**
+     * Returns the path of the (character) device the UART is accessed through, such as `/dev/ttyAMA0`.
+     */
+    virtual std::string getUartDevicePath() = 0;
+
+    /**
+     * Opens the hardware SPI controller for the slave at the specified chip select (0 for `CE0`, 1 for `CE1`), using the specified SPI mode and a clock of at most `clockFrequency` Hz, and returns a handle to be passed to `transferSpi()`.
+     *
+     * Defaults to the kernel's spidev driver (`/dev/spidev0.<chipSelect>`), which works independent of how the GPIO pins are accessed. **Note:** The driver switches the SPI pins to their SPI function only once, when it is loaded. After the pins were bit-banged, they must be switched back via `setMode(..., Mode::Alternate0)`.
+     *
+     * Throws a `std::runtime_error` if the controller could not be opened or configured, e.g. as SPI isn't enabled.
+     */
+    virtual int openSpiDevice(
+        const unsigned int chipSelect,
+        const unsigned int clockFrequency,
+        const SpiMode mode);
+
+    /**
+     * Performs all transfers as a single message, i.e. within a single system call. The received bytes are written to each transfer's `received` buffer, unless it is `nullptr`. The bits of each byte are sent and received most significant bit first.
+     *
+     * Throws a `std::runtime_error` if the message could not be transferred.
+     */
+    virtual void transferSpi(
+        const int handle,
+        const std::vector<SpiTransfer>& transfers);
+
+    virtual void closeSpiDevice(
+        const int handle);
+
+    virtual ~Backend() = default;
+  };
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// C++ standard library
+#include <cstdint>
+#include <string>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+
+namespace demo {
+  /**
+   * Accesses the GPIO pins directly through the memory-mapped register block (see `::demo::GpioRegisters`), the I2C bus through the Linux i2c-dev interface (e.g. `/dev/i2c-1`) and the UART through its character device (e.g. `/dev/ttyAMA0`).
+   *
+   * This backend only depends on the Linux kernel, not on wiringPi.
+   */
+  class GpioMemBackend : public Backend {
+   public:
+    explicit GpioMemBackend(
+        const std::string& i2cDevicePath = "/dev/i2c-1",
+        const std::string& uartDevicePath = "/dev/ttyAMA0");
+
+    void setMode(
+        const unsigned int pinNumber,
+        const Mode mode) override;
+
+    void set(
+        const std::uint32_t mask) override;
+
+    void clear(
+        const std::uint32_t mask) override;
+
+    std::uint32_t getLevels() override;
+
+    /**
+     * Opens the i2c-dev device, using the defaults of `::demo::Backend` to access the slaves.
+     *
+     * Throws a `std::runtime_error` if the I2C bus could not be opened.
+     */
+    int openI2cBus() override;
+
+    std::string getUartDevicePath() override;
+
+   protected:
+    const std::string i2cDevicePath_;
+    const std::string uartDevicePath_;
+  };
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+// C++ standard library
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+
+namespace demo {
+  /**
+   * Simulates the devices of the demonstrator in-process, which allows to run (and benchmark) the library and all applications on any Linux machine:
+   *
+   * - **HC-SR04 distance sensors:** A pin that is switched from high to low while in output mode (the trigger pulse) starts an echo on the same pin, which rises 250 microseconds later and lasts 58 microseconds per centimetre. The distance defaults to 0.2 m and can be changed per pin via `setDistance()`.
+   * - **MCP3008 ADCs:** Listen to the bit-banged SPI pins of `::demo::Spi` (MISO 9, MOSI 10, clock 11), as well as to the hardware SPI controller (see `openSpiDevice()`), and answer single-ended conversions with the values set via `setAnalogValue()` (defaulting to the middle of the range), plus the optional noise set via `setAnalogNoise()`. One ADC is selected via `CE0` (pin 8) and one via `CE1` (pin 7). Further ADCs are attached to other chip select pins by setting one of their values.
+   * - **PCA9685 PWM controller:** Provides the 256 registers of an I2C slave at address `PCA9685_ADDRESS`, initialised to their power-on values. Writes to the ALL_LED registers (0xFA to 0xFD) are loaded into the respective LEDn register of all 16 channels, like the actual device.
+   * - **Razor IMU:** The UART is a pseudo terminal, to which a background thread writes a `#YPR=yaw,pitch,roll` line (in degrees) every 20 milliseconds. The attitude can be changed via `setAttitude()`. Sending `#r` resets the current attitude to zero.
+   *
+   * All other pins simply keep the level they were set to, or read as low if they are inputs.
+   */
+  class SimulatedBackend : public Backend {
+   public:
+    static const unsigned int PCA9685_ADDRESS = 0x40;
+
+    SimulatedBackend();
+
+    SimulatedBackend(SimulatedBackend&) = delete;
+    SimulatedBackend& operator=(SimulatedBackend&) = delete;
+
+    void setMode(
+        const unsigned int pinNumber,
+        const Mode mode) override;
+
+    void set(
+        const std::uint32_t mask) override;
+
+    void clear(
+        const std::uint32_t mask) override;
+
+    std::uint32_t getLevels() override;
+
+    int openI2cBus() override;
+
+    /**
+     * Increments the register number after each byte only if the auto-increment bit of the PCA9685's MODE1 register is set, like the actual device.
+     *
+     * Throws a `std::runtime_error` if `address` is not `PCA9685_ADDRESS` (i.e. the slave wouldn't acknowledge).
+     */
+    void setI2cRegisters(
+        const int handle,
+        const unsigned int address,
+        const unsigned int firstRegisterNumber,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues) override;
+
+    /**
+     * Same as `setI2cRegisters`, returning false instead of throwing. **Note:** This takes the lock of the simulated devices, and is therefore not async-signal-safe.
+     */
+    bool trySetI2cRegisters(
+        const int handle,
+        const unsigned int address,
+        const unsigned int firstRegisterNumber,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues) noexcept override;
+
+    /**
+     * Throws a `std::runtime_error` if `address` is not `PCA9685_ADDRESS`.
+     */
+    unsigned int getI2cRegister(
+        const int handle,
+        const unsigned int address,
+        const unsigned int registerNumber) override;
+
+    void closeI2cBus(
+        const int handle) override;
+
+    /**
+     * Creates the pseudo terminal and starts the simulated IMU on first call.
+     *
+     * Throws a `std::runtime_error` if the pseudo terminal could not be created.
+     */
+    std::string getUartDevicePath() override;
+
+    /**
+     * Stands in for `/dev/spidev0.0` and `/dev/spidev0.1`, connected to the simulated MCP3008 at `CE0`, respectively `CE1`. The clock frequency is ignored, as is the mode, since the MCP3008 answers the same in SPI mode 0 and 3.
+     *
+     * Throws a `std::runtime_error` if `chipSelect` isn't 0 or 1.
+     */
+    int openSpiDevice(
+        const unsigned int chipSelect,
+        const unsigned int clockFrequency,
+        const SpiMode mode) override;
+
+    /**
+     * Clocks all transfers bit by bit (in SPI mode 0) through the simulated MCP3008. Transfers without a `received` buffer discard the response.
+     */
+    void transferSpi(
+        const int handle,
+        const std::vector<SpiTransfer>& transfers) override;
+
+    void closeSpiDevice(
+        const int handle) override;
+
+    /**
+     * Sets the distance (in metres) measured by the HC-SR04 triggered via the specified pin.
+     */
+    void setDistance(
+        const unsigned int pinNumber,
+        const double distance);
+
+    /**
+     * Sets the 10-bit conversion result of the specified channel of the MCP3008 at `CE0`.
+     *
+     * Throws a `std::domain_error` if `channel` is greater than 7 or `value` is greater than 1023.
+     */
+    void setAnalogValue(
+        const unsigned int channel,
+        const unsigned int value);
+
+    /**
+     * Sets the 10-bit conversion result of the specified channel of the MCP3008 selected via `chipSelectPin`, attaching a new one if there is none yet.
+     *
+     * Throws a `std::domain_error` if `channel` is greater than 7 or `value` is greater than 1023.
+     */
+    void setAnalogValue(
+        const unsigned int chipSelectPin,
+        const unsigned int channel,
+        const unsigned int value);
+
+    /**
+     * Adds Gaussian noise with the specified standard deviation (in LSB) to each conversion of the specified channel of the MCP3008 at `CE0`, e.g. to benchmark the sampling of `::demo::Sensors`. The noisy result is rounded and clamped to [0, 1023]. The noise is pseudo-random, but reproducible between runs.
+     *
+     * Throws a `std::domain_error` if `channel` is greater than 7 or `standardDeviation` is negative.
+     */
+    void setAnalogNoise(
+        const unsigned int channel,
+        const double standardDeviation);
+
+    /**
+     * Same as `setAnalogNoise(channel, standardDeviation)`, for the MCP3008 selected via `chipSelectPin`, attaching a new one if there is none yet.
+     */
+    void setAnalogNoise(
+        const unsigned int chipSelectPin,
+        const unsigned int channel,
+        const double standardDeviation);
+
+    /**
+     * Returns the current value of a PCA9685 register, e.g. to check the PWM duty cycles written by `::demo::ServoControllers`.
+     */
+    unsigned int getPca9685Register(
+        const unsigned int registerNumber);
+
+    /**
+     * Sets the attitude (in degrees) reported by the simulated IMU.
+     */
+    void setAttitude(
+        const double yaw,
+        const double pitch,
+        const double roll);
+
+    ~SimulatedBackend();
+
+   protected:
+    /**
+     * The bit-level protocol of a MCP3008: The command (a start bit, the single/differential bit and 3 channel bits) is sampled on the rising clock edges, ignoring any leading zeros. Afterwards, the output is shifted out on the falling clock edges: After the sample period, a null bit, the result MSB-first and (while still selected) the result LSB-first.
+     */
+    class Mcp3008 {
+     public:
+      Mcp3008();
+
+      void setAnalogValue(
+          const unsigned int channel,
+          const unsigned int value);
+
+      void setAnalogNoise(
+          const unsigned int channel,
+          const double standardDeviation);
+
+      void select();
+
+      void deselect();
+
+      void clockRisingEdge(
+          const bool input);
+
+      void clockFallingEdge();
+
+      bool getOutput() const;
+
+     protected:
+      std::array<unsigned int, 8> analogValues_;
+      std::array<double, 8> analogNoises_;
+      std::minstd_rand noiseGenerator_;
+      /**
+       * The (noisy) value of the selected channel, sampled once the command is complete.
+       */
+      unsigned int sampledValue_;
+      bool isSelected_;
+      unsigned int numberOfCommandBits_;
+      unsigned int command_;
+      /**
+       * The number of falling clock edges since the last command bit was sampled.
+       */
+      unsigned int numberOfOutputEdges_;
+      bool output_;
+    };
+
+    std::mutex mutex_;
+
+    /**
+     * Bit `n` is set if pin `n` is in output mode, respectively set high.
+     */
+    std::uint32_t outputPins_;
+    std::uint32_t outputLevels_;
+
+    std::unordered_map<unsigned int, double> distances_;
+    std::unordered_map<unsigned int, std::chrono::steady_clock::time_point> echoStarts_;
+    std::unordered_map<unsigned int, std::chrono::steady_clock::time_point> echoEnds_;
+
+    /**
+     * The MCP3008s, by chip select pin.
+     */
+    std::unordered_map<unsigned int, Mcp3008> adcs_;
+
+    std::array<unsigned int, 256> pca9685Registers_;
+
+    int uartMasterFileDescriptor_;
+    /**
+     * Kept open, so that the pseudo terminal remains valid while no one else has it open.
+     */
+    int uartSlaveFileDescriptor_;
+    std::string uartDevicePath_;
+    std::array<double, 3> attitude_;
+    std::array<double, 3> attitudeOffset_;
+    std::atomic<bool> killImuThread_;
+    std::thread imuThread_;
+
+    /**
+     * Forwards the level changes from `previousLevels` to `outputLevels_` to the simulated HC-SR04s and MCP3008s. Must be called while holding `mutex_`.
+     */
+    void updateDevices(
+        const std::uint32_t previousLevels);
+
+    void simulateImu();
+  };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "demonstrator_bits/config.hpp"
+
+#if defined(USE_WIRINGPI)
+// C++ standard library
+#include <cstdint>
+#include <string>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+
+namespace demo {
+  /**
+   * Accesses the GPIO pins through the [wiringPi library](http://wiringpi.com/), the I2C bus through the Linux i2c-dev interface and the UART through `/dev/ttyAMA0`.
+   *
+   * This was the only way to access the hardware in previous versions, and is only available if `USE_WIRINGPI` is defined.
+   */
+  class WiringPiBackend : public Backend {
+   public:
+    /**
+     * Initialises wiringPi, using the BCM pin layout. For an overview on the pin layout, use the `gpio readall` command on a Raspberry Pi.
+     */
+    WiringPiBackend();
+
+    void setMode(
+        const unsigned int pinNumber,
+        const Mode mode) override;
+
+    void set(
+        const std::uint32_t mask) override;
+
+    void clear(
+        const std::uint32_t mask) override;
+
+    /**
+     * **Note:** This reads one pin after another. Use `get()` to read a single pin.
+     */
+    std::uint32_t getLevels() override;
+
+    bool get(
+        const unsigned int pinNumber) override;
+
+    /**
+     * Opens the i2c-dev device wiringPi would use for the board's revision, using the defaults of `::demo::Backend` to access the slaves (as wiringPi's I2C functions are bound to a single slave).
+     *
+     * Throws a `std::runtime_error` if the I2C bus could not be opened.
+     */
+    int openI2cBus() override;
+
+    std::string getUartDevicePath() override;
+  };
+}
+#endif
@@ -0,0 +1,279 @@
+#pragma once
+
+// C++ standard library
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/pin.hpp"
+
+namespace demo {
+  /**
+   * Compile-time helpers for `::demo::Pins` and `::demo::BoardProfile`.
+   */
+  namespace pinMasks {
+    constexpr std::uint32_t getMask() {
+      return 0;
+    }
+
+    /**
+     * Returns the register mask of the specified pins (using BCM GPIO numbering), i.e. bit `n` is set if pin `n` is given.
+     */
+    template <typename... PinNumbers>
+    constexpr std::uint32_t getMask(
+        const unsigned int pinNumber,
+        const PinNumbers... pinNumbers) {
+      return (1u << pinNumber) | getMask(pinNumbers...);
+    }
+
+    constexpr bool hasDuplicates() {
+      return false;
+    }
+
+    template <typename... PinNumbers>
+    constexpr bool hasDuplicates(
+        const unsigned int pinNumber,
+        const PinNumbers... pinNumbers) {
+      return ((getMask(pinNumbers...) >> pinNumber) & 1u) != 0 || hasDuplicates(pinNumbers...);
+    }
+
+    constexpr bool isWithinRange() {
+      return true;
+    }
+
+    /**
+     * Checks that all pin numbers are within [2, 27], like `::demo::Gpio::allocatePin`.
+     */
+    template <typename... PinNumbers>
+    constexpr bool isWithinRange(
+        const unsigned int pinNumber,
+        const PinNumbers... pinNumbers) {
+      return pinNumber >= 2 && pinNumber <= 27 && isWithinRange(pinNumbers...);
+    }
+
+    constexpr std::uint32_t getUnion() {
+      return 0;
+    }
+
+    template <typename... Masks>
+    constexpr std::uint32_t getUnion(
+        const std::uint32_t mask,
+        const Masks... masks) {
+      return mask | getUnion(masks...);
+    }
+
+    constexpr bool areDisjoint() {
+      return true;
+    }
+
+    template <typename... Masks>
+    constexpr bool areDisjoint(
+        const std::uint32_t mask,
+        const Masks... masks) {
+      return (mask & getUnion(masks...)) == 0 && areDisjoint(masks...);
+    }
+  }
+
+  /**
+   * A set of pins (using BCM GPIO numbering) that is known at compile time, such as the data pins of the distance indicators.
+   *
+   * Besides the pin numbers, this provides the register mask and inlined accessors, which pass the whole set to the backend (see `::demo::Gpio::getBackend`) at once, without any ownership check or mode switch. Therefore, they also work with a `::demo::SimulatedBackend`. The bit-to-pin mapping is unrolled at compile time. These accessors are meant for hot paths, after the pins were allocated once (e.g. via `::demo::BoardProfile::allocate`) and their mode was set via `setMode()`.
+   *
+   * Duplicated pin numbers or pins outside of [2, 27] are rejected at compile time.
+   */
+  template <unsigned int... pinNumbers>
+  class Pins {
+    static_assert(sizeof...(pinNumbers) > 0, "Pins: At least one pin must be given.");
+    static_assert(sizeof...(pinNumbers) <= 32, "Pins: At most 32 pins can be given.");
+    static_assert(pinMasks::isWithinRange(pinNumbers...), "Pins: All pin numbers must be within [2, 27].");
+    static_assert(!pinMasks::hasDuplicates(pinNumbers...), "Pins: The pin numbers must be unique.");
+
+   public:
+    static constexpr std::size_t size = sizeof...(pinNumbers);
+
+    /**
+     * Bit `n` is set if pin `n` is part of this set.
+     */
+    static constexpr std::uint32_t mask = pinMasks::getMask(pinNumbers...);
+
+    /**
+     * Returns the BCM GPIO number of the `n`-th pin.
+     */
+    template <std::size_t n>
+    static constexpr unsigned int getPinNumber() {
+      static_assert(n < size, "Pins.getPinNumber: The index must be less than the number of pins.");
+      const std::array<unsigned int, size> allPinNumbers = {{pinNumbers...}};
+      return allPinNumbers[n];
+    }
+
+    /**
+     * Maps bit `n` of `bitmask` to the `n`-th pin, i.e. converts a bitmask like the ones used by `::demo::PinGroup` into a register mask.
+     */
+    static constexpr std::uint32_t toRegisterMask(
+        const std::uint32_t bitmask) {
+      std::uint32_t registerMask = 0;
+      std::size_t n = 0;
+      // Expands to one shift per pin. The evaluation order of an initialiser list is guaranteed to be left-to-right.
+      static_cast<void>(std::initializer_list<int>{(registerMask |= ((bitmask >> n++) & 1u) << pinNumbers, 0)...});
+      return registerMask;
+    }
+
+    /**
+     * The inverse of `toRegisterMask()`.
+     */
+    static constexpr std::uint32_t fromRegisterMask(
+        const std::uint32_t registerMask) {
+      std::uint32_t bitmask = 0;
+      std::size_t n = 0;
+      static_cast<void>(std::initializer_list<int>{(bitmask |= ((registerMask >> pinNumbers) & 1u) << n++, 0)...});
+      return bitmask;
+    }
+
+    /**
+     * Sets the function of all pins. Should be called once before `write()`, respectively `read()`.
+     */
+    static inline void setMode(
+        const Backend::Mode mode) {
+      Backend& backend = Gpio::getBackend();
+      static_cast<void>(std::initializer_list<int>{(backend.setMode(pinNumbers, mode), 0)...});
+    }
+
+    /**
+     * Sets the `n`-th pin to bit `n` of `bitmask`. All pins set high change within a single `::demo::Backend::set` call (e.g. a single write to `GPSET0`), followed by a single `::demo::Backend::clear` call for all pins set low.
+     */
+    static inline void write(
+        const std::uint32_t bitmask) {
+      Backend& backend = Gpio::getBackend();
+      const std::uint32_t highPins = toRegisterMask(bitmask);
+      backend.set(highPins);
+      backend.clear(mask & ~highPins);
+    }
+
+    /**
+     * Returns the current values of all pins, with bit `n` representing the `n`-th pin.
+     */
+    static inline std::uint32_t read() {
+      return fromRegisterMask(Gpio::getBackend().getLevels());
+    }
+
+    /**
+     * Asks `::demo::Gpio` for the ownership of each pin, in the given order.
+     *
+     * Throws a `std::runtime_error` if any pin is already allocated at runtime (e.g. by code that doesn't use board profiles).
+     */
+    static std::vector<Pin> allocate() {
+      std::vector<Pin> pins;
+      pins.reserve(size);
+      static_cast<void>(std::initializer_list<int>{(pins.push_back(Gpio::allocatePin(pinNumbers)), 0)...});
+      return pins;
+    }
+  };
+
+  template <unsigned int... pinNumbers>
+  constexpr std::size_t Pins<pinNumbers...>::size;
+
+  template <unsigned int... pinNumbers>
+  constexpr std::uint32_t Pins<pinNumbers...>::mask;
+
+  /**
+   * The pins reserved by `::demo::Gpio::allocateSpi` (`CE1`, `CE0`, `MISO`, `MOSI` and `SCLK`).
+   */
+  using SpiPins = Pins<7, 8, 9, 10, 11>;
+
+  /**
+   * The pins reserved by `::demo::Gpio::allocateI2c` (`SDA` and `SCL`).
+   */
+  using I2cPins = Pins<2, 3>;
+
+  /**
+   * The pins reserved by `::demo::Gpio::allocateUart` (`TXD` and `RXD`).
+   */
+  using UartPins = Pins<14, 15>;
+
+  /**
+   * The protocol timings of the devices attached to a board, which depend on the devices' revisions and wiring rather than on the library. Each board profile comes with its own timings, which are passed to the device classes along with the pins allocated via the profile. The defaults match the data sheets.
+   */
+  struct BoardTimings {
+    /**
+     * How long the MY9221's data pins are held after the last clock edge, before the latch pulses are sent (at least 220 microseconds).
+     */
+    std::chrono::microseconds indicatorLatchDelay = std::chrono::microseconds(220);
+
+    /**
+     * The PCA9685's PRE_SCALE register, which sets the PWM frequency to 25 MHz / (4096 * (pwmPrescale + 1)), i.e. about 1017 Hz by default.
+     */
+    std::uint8_t pwmPrescale = 5;
+
+    /**
+     * How long the PCA9685's oscillator needs to stabilise after waking up.
+     */
+    std::chrono::microseconds pwmOscillatorStartup = std::chrono::milliseconds(5);
+  };
+
+  /**
+   * The wiring of a single Raspberry Pi, as a list of `::demo::Pins` sets (e.g. `BoardProfile<Pins<22, 5, 6, 13, 19, 26>, SpiPins, I2cPins>`).
+   *
+   * Any pin that is used by more than one set is rejected at compile time, as soon as the profile is used. To reserve the pins of a bus, add `::demo::SpiPins`, `::demo::I2cPins` or `::demo::UartPins`.
+   *
+   * Pins should be allocated through the profile (instead of `::demo::Gpio::allocatePin`), which only compiles for sets that are part of it. The runtime ownership is still tracked by `::demo::Gpio`, so that the pins are protected against any allocation outside of the profile.
+   */
+  template <typename... PinSets>
+  class BoardProfile {
+    static_assert(pinMasks::areDisjoint(PinSets::mask...), "BoardProfile: The pin sets must not overlap.");
+
+   public:
+    BoardProfile() = delete;
+    BoardProfile(BoardProfile&) = delete;
+    BoardProfile operator=(BoardProfile&) = delete;
+
+    /**
+     * All pins used by this board.
+     */
+    static constexpr std::uint32_t mask = pinMasks::getUnion(PinSets::mask...);
+
+    /**
+     * The `n`-th pin set of this profile.
+     */
+    template <std::size_t n>
+    using PinSet = typename std::tuple_element<n, std::tuple<PinSets...>>::type;
+
+    /**
+     * Returns `true` if `PinSet` is one of the pin sets of this profile.
+     */
+    template <typename PinSet>
+    static constexpr bool contains() {
+      return pinMasks::getUnion((std::is_same<PinSet, PinSets>::value ? 1u : 0u)...) != 0;
+    }
+
+    /**
+     * Asks `::demo::Gpio` for the ownership of all pins in `PinSet`, for example to construct `::demo::DistanceSensors`.
+     *
+     * Throws a `std::runtime_error` if any pin is already allocated.
+     */
+    template <typename PinSet>
+    static std::vector<Pin> allocate() {
+      static_assert(contains<PinSet>(), "BoardProfile.allocate: The pin set must be part of the profile.");
+      return PinSet::allocate();
+    }
+
+    /**
+     * Same as `allocate()`, but only for the `n`-th pin of `PinSet`, for example for a clock pin.
+     */
+    template <typename PinSet, std::size_t n = 0>
+    static Pin allocatePin() {
+      static_assert(contains<PinSet>(), "BoardProfile.allocatePin: The pin set must be part of the profile.");
+      return Gpio::allocatePin(PinSet::template getPinNumber<n>());
+    }
+  };
+
+  template <typename... PinSets>
+  constexpr std::uint32_t BoardProfile<PinSets...>::mask;
+}
@@ -11,8 +11,13 @@ namespace demo {
 
 // WiringPi exclusion must be set via CMake, to ensure that we also avoid linking against it.
 // Therefore, use `cmake ... -DUSE_WIRINGPI=[ON|OFF]` to decide whether`USE_WIRINGPI` is to be defined or not.
+// **Note:** Only `demo::WiringPiBackend` includes the wiringPi headers, so applications don't depend on them.
 #cmakedefine USE_WIRINGPI
-#if defined(USE_WIRINGPI)
-#include <wiringPi.h>
-#include <wiringPiI2C.h>
-#endif
+
+// Uses `demo::GpioMemBackend` (accessing the GPIO pins directly through the memory-mapped register block) as default backend, even if wiringPi is available.
+// Use `cmake ... -DUSE_GPIOMEM=[ON|OFF]` to decide whether `USE_GPIOMEM` is to be defined or not.
+#cmakedefine USE_GPIOMEM
+
+// Compiles the trace records of `demo::trace` into `demo::Pin`, `demo::Spi` and `demo::I2c`. Otherwise, these calls compile to nothing.
+// Use `cmake ... -DUSE_TRACE=[ON|OFF]` to decide whether `USE_TRACE` is to be defined or not.
+#cmakedefine USE_TRACE
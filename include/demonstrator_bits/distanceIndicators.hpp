@@ -1,14 +1,24 @@
 #pragma once
 
 // C++ standard library
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
+// Unix library
+#include <semaphore.h>
+
 // Armadillo
 #include <armadillo>
 
 // Demonstrator
+#include "demonstrator_bits/boardProfile.hpp"
 #include "demonstrator_bits/pin.hpp"
+#include "demonstrator_bits/pinGroup.hpp"
 
 /**
  * This class represents an array of MY9221[1] LED bars. A single LedArray manages many devices, where all of them are wired to the same clock. The number of LED bars is equal to the number of data pins that are passed to the constructor.
@@ -27,7 +37,9 @@
  *   .x........
  *   xx........
  *
- * The MY9221 API expects a 208 bit instruction on a single pin. The instruction format is described in the `setIndication()` method docs. Calling that method sends such an instruction on every data pin.
+ * Each of these patterns is a band of distances, numbered from 0 (closest) to 9 (farthest). The MY9221 API expects a 208 bit instruction on a single pin. The instruction format is described in the `encodeFrame()` method docs. As all bars share the clock, an instruction is always sent on every data pin, but only if the band of at least one bar changed since the last one.
+ *
+ * By default, each indication is sent within the calling thread, which takes a few hundred microseconds (including the latch delay). After `runAsynchronous()`, indications are instead stored into a mailbox and sent by a dedicated thread, so that sensing and control loops don't wait for the LED bars.
  *
  * [1]: https://www.seeedstudio.com/wiki/images/9/98/MY9221_DS_1.0.pdf
  */
@@ -43,12 +55,27 @@ namespace demo {
     const double warningDistance_;
     const double maximalDistance_;
 
+    /**
+     * The latch delay is taken from `boardTimings`, which should be the timings of the board profile the pins were allocated with.
+     */
     explicit DistanceIndicators(
         Pin&& clockPin,
         std::vector<Pin>&& dataPins,
         const double minimalDistance,
         const double warningDistance,
-        const double maximalDistance);
+        const double maximalDistance,
+        const BoardTimings& boardTimings = BoardTimings());
+
+    /**
+     * Same as above, but with already grouped data pins. The `n`-th pin of the group is connected to the `n`-th LED bar.
+     */
+    explicit DistanceIndicators(
+        Pin&& clockPin,
+        PinGroup&& dataPins,
+        const double minimalDistance,
+        const double warningDistance,
+        const double maximalDistance,
+        const BoardTimings& boardTimings = BoardTimings());
 
     explicit DistanceIndicators(
         DistanceIndicators&& distanceIndicators);
@@ -60,11 +87,61 @@ namespace demo {
     DistanceIndicators& operator=(DistanceIndicators&) = delete;
 
     /**
-     * Update the LED bars to indicate the assigned distances, as described in the class documentation.
+     * The number of patterns (and therefore distance bands) a bar can show.
+     */
+    static constexpr unsigned int numberOfBands_ = 10;
+
+    /**
+     * Update the LED bars to indicate the assigned distances, as described in the class documentation. Nothing is sent if every bar already shows the band of its distance.
      */
     void setIndication(
         const arma::Row<double>& distances);
 
+    /**
+     * Same as above, but only updates the `n`-th bar, e.g. whenever its distance sensor completed a range (see `::demo::DistanceSensors::subscribe`). The other bars keep their bands.
+     *
+     * Throws a `std::out_of_range` if `n` is not less than the number of indicators.
+     */
+    void setIndication(
+        const std::size_t n,
+        const double distance);
+
+    /**
+     * Resends the current bands, even if they are unchanged (e.g. after the LED bars were power-cycled).
+     */
+    void refreshIndication();
+
+    /**
+     * Starts (or restarts) the emission thread. Afterwards, `setIndication()` and `refreshIndication()` only store the requested bands into a single-slot mailbox and return, while the emission thread sends the latest request, with at least `frameInterval` between two frames. Requests that are superseded before the emission thread picked them up are coalesced into a single frame. Moving the indicators moves the emission thread along.
+     *
+     * **Note:** Neither this nor `stopAsynchronous()` may be called while another thread sets indications.
+     *
+     * Throws a `std::domain_error` if the interval is not greater than 0.
+     */
+    void runAsynchronous(
+        const std::chrono::microseconds frameInterval);
+
+    /**
+     * Sends the latest request (unless it was already picked up) and stops the emission thread. Afterwards, each indication is sent within the calling thread again.
+     */
+    void stopAsynchronous();
+
+    bool isRunningAsynchronous() const;
+
+    /**
+     * The number of `setIndication()` and `refreshIndication()` calls. Each request is either emitted, coalesced, or skipped as it didn't change the frame.
+     */
+    std::uint64_t getNumberOfRequestedFrames() const;
+
+    std::uint64_t getNumberOfEmittedFrames() const;
+
+    /**
+     * The number of requests that were superseded by a later one, before the emission thread picked them up. This is always 0, while the indications are sent within the calling thread.
+     */
+    std::uint64_t getNumberOfCoalescedFrames() const;
+
+    ~DistanceIndicators();
+
    protected:
     /**
      * This pin is connected to the DCKI (clock) pins of *all* LED bars.
@@ -74,8 +151,100 @@ namespace demo {
     Pin clockPin_;
 
     /**
-     * These pins are connected to the DI pins on the LED bars.
+     * These pins are connected to the DI pins on the LED bars. They are written together, so that all bars receive their bits on the same clock edge.
+     */
+    PinGroup dataPins_;
+
+    BoardTimings boardTimings_;
+
+    /**
+     * The number of clock edges per instruction, i.e. a 16 bit command word and 12 16 bit greyscale values.
+     */
+    static constexpr std::size_t frameLength_ = 208;
+
+    /**
+     * The band each bar should show. Bands of `numberOfBands_` turn all LEDs of a bar off, until it is set for the first time.
+     */
+    std::vector<unsigned int> bands_;
+
+    /**
+     * The instruction for `bands_`, encoded as the data pins (using BCM GPIO numbering) that are high during each clock edge, and the last instruction sent. `emittedFrame_` starts with pins outside of `dataPins_`, which can't be encoded, so that the first indication is always sent.
+     */
+    std::array<std::uint32_t, frameLength_> frame_;
+    std::array<std::uint32_t, frameLength_> emittedFrame_;
+
+    /**
+     * All data pins, using BCM GPIO numbering (bit `n` represents pin `n`).
+     */
+    std::uint32_t dataPinsMask_;
+
+    std::chrono::microseconds frameInterval_;
+    std::atomic<bool> killEmissionThread_;
+    std::thread emissionThread_;
+
+    /**
+     * The mailbox, holding the latest requested band of each bar and whether a refresh was requested. It is written by any requesting thread and read by the emission thread, after the request was counted in `numberOfRequestedFrames_`.
+     */
+    std::vector<std::atomic<unsigned int>> requestedBands_;
+    std::atomic<bool> isRefreshRequested_;
+
+    /**
+     * Set by each request and cleared by the emission thread before reading the mailbox, so that `pendingRequest_` is only posted once per pickup, no matter how many requests are coalesced.
+     */
+    std::atomic<bool> hasPendingRequest_;
+    ::sem_t pendingRequest_;
+
+    std::atomic<std::uint64_t> numberOfRequestedFrames_;
+    std::atomic<std::uint64_t> numberOfEmittedFrames_;
+    std::atomic<std::uint64_t> numberOfCoalescedFrames_;
+
+    /**
+     * The number of requests that were picked up, only accessed by the emission thread (or while it isn't running).
+     */
+    std::uint64_t numberOfPickedUpRequests_;
+
+    /**
+     * Maps a distance (clamped to [`minimalDistance_`, `maximalDistance_`]) to its band.
+     */
+    unsigned int getBand(
+        const double distance) const;
+
+    /**
+     * Encodes `bands_` into `frame_`. Because all MY9221 are connected to the same clock pin, we need to set all data pins ahead one bit at a time, then clock once. The exact order is:
+     *  1. Send 16 bit command word 0x310 on all pins. This selects 16 bit grayscale code at 1001 Hz.
+     *  2. For every LED in a bar's pattern, send 16x high (or 16x low, depending on whether the LED is on) on the respective pin.
+     * The command word is the same for every instruction and only encoded by the constructor.
+     */
+    void encodeFrame();
+
+    /**
+     * Sends `frame_` to the LED bars, followed by the latch command: 4 high/low toggles on the data pins while keeping the clock at a constant level.
+     *
+     * The clock and data pins are written directly via `::demo::Backend::set` and `::demo::Backend::clear`, without switching their modes on every edge. Data pins are only written when they change, i.e. once per LED instead of 16 times.
+     */
+    void emitIndication();
+
+    /**
+     * Counts a request and wakes the emission thread, unless a request is already pending.
+     */
+    void request();
+
+    /**
+     * Takes the mailbox's bands and emits them, if they changed the frame or a refresh was requested. Returns true if a frame was emitted.
+     */
+    bool pickUpRequest();
+
+    void emitRequestedFrames();
+
+    /**
+     * Stops the emission thread (sending the latest request), but keeps `frameInterval_`, so that the emission can be resumed by the moved-to instance.
+     */
+    void stopEmissionThread();
+
+    /**
+     * Stops the emission thread of `distanceIndicators` and moves its clock pin out, before the move constructor delegates to the main constructor.
      */
-    std::vector<Pin> dataPins_;
+    static Pin releaseClockPin(
+        DistanceIndicators& distanceIndicators);
   };
 }
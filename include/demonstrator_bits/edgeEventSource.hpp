@@ -0,0 +1,79 @@
+#pragma once
+
+// C++ standard library
+#include <chrono>
+#include <string>
+
+namespace demo {
+  /**
+   * A signal edge on a single pin, as reported by an `::demo::EdgeEventSource`.
+   */
+  struct SignalEdge {
+    /**
+     * Indicates a transition from low to high (otherwise, from high to low).
+     */
+    bool isRising;
+
+    /**
+     * The moment the edge occurred. For kernel-captured edges, this is taken in the interrupt handler and therefore independent of the time the edge was read.
+     */
+    std::chrono::steady_clock::time_point timestamp;
+  };
+
+  /**
+   * Provides the signal edges of a single pin, as an alternative to polling its value.
+   *
+   * Edges are queued in the order they occurred, until they are read by `waitForSignalEdge()`. An instance can be assigned to a pin via `::demo::Pin::setEdgeEventSource`, which allows to inject other implementations, e.g. to replay recorded edges.
+   */
+  class EdgeEventSource {
+   public:
+    /**
+     * Blocks until the next queued edge is available or `deadline` is reached. Returns `false` on timeout, in which case `signalEdge` is left untouched.
+     */
+    virtual bool waitForSignalEdge(
+        const std::chrono::steady_clock::time_point deadline,
+        SignalEdge& signalEdge) = 0;
+
+    /**
+     * A file descriptor that becomes readable as soon as an edge is queued, which allows to wait for the edges of several sources within a single `poll()`. Defaults to -1, i.e. the source can only be checked by calling `waitForSignalEdge()` (e.g. with a deadline in the past).
+     */
+    virtual int getFileDescriptor() const;
+
+    virtual ~EdgeEventSource() = default;
+  };
+
+  /**
+   * Captures the edges of a GPIO line through the Linux GPIO character device (e.g. `/dev/gpiochip0`), using a line event request.
+   *
+   * The kernel timestamps each edge (using `CLOCK_MONOTONIC`, i.e. the same clock as `std::chrono::steady_clock`) and queues it, while `waitForSignalEdge()` sleeps in `poll()` instead of busy-waiting.
+   *
+   * On a Raspberry Pi, the line offsets of `/dev/gpiochip0` are equal to the BCM GPIO numbers.
+   * **Note:** The line is requested as an input. It can still be switched to output mode by writing to it via wiringPi or the GPIO registers (e.g. to trigger a HC-SR04), as both bypass the kernel. The edges caused by this are captured as well.
+   */
+  class GpioChipEdgeEventSource : public EdgeEventSource {
+   public:
+    /**
+     * Throws a `std::runtime_error` if the line could not be requested.
+     */
+    explicit GpioChipEdgeEventSource(
+        const std::string& gpioChipPath,
+        const unsigned int lineOffset);
+
+    GpioChipEdgeEventSource(GpioChipEdgeEventSource&) = delete;
+    GpioChipEdgeEventSource& operator=(GpioChipEdgeEventSource&) = delete;
+
+    bool waitForSignalEdge(
+        const std::chrono::steady_clock::time_point deadline,
+        SignalEdge& signalEdge) override;
+
+    int getFileDescriptor() const override;
+
+    ~GpioChipEdgeEventSource();
+
+   protected:
+    /**
+     * The file descriptor of the line request, from which the edge events are read.
+     */
+    int fileDescriptor_;
+  };
+}
@@ -2,12 +2,18 @@
 
 // C++ standard library
 #include <array>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 // Demonstrator
+#include "demonstrator_bits/backend.hpp"
 #include "demonstrator_bits/pin.hpp"
+#include "demonstrator_bits/pinGroup.hpp"
 #include "demonstrator_bits/spi.hpp"
 #include "demonstrator_bits/i2c.hpp"
+#include "demonstrator_bits/i2cBus.hpp"
 #include "demonstrator_bits/uart.hpp"
 
 namespace demo {
@@ -22,6 +28,19 @@ namespace demo {
     Gpio(Gpio&) = delete;
     Gpio operator=(Gpio&) = delete;
 
+    /**
+     * Replaces the hardware backend used by all pins, pin groups, SPI, I2C and UART instances, e.g. by a `::demo::SimulatedBackend`.
+     *
+     * Throws a `std::runtime_error` if any pin is currently allocated, as these would otherwise access different backends.
+     */
+    static void setBackend(
+        std::shared_ptr<Backend> backend);
+
+    /**
+     * Returns the current backend. If none was set, a `::demo::WiringPiBackend` (if `USE_WIRINGPI` is defined and `USE_GPIOMEM` isn't) or a `::demo::GpioMemBackend` is created on first call.
+     */
+    static Backend& getBackend();
+
     /**
      * Asks for ownership of the pin with the specified number.
      *
@@ -32,16 +51,38 @@ namespace demo {
         const unsigned int pinNumber);
 
     /**
-     * Asks for ownership of the SPI pins (for a single slave, excluding pin `GPIO7`, i.e. `CE1`).
-     * **Note:** We assume the WiringPi was set up using `::wiringPiSetupGpio()`.
+     * Groups already owned pins, to write or read all of them at once. The `n`-th pin is represented by bit `n` in the group's bitmasks.
+     *
+     * Throws a `std::domain_error` if `pins` is empty or contains more than 32 pins.
+     * Throws a `std::runtime_error` if any pin is not owned.
+     */
+    static PinGroup allocatePinGroup(
+        std::vector<Pin>&& pins);
+
+    /**
+     * Asks for ownership of the SPI pins, including both chip selects `CE0` and `CE1`.
      *
      * Throws a `std::runtime_error` if any SPI pin is already allocated.
      */
     static Spi allocateSpi();
 
     /**
-     * Asks for ownership of the I2C pins.
-     * **Note:** We assume the WiringPi was set up using `::wiringPiSetupGpio()`.
+     * Asks for ownership of the SPI pins and takes over the already owned `chipSelectPins` as additional chip selects, for slaves 2 and up (see `::demo::Spi`).
+     *
+     * Throws a `std::runtime_error` if any SPI pin is already allocated or any chip select pin is not owned.
+     */
+    static Spi allocateSpi(
+        std::vector<Pin>&& chipSelectPins);
+
+    /**
+     * Asks for ownership of the I2C pins, returning the bus shared by all I2C slaves (see `::demo::I2cBus`).
+     *
+     * Throws a `std::runtime_error` if any I2C pin is already allocated.
+     */
+    static std::shared_ptr<I2cBus> allocateI2cBus();
+
+    /**
+     * Same as `allocateI2cBus()->getDevice(0x40)`, i.e. the PCA9685 of the demonstrator on a bus of its own.
      *
      * Throws a `std::runtime_error` if any I2C pin is already allocated.
      */
@@ -49,7 +90,6 @@ namespace demo {
 
     /**
      * Asks for ownership of the UART pins.
-     * **Note:** We assume the WiringPi was set up using `::wiringPiSetupGpio()`.
      *
      * Throws a `std::runtime_error` if any UART pin is already allocated.
      */
@@ -77,7 +117,7 @@ namespace demo {
      * **Note:** Pins are automatically deallocated if they go out of scope.
      */
     static void deallocate(
-        I2c& i2c);
+        I2cBus& i2cBus);
 
     /**
      * Returns the ownership over the UART pins back to the array.
@@ -93,5 +133,12 @@ namespace demo {
     static int i2cFileDescriptor_;
 
     static std::mutex mutex_;
+
+    static std::shared_ptr<Backend> backend_;
+    /**
+     * Points to the object owned by `backend_`, which allows `getBackend()` to skip the lock once the backend was set.
+     */
+    static std::atomic<Backend*> currentBackend_;
+    static std::mutex backendMutex_;
   };
 }
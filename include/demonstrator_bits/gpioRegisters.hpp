@@ -0,0 +1,103 @@
+#pragma once
+
+// C++ standard library
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace demo {
+  /**
+   * Direct access to the GPIO register block of the BCM2835/BCM2836 (Raspberry Pi A+, B+ and Pi 2), as exposed by `/dev/gpiomem`.
+   *
+   * Instead of going through wiringPi's `pinMode` and `digitalWrite`/`digitalRead` for every single bit, this maps the register block into the process once and afterwards writes the function select (`GPFSEL`), output set (`GPSET`), output clear (`GPCLR`) and level (`GPLEV`) registers directly. Setting or clearing a pin is a single store and switching a pin's function is skipped if it already has the requested one.
+   *
+   * The register block is mapped lazily from `/dev/gpiomem` on first access. Any other file of at least `MAPPED_SIZE` bytes can be mapped instead (using `map()`), which allows to run code paths using this class on any Linux machine. Notice that such a file-backed stand-in only records the writes, i.e. `getLevels()` won't reflect the set or cleared pins, as this is done by the hardware.
+   *
+   * Like `::demo::Gpio`, this class is not instantiable. It does not check pin ownership, which is the responsibility of `::demo::Pin` and `::demo::Spi`.
+   */
+  class GpioRegisters {
+   public:
+    /**
+     * The size of the GPIO register block, in bytes.
+     */
+    static const std::size_t MAPPED_SIZE = 4096;
+
+    /**
+     * Encodes the function select values of a pin (3 bits in `GPFSEL`). Besides input and output, this library only uses the first alternative function, which connects pins 7 to 11 to the SPI controller.
+     */
+    enum class Mode : unsigned int {
+      Input = 0b000,
+      Output = 0b001,
+      Alternate0 = 0b100
+    };
+
+    GpioRegisters() = delete;
+    GpioRegisters(GpioRegisters&) = delete;
+    GpioRegisters operator=(GpioRegisters&) = delete;
+
+    /**
+     * Maps the register block from `path` (usually `/dev/gpiomem`), replacing any previous mapping.
+     *
+     * Throws a `std::runtime_error` if `path` could not be opened or mapped.
+     */
+    static void map(
+        const std::string& path);
+
+    /**
+     * Removes the current mapping. The next access maps `/dev/gpiomem` again.
+     */
+    static void unmap();
+
+    static bool isMapped();
+
+    /**
+     * Sets the function of the specified pin (using BCM GPIO numbering), unless it already has this function.
+     *
+     * Throws a `std::domain_error` if the pin number is greater than 53.
+     */
+    static void setMode(
+        const unsigned int pinNumber,
+        const Mode mode);
+
+    static Mode getMode(
+        const unsigned int pinNumber);
+
+    /**
+     * Sets all output pins within `mask` (bit `n` represents pin `n`) to high, using a single write to `GPSET0`.
+     */
+    static void set(
+        const std::uint32_t mask);
+
+    /**
+     * Sets all output pins within `mask` (bit `n` represents pin `n`) to low, using a single write to `GPCLR0`.
+     */
+    static void clear(
+        const std::uint32_t mask);
+
+    /**
+     * Returns the levels of the pins 0 to 31 (bit `n` represents pin `n`), using a single read from `GPLEV0`.
+     */
+    static std::uint32_t getLevels();
+
+   protected:
+    static std::atomic<volatile std::uint32_t*> registers_;
+
+    /**
+     * Guards the (un)mapping, as well as the read-modify-write of the function select registers.
+     */
+    static std::mutex mutex_;
+
+    /**
+     * Returns the mapped register block, mapping `/dev/gpiomem` if nothing was mapped so far.
+     */
+    static volatile std::uint32_t* getRegisters();
+
+    /**
+     * Same as `map()`, but expects the caller to hold `mutex_`.
+     */
+    static void mapUnsynchronised(
+        const std::string& path);
+  };
+}
@@ -1,16 +1,24 @@
 #pragma once
 
+// C++ standard library
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Demonstrator
+#include "demonstrator_bits/i2cBus.hpp"
+
 namespace demo {
 
   /**
-   * An instance of this class represents an I²C master node, communicating over the gpio pins of a Raspberry Pi.
+   * An instance of this class represents a single slave on the I²C bus of a Raspberry Pi, accessed through a `::demo::I2cBus`.
    *
-   * This class allocates two pins for the duration of its lifetime, and deallocates them automatically on destruction.
+   * Each instance shares the ownership of its bus, which keeps the I2C pins allocated until the last instance is destroyed.
    *
-   * Like pins, instances of this class must be obtained from `Gpio` – for more details, look at the `Pin` class docs.
+   * Instances of this class must be obtained from `::demo::I2cBus::getDevice()`, or `::demo::Gpio::allocateI2c()` for the PCA9685 of the demonstrator.
    */
   class I2c {
-    friend class Gpio;
+    friend class I2cBus;
 
    public:
     I2c& operator=(I2c&) = delete;
@@ -22,26 +30,62 @@ namespace demo {
 
     /**
      * Write a single byte into the designated register of the slave device.
+     *
+     * If the bus runs asynchronously, the write is only submitted (see `::demo::I2cBus`).
      */
     void set(
         const unsigned int register,
         const unsigned int value);
 
+    /**
+     * Write `numberOfValues` bytes into consecutive registers of the slave device, starting at `firstRegister`, within a single bus transaction (see `::demo::Backend::setI2cRegisters`).
+     *
+     * The slave must increment its register pointer after each byte, e.g. the PCA9685 with its auto-increment bit set. If the bus runs asynchronously, the write is only submitted, with the specified priority.
+     *
+     * Throws a `std::invalid_argument` if there are more than `::demo::Backend::MAXIMAL_NUMBER_OF_I2C_VALUES` values.
+     */
+    void set(
+        const unsigned int firstRegister,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues,
+        const I2cBus::Priority priority = I2cBus::Priority::Routine);
+
+    /**
+     * Same as the block write above, but async-signal-safe (see `::demo::Backend::trySetI2cRegisters`), so it may be called from a signal handler. Returns false instead of throwing, if the I2C isn't owned, the write failed or (if the bus runs asynchronously) the queue is full.
+     *
+     * **Note:** The write is not traced, as a signal handler could interrupt its thread while it is already recording another access.
+     */
+    bool trySet(
+        const unsigned int firstRegister,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues,
+        const I2cBus::Priority priority = I2cBus::Priority::Routine) noexcept;
+
     /**
      * Read a single byte from the designated register of the slave device.
+     *
+     * If the bus runs asynchronously, this waits until all previously submitted writes were executed.
      */
     unsigned int get(
         const unsigned int register);
 
+    /**
+     * Blocks until all writes submitted to the bus (by any device) were executed. Returns immediately if the bus doesn't run asynchronously.
+     */
+    void flush();
+
     virtual ~I2c();
 
    protected:
-    I2c();
+    I2c(
+        std::shared_ptr<I2cBus> bus,
+        const unsigned int address);
 
+    std::shared_ptr<I2cBus> bus_;
     /**
-     * The file descriptor provided by the [wiringPi library](http://wiringpi.com/reference/i2c-library/).
+     * The 7-bit slave address.
      */
-    int fileDescriptor_;
+    unsigned int address_;
 
     bool ownsI2c_;
   };
@@ -0,0 +1,202 @@
+#pragma once
+
+// C++ standard library
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// Unix library
+#include <semaphore.h>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+
+namespace demo {
+  class I2c;
+
+  /**
+   * An instance of this class represents the I²C bus of a Raspberry Pi, shared by all slaves attached to it. Each slave is accessed through its own `::demo::I2c` device handle, obtained via `getDevice()`. All device handles use the same backend handle (i.e. file descriptor) of the bus.
+   *
+   * By default, all accesses are executed within the calling thread. After `runAsynchronous()`, writes are instead submitted to a lock-free queue and executed by a dedicated bus thread, so that control loops don't wait for the (comparatively slow) bus. Writes with `Priority::Stop` are executed before all pending `Priority::Routine` writes, while writes of the same priority keep their order. Routine writes to a slave that were submitted before one of its stop writes are discarded, so that they can't undo it afterwards. Reads still wait for their result, and thereby for all previously submitted writes.
+   *
+   * This class allocates the two I2C pins for the duration of its lifetime. As the bus is shared by its device handles, it must be obtained from `::demo::Gpio::allocateI2cBus()` and is deallocated after the last device handle (and the returned pointer) went out of scope.
+   */
+  class I2cBus : public std::enable_shared_from_this<I2cBus> {
+    friend class Gpio;
+    friend class I2c;
+
+   public:
+    enum class Priority : unsigned int {
+      Routine = 0,
+      Stop = 1
+    };
+
+    /**
+     * The number of writes per priority, which can be pending at once while running asynchronously. Submitting another write waits until the bus thread executed one.
+     */
+    static const std::size_t QUEUE_CAPACITY = 64;
+
+    I2cBus(I2cBus&) = delete;
+    I2cBus& operator=(I2cBus&) = delete;
+
+    /**
+     * Returns a handle to the slave with the specified 7-bit address.
+     *
+     * Throws a `std::domain_error` if the address is not within [0x03, 0x77] (the others are reserved).
+     */
+    I2c getDevice(
+        const unsigned int address);
+
+    /**
+     * Starts the bus thread, executing all writes submitted from now on.
+     *
+     * **Note:** Neither this nor `stopAsynchronous()` may be called while another thread accesses the bus.
+     */
+    void runAsynchronous();
+
+    /**
+     * Executes all pending writes and stops the bus thread.
+     */
+    void stopAsynchronous();
+
+    bool isRunningAsynchronous() const;
+
+    /**
+     * Blocks until all previously submitted writes were executed. Returns immediately if the bus isn't running asynchronously.
+     */
+    void flush();
+
+    /**
+     * The number of asynchronously executed writes that failed. As the submitting thread already returned, these can't be reported by an exception.
+     */
+    std::uint64_t getNumberOfFailedWrites() const;
+
+    ~I2cBus();
+
+   protected:
+    struct Transaction {
+      enum class Type : unsigned int {
+        Write,
+        Read,
+        /**
+         * Only signals the completion, after all previously submitted transactions were executed.
+         */
+        Flush
+      };
+
+      Type type;
+      Priority priority;
+      /**
+       * Numbers the writes in the order they were submitted (starting at 1), so that the bus thread can tell which routine writes a stop write supersedes.
+       */
+      std::uint64_t number;
+      unsigned int address;
+      unsigned int firstRegisterNumber;
+      std::array<std::uint8_t, Backend::MAXIMAL_NUMBER_OF_I2C_VALUES> values;
+      std::size_t numberOfValues;
+
+      /**
+       * Posted after a read or flush was executed, with its outcome stored in `readValue` and `hasFailed`. Unused by writes.
+       */
+      ::sem_t* completion;
+      unsigned int* readValue;
+      bool* hasFailed;
+    };
+
+    /**
+     * A bounded, lock-free multi-producer queue (see Dmitry Vyukov's bounded MPMC queue), drained by the single bus thread. Its producers neither allocate memory nor take locks, so that stop commands can be submitted from signal handlers.
+     */
+    class TransactionQueue {
+     public:
+      TransactionQueue();
+
+      /**
+       * Returns false if the queue is full.
+       */
+      bool push(
+          const Transaction& transaction) noexcept;
+
+      /**
+       * Returns false if the queue is empty, or the oldest transaction is still being pushed. Must only be called by the bus thread.
+       */
+      bool pop(
+          Transaction& transaction);
+
+     protected:
+      struct Cell {
+        /**
+         * Equals the cell's position if it is free to be pushed to, and the position + 1 if it holds a transaction.
+         */
+        std::atomic<std::size_t> sequence;
+        Transaction transaction;
+      };
+
+      std::array<Cell, QUEUE_CAPACITY> cells_;
+      // The producers' and consumer's positions are separated by the cells, so that they don't share a cache line.
+      std::atomic<std::size_t> pushPosition_;
+      std::size_t popPosition_;
+    };
+
+    /**
+     * The handle provided by `::demo::Backend::openI2cBus`.
+     */
+    int handle_;
+
+    bool ownsI2cBus_;
+
+    /**
+     * One queue per priority, indexed by `Priority`.
+     */
+    std::array<TransactionQueue, 2> queues_;
+    /**
+     * Counts the submitted, but not yet executed transactions. Unlike a condition variable, `::sem_post` is async-signal-safe.
+     */
+    ::sem_t numberOfPendingTransactions_;
+
+    std::atomic<bool> isRunningAsynchronous_;
+    std::atomic<bool> killBusThread_;
+    std::thread busThread_;
+
+    std::atomic<std::uint64_t> numberOfFailedWrites_;
+
+    std::atomic<std::uint64_t> numberOfSubmittedWrites_;
+    /**
+     * The number of the last executed stop write, per slave address. Only accessed by the bus thread.
+     */
+    std::array<std::uint64_t, 0x78> stopWriteNumbers_;
+
+    I2cBus();
+
+    void write(
+        const unsigned int address,
+        const unsigned int firstRegisterNumber,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues,
+        const Priority priority);
+
+    bool tryWrite(
+        const unsigned int address,
+        const unsigned int firstRegisterNumber,
+        const std::uint8_t* values,
+        const std::size_t numberOfValues,
+        const Priority priority) noexcept;
+
+    unsigned int read(
+        const unsigned int address,
+        const unsigned int registerNumber);
+
+    /**
+     * Submits a read or flush and waits for its completion.
+     */
+    void submitAndWait(
+        Transaction& transaction);
+
+    void execute(
+        const Transaction& transaction);
+
+    void drain();
+  };
+}
@@ -2,6 +2,7 @@
 
 // C++ standard library
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <thread>
 
@@ -19,6 +20,8 @@ namespace demo {
    *
    * Each actuator can be instructed to approach a certain extension, and queried for its current extension. These features are implemented in the classes `ServoControllers` and `ExtensionSensors` and combined in this one.
    *
+   * Each actuator is driven by its own PID controller, which maps the remaining extension error to a speed, so that the actuators slow down while approaching their extension instead of overshooting it at full speed. The speed commands follow a trapezoidal velocity profile: They change by at most the maximal acceleration per second (the ramps) and are limited to the maximal speed passed to `setExtensions()` (the plateau), while the proportional term lets them fall with the remaining error. Errors within the acceptable extension deviation are a deadband, in which the actuator is held and its integral term is frozen. Speeds are quantized to the 12-bit duty cycles of the PCA9685, and the integral term only accumulates while the speed isn't limited (beyond that quantization), so that it doesn't wind up during long ramps or while the actuator is blocked.
+   *
    * [1]: http://INSERT-PRODUCT-PAGE-HERE
    */
   class LinearActuators {
@@ -59,22 +62,81 @@ namespace demo {
 
     bool waitTillExtensionIsReached(
         const std::chrono::microseconds timeout);
-    
+
+    /**
+     * Takes effect with the next `setExtensions()` call.
+     */
     void setAcceptableExtensionDeviation(
         const double acceptableExtensionDeviation);
     double getMaximalExtensionDeviation() const;
 
+    /**
+     * Sets the gains of each actuator's PID controller, mapping the extension error (in metres) to a speed (as a fraction of the actuator's full speed). With the default proportional gain of 150, an actuator runs at full speed until it is about 7 millimetres away from its extension. The integral and derivative gains default to 5, respectively 0. The derivative term is taken from the measured extensions, so that changing the extensions doesn't cause a kick.
+     *
+     * Takes effect with the next `setExtensions()` call.
+     *
+     * Throws a `std::domain_error` if any gain is negative or not finite.
+     */
+    void setControllerGains(
+        const double proportionalGain,
+        const double integralGain,
+        const double derivativeGain);
+    double getProportionalGain() const;
+    double getIntegralGain() const;
+    double getDerivativeGain() const;
+
+    /**
+     * Sets the interval between two iterations of the control loop, i.e. between measuring the extensions and updating the speeds (10 milliseconds by default). The interval is measured between absolute deadlines, while the controllers use the actual time between two measurements.
+     *
+     * Takes effect with the next `setExtensions()` call.
+     *
+     * Throws a `std::domain_error` if the interval is not greater than 0.
+     */
+    void setControlInterval(
+        const std::chrono::microseconds controlInterval);
+    std::chrono::microseconds getControlInterval() const;
+
+    /**
+     * Sets the maximal change of each speed per second (as a fraction of the actuator's full speed), i.e. the slope of the ramps of the velocity profile. Defaults to 10, ramping up to full speed within 100 milliseconds. An infinite acceleration disables the ramps.
+     *
+     * Takes effect with the next `setExtensions()` call.
+     *
+     * Throws a `std::domain_error` if the acceleration is not greater than 0 (or NaN).
+     */
+    void setMaximalAcceleration(
+        const double maximalAcceleration);
+    double getMaximalAcceleration() const;
+
    protected:
+    /**
+     * A copy of the control loop's settings, taken by `setExtensions()`, so that the setters don't race with a running control loop.
+     */
+    struct ControlParameters {
+      double acceptableExtensionDeviation;
+      double proportionalGain;
+      double integralGain;
+      double derivativeGain;
+      std::chrono::microseconds controlInterval;
+      double maximalAcceleration;
+    };
+
     ServoControllers servoControllers_;
     ExtensionSensors extensionSensors_;
 
     double acceptableExtensionDeviation_;
 
+    double proportionalGain_;
+    double integralGain_;
+    double derivativeGain_;
+    std::chrono::microseconds controlInterval_;
+    double maximalAcceleration_;
+
     std::atomic<bool> killReachExtensionThread_;
     std::thread reachExtensionThread_;
 
     void reachExtension(
         const arma::Row<double>& extensions,
-        const arma::Row<double>& maximalSpeeds);
+        const arma::Row<double>& maximalSpeeds,
+        const ControlParameters& parameters);
   };
 }
@@ -2,6 +2,11 @@
 
 // C++ standard library
 #include <chrono>
+#include <memory>
+#include <string>
+
+// Demonstrator
+#include "demonstrator_bits/edgeEventSource.hpp"
 
 /**
  * Instances of this class represent a single GPIO pin on the Raspberry Pi.
@@ -17,6 +22,16 @@ namespace demo {
      */
     friend class Gpio;
 
+    /**
+     * Groups of pins access the pin number directly, in order to write or read all of their pins at once.
+     */
+    friend class PinGroup;
+
+    /**
+     * SPI instances use additional pins as chip selects.
+     */
+    friend class Spi;
+
    public:
     /**
      * Encodes the digital signals you can put on a pin.
@@ -62,6 +77,43 @@ namespace demo {
     std::chrono::microseconds waitForSignalEdge(
         const std::chrono::microseconds timeout);
 
+    /**
+     * Switch this pin to `input` mode, then wait for the next signal edge that occurred at or after `since`, and store it in `signalEdge`. Returns `false` if no such edge occurred within `timeout` microseconds after the call.
+     *
+     * If an edge event source is set, the edge's timestamp is taken by the source (e.g. by the kernel) and edges that occurred before this call are still captured, as long as they are not older than `since`. This allows to measure pulse widths independent of the scheduling of the calling thread, by capturing the falling edge since the rising edge's timestamp.
+     * Otherwise, this pin is polled, `since` is ignored and the timestamp is taken when the changed signal is read.
+     */
+    bool captureSignalEdge(
+        const std::chrono::microseconds timeout,
+        const std::chrono::steady_clock::time_point since,
+        SignalEdge& signalEdge);
+
+    /**
+     * Let `waitForSignalEdge()` and `captureSignalEdge()` wait for the edges reported by `edgeEventSource`, instead of polling this pin. Passing a `nullptr` switches back to polling.
+     */
+    void setEdgeEventSource(
+        std::unique_ptr<EdgeEventSource> edgeEventSource);
+
+    /**
+     * Same as `setEdgeEventSource()`, using a `::demo::GpioChipEdgeEventSource` for this pin's line on the specified GPIO character device (usually `/dev/gpiochip0`).
+     *
+     * Throws a `std::runtime_error` if the line could not be requested.
+     */
+    void useGpioChipEdgeEvents(
+        const std::string& gpioChipPath);
+
+    /**
+     * The pin number, using BCM GPIO numbering, e.g. to access several pins at once through `::demo::Backend`.
+     *
+     * Throws a `std::runtime_error` if this object doesn't own its pin.
+     */
+    unsigned int getPinNumber() const;
+
+    /**
+     * The edge event source set via `setEdgeEventSource()`, or `nullptr` if this pin is polled.
+     */
+    EdgeEventSource* getEdgeEventSource();
+
     /**
      * If this object currently owns its pin, pass that ownership back to the gpio array.
      */
@@ -88,5 +140,15 @@ namespace demo {
      * Indicates that this object still owns its pin (ownership has not been transferred).
      */
     bool ownsPin_;
+
+    /**
+     * If set, signal edges are taken from this source instead of polling the pin.
+     */
+    std::unique_ptr<EdgeEventSource> edgeEventSource_;
+
+    /**
+     * Switch this pin to `input` mode and read the current value, without any ownership check or debugging message.
+     */
+    Digital readSignal();
   };
 }
@@ -0,0 +1,87 @@
+#pragma once
+
+// C++ standard library
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Demonstrator
+#include "demonstrator_bits/pin.hpp"
+
+namespace demo {
+  /**
+   * A set of pins that are written and read together, such as the parallel data lines of `::demo::DistanceIndicators` or the direction pins of `::demo::ServoControllers`.
+   *
+   * Bit `n` of the bitmasks passed to `write()` and returned by `read()` represents the `n`-th pin of the group (in the order they were passed to `::demo::Gpio::allocatePinGroup`), not the BCM pin number.
+   *
+   * Writing the group is a single `::demo::Backend::set` followed by a single `::demo::Backend::clear`, and reading the group is a single `::demo::Backend::getLevels`. If the GPIO registers are accessed directly (see `::demo::GpioMemBackend`), these are single writes to `GPSET0` and `GPCLR0`, respectively a single read from `GPLEV0`. Therefore, all pins that are set high change on the same edge, as well as all pins that are set low. The `::demo::WiringPiBackend` writes the pins one after another.
+   *
+   * The direction of the pins is only changed when switching between `write()` and `read()`, instead of on every access.
+   *
+   * Like pins, instances of this class must be obtained from `::demo::Gpio` – for more details, look at the `::demo::Pin` class docs. The group takes over the ownership of its pins and passes it back to the GPIO array on destruction.
+   */
+  class PinGroup {
+    friend class Gpio;
+
+   public:
+    PinGroup& operator=(PinGroup&) = delete;
+    PinGroup(PinGroup&) = delete;
+
+    PinGroup(PinGroup&&);
+
+    PinGroup& operator=(PinGroup&&);
+
+    /**
+     * Switches all pins to `output` mode (unless already done) and sets the `n`-th pin to bit `n` of `bitmask`. Bits without an associated pin are ignored.
+     */
+    void write(
+        const std::uint32_t bitmask);
+
+    /**
+     * Switches all pins to `input` mode (unless already done) and returns their current values, with bit `n` representing the `n`-th pin.
+     */
+    std::uint32_t read();
+
+    std::size_t getNumberOfPins() const;
+
+    /**
+     * All pins of this group, using BCM GPIO numbering (bit `n` represents pin `n`), e.g. to encode bitmasks ahead of writing them through `::demo::Backend`.
+     *
+     * Throws a `std::runtime_error` if this object doesn't own its pins.
+     */
+    std::uint32_t getMask() const;
+
+    /**
+     * The BCM GPIO number of the `n`-th pin of this group.
+     *
+     * Throws a `std::out_of_range` if `n` is not less than the number of pins.
+     * Throws a `std::runtime_error` if this object doesn't own its pins.
+     */
+    unsigned int getPinNumber(
+        const std::size_t n) const;
+
+    virtual ~PinGroup() = default;
+
+   protected:
+    /**
+     * The constructor is private, as only Gpio (which is a friend) may instantiate this class.
+     */
+    PinGroup(
+        std::vector<Pin>&& pins);
+
+    std::vector<Pin> pins_;
+
+    /**
+     * All pins of this group, using BCM GPIO numbering (bit `n` represents pin `n`).
+     */
+    std::uint32_t pinsMask_;
+
+    /**
+     * Indicates that all pins are known to be in `output` mode, respectively `input` mode.
+     */
+    bool isOutput_;
+    bool isInput_;
+
+    bool ownsPins_;
+  };
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+// C++ standard library
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <ratio>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Armadillo
+#include <armadillo>
+
+namespace demo {
+  /**
+   * A streaming filter, updated with each (clamped) sample of `::demo::Sensors` and replacing the median over several samples per measurement (see `::demo::Sensors::setSampleFilter`).
+   *
+   * Usually implemented by `::demo::SampleFilterPipeline`, which composes the filter from policies at compile time, so that only a single virtual call per sample remains.
+   */
+  class SampleFilter {
+   public:
+    const std::size_t numberOfSensors_;
+
+    explicit SampleFilter(
+        const std::size_t numberOfSensors)
+        : numberOfSensors_(numberOfSensors) {
+    }
+
+    SampleFilter(SampleFilter&) = delete;
+    SampleFilter& operator=(SampleFilter&) = delete;
+
+    /**
+     * Updates the filter with a new sample (one element per sensor) and replaces it with the filtered values. Must not allocate memory.
+     */
+    virtual void update(
+        arma::Row<double>& samples) = 0;
+
+    /**
+     * Forgets all previous samples, so that the next sample passes unfiltered.
+     */
+    virtual void reset() = 0;
+
+    virtual ~SampleFilter() = default;
+  };
+
+  /**
+   * Sample filter policies for `::demo::SampleFilterPipeline`.
+   *
+   * A policy is constructed with the number of sensors, and provides `double update(const std::size_t n, const double sample)`, which updates the state of the `n`-th sensor and returns its filtered value, as well as `void reset()`. All state is allocated by the constructor. Parameters are passed as `std::ratio`, so that they are fixed at compile time.
+   */
+  namespace sampleFilters {
+    /**
+     * Limits each sample to `MaximalDeviation` (in measured units) around the previous filtered value, so that single outliers (such as an echo missed by a distance sensor) move the result by at most `MaximalDeviation`. Should be the first policy of a pipeline.
+     */
+    template <typename MaximalDeviation>
+    class OutlierClipping {
+     public:
+      explicit OutlierClipping(
+          const std::size_t numberOfSensors)
+          : previousValues_(numberOfSensors, 0.0),
+            hasPreviousValue_(false) {
+      }
+
+      double update(
+          const std::size_t n,
+          const double sample) {
+        if (!hasPreviousValue_) {
+          previousValues_[n] = sample;
+          // All sensors are updated in order, so the last one completes the first sample.
+          hasPreviousValue_ = (n + 1 == previousValues_.size());
+          return sample;
+        }
+
+        constexpr double maximalDeviation = static_cast<double>(MaximalDeviation::num) / static_cast<double>(MaximalDeviation::den);
+        previousValues_[n] = std::min(std::max(sample, previousValues_[n] - maximalDeviation), previousValues_[n] + maximalDeviation);
+        return previousValues_[n];
+      }
+
+      void reset() {
+        hasPreviousValue_ = false;
+      }
+
+     protected:
+      std::vector<double> previousValues_;
+      bool hasPreviousValue_;
+    };
+
+    /**
+     * The median of the last `numberOfSamples` samples, kept in a ring buffer per sensor. The median of an even number of samples is the mean of both middle samples. Until `numberOfSamples` samples were seen, the median of all previous samples is returned.
+     */
+    template <std::size_t numberOfSamples>
+    class RunningMedian {
+      static_assert(numberOfSamples > 0, "RunningMedian: The number of samples must be greater than 0.");
+
+     public:
+      explicit RunningMedian(
+          const std::size_t numberOfSensors)
+          : samples_(numberOfSensors),
+            numberOfSeenSamples_(numberOfSensors, 0) {
+      }
+
+      double update(
+          const std::size_t n,
+          const double sample) {
+        samples_[n][numberOfSeenSamples_[n] % numberOfSamples] = sample;
+        ++numberOfSeenSamples_[n];
+
+        const std::size_t numberOfValidSamples = std::min(numberOfSeenSamples_[n], numberOfSamples);
+        std::array<double, numberOfSamples> sortedSamples = samples_[n];
+        const std::size_t middleIndex = numberOfValidSamples / 2;
+        std::nth_element(sortedSamples.begin(), sortedSamples.begin() + static_cast<std::ptrdiff_t>(middleIndex), sortedSamples.begin() + static_cast<std::ptrdiff_t>(numberOfValidSamples));
+        if (numberOfValidSamples % 2 == 0) {
+          return (sortedSamples[middleIndex] + *std::max_element(sortedSamples.begin(), sortedSamples.begin() + static_cast<std::ptrdiff_t>(middleIndex))) / 2.0;
+        }
+        return sortedSamples[middleIndex];
+      }
+
+      void reset() {
+        std::fill(numberOfSeenSamples_.begin(), numberOfSeenSamples_.end(), 0);
+      }
+
+     protected:
+      std::vector<std::array<double, numberOfSamples>> samples_;
+      std::vector<std::size_t> numberOfSeenSamples_;
+    };
+
+    /**
+     * An exponential moving average, i.e. `value = Smoothing * sample + (1 - Smoothing) * value`. Smaller factors smooth more, but lag further behind.
+     */
+    template <typename Smoothing>
+    class ExponentialMovingAverage {
+      static_assert(Smoothing::num > 0 && Smoothing::num <= Smoothing::den, "ExponentialMovingAverage: The smoothing factor must be within (0, 1].");
+
+     public:
+      explicit ExponentialMovingAverage(
+          const std::size_t numberOfSensors)
+          : values_(numberOfSensors, 0.0),
+            hasValue_(false) {
+      }
+
+      double update(
+          const std::size_t n,
+          const double sample) {
+        if (!hasValue_) {
+          values_[n] = sample;
+          hasValue_ = (n + 1 == values_.size());
+          return sample;
+        }
+
+        constexpr double smoothing = static_cast<double>(Smoothing::num) / static_cast<double>(Smoothing::den);
+        values_[n] += smoothing * (sample - values_[n]);
+        return values_[n];
+      }
+
+      void reset() {
+        hasValue_ = false;
+      }
+
+     protected:
+      std::vector<double> values_;
+      bool hasValue_;
+    };
+
+    /**
+     * An alpha-beta filter, tracking the value and its rate of change per sample. Unlike the moving average, it doesn't lag behind values that change at a constant rate (such as an extending actuator), at the cost of overshooting after abrupt changes.
+     *
+     * Each sample is compared against the prediction `value + rate`. The value is then corrected by `Alpha` times the residual, and the rate by `Beta` times the residual.
+     */
+    template <typename Alpha, typename Beta>
+    class AlphaBeta {
+      static_assert(Alpha::num > 0 && Alpha::num <= Alpha::den, "AlphaBeta: Alpha must be within (0, 1].");
+      static_assert(Beta::num >= 0 && Beta::num * Alpha::den < 4 * Beta::den * Alpha::den - 2 * Alpha::num * Beta::den, "AlphaBeta: Beta must be within [0, 4 - 2 * Alpha) to be stable.");
+
+     public:
+      explicit AlphaBeta(
+          const std::size_t numberOfSensors)
+          : values_(numberOfSensors, 0.0),
+            rates_(numberOfSensors, 0.0),
+            hasValue_(false) {
+      }
+
+      double update(
+          const std::size_t n,
+          const double sample) {
+        if (!hasValue_) {
+          values_[n] = sample;
+          rates_[n] = 0.0;
+          hasValue_ = (n + 1 == values_.size());
+          return sample;
+        }
+
+        constexpr double alpha = static_cast<double>(Alpha::num) / static_cast<double>(Alpha::den);
+        constexpr double beta = static_cast<double>(Beta::num) / static_cast<double>(Beta::den);
+        const double residual = sample - (values_[n] + rates_[n]);
+        values_[n] += rates_[n] + alpha * residual;
+        rates_[n] += beta * residual;
+        return values_[n];
+      }
+
+      void reset() {
+        hasValue_ = false;
+      }
+
+     protected:
+      std::vector<double> values_;
+      std::vector<double> rates_;
+      bool hasValue_;
+    };
+  }
+
+  /**
+   * A sample filter composed of the given policies (see `::demo::sampleFilters`), which are applied in order, e.g. `SampleFilterPipeline<sampleFilters::OutlierClipping<std::ratio<1, 100>>, sampleFilters::RunningMedian<5>>`.
+   *
+   * The policies are resolved at compile time, so each sample and sensor passes through all of them without any further virtual calls or allocations.
+   */
+  template <typename... Policies>
+  class SampleFilterPipeline : public SampleFilter {
+    static_assert(sizeof...(Policies) > 0, "SampleFilterPipeline: At least one policy must be given.");
+
+   public:
+    explicit SampleFilterPipeline(
+        const std::size_t numberOfSensors)
+        : SampleFilter(numberOfSensors),
+          policies_(Policies(numberOfSensors)...) {
+    }
+
+    void update(
+        arma::Row<double>& samples) override {
+      for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+        samples(n) = update(n, samples(n), std::index_sequence_for<Policies...>());
+      }
+    }
+
+    void reset() override {
+      reset(std::index_sequence_for<Policies...>());
+    }
+
+    /**
+     * The `n`-th policy, e.g. to inspect its state.
+     */
+    template <std::size_t n>
+    const typename std::tuple_element<n, std::tuple<Policies...>>::type& getPolicy() const {
+      return std::get<n>(policies_);
+    }
+
+   protected:
+    std::tuple<Policies...> policies_;
+
+    template <std::size_t... policyIndices>
+    double update(
+        const std::size_t n,
+        double value,
+        std::index_sequence<policyIndices...>) {
+      // The evaluation order of an initialiser list is guaranteed to be left-to-right.
+      static_cast<void>(std::initializer_list<int>{(value = std::get<policyIndices>(policies_).update(n, value), 0)...});
+      return value;
+    }
+
+    template <std::size_t... policyIndices>
+    void reset(
+        std::index_sequence<policyIndices...>) {
+      static_cast<void>(std::initializer_list<int>{(std::get<policyIndices>(policies_).reset(), 0)...});
+    }
+  };
+}
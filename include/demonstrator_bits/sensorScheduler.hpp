@@ -0,0 +1,161 @@
+#pragma once
+
+// C++ standard library
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Armadillo
+#include <armadillo>
+
+// Demonstrator
+#include "demonstrator_bits/sensors.hpp"
+
+namespace demo {
+  /**
+   * Measures several `::demo::Sensors` at individual rates (e.g. the extension sensors every 2 milliseconds and the distance sensors every 50 milliseconds) within a single scheduling thread, instead of one thread or busy loop per sensor.
+   *
+   * Each registered sensor gets a slot, which holds its latest measurement. The scheduling thread always measures the slot with the earliest deadline (ties are broken by the order of registration) via `::demo::Sensors::measureInto`, publishes the result and advances the slot's deadline by its interval. Deadlines are absolute, so that the intervals don't drift by the measurement time. If a measurement ends after the slot's next deadline, the missed deadlines are skipped and counted as overruns of that slot.
+   *
+   * The scheduling is non-preemptive: A slow measurement (such as the echoes of `::demo::DistanceSensors`) delays all other slots that become due meanwhile, which shows as their lateness. Sensors that sample in a background thread anyway (such as `::demo::ExtensionSensors::runAsynchronous` or `::demo::AttitudeSensors`) only copy their latest sample and are therefore cheap to schedule at high rates.
+   *
+   * Consumers read the latest measurement of a slot via `getLatestMeasurement()`, which neither blocks nor takes a lock, but retries if the scheduling thread overwrote the measurement while it was being copied.
+   *
+   * **Note:** While running, the registered sensors must neither be measured, reconfigured, moved nor destroyed by any other thread.
+   */
+  class SensorScheduler {
+   public:
+    SensorScheduler();
+
+    SensorScheduler(SensorScheduler&) = delete;
+    SensorScheduler& operator=(SensorScheduler&) = delete;
+
+    /**
+     * Registers `sensors` to be measured every `measurementInterval` and returns the number of its slot. The first measurement is due as soon as the scheduler runs.
+     *
+     * Throws a `std::domain_error` if the interval is not greater than 0.
+     * Throws a `std::logic_error` if the scheduler is already running.
+     */
+    std::size_t addSensors(
+        Sensors& sensors,
+        const std::chrono::microseconds measurementInterval);
+
+    std::size_t getNumberOfSlots() const;
+
+    std::chrono::microseconds getMeasurementInterval(
+        const std::size_t slot) const;
+
+    /**
+     * Starts the scheduling thread. Restarting resets all deadlines, so that every slot is measured right away, but keeps the latest measurements and counters.
+     */
+    void runAsynchronous();
+
+    /**
+     * Stops the scheduling thread after its current measurement (if any). This may take up to the longest measurement interval, if the thread is sleeping.
+     */
+    void stopAsynchronous();
+
+    bool isRunningAsynchronous() const;
+
+    /**
+     * Copies the latest measurement of the `slot`-th sensors into `measurements` (which must already hold one element per sensor), together with the time of its latest sample (see `::demo::Sensors::getLatestSampleTime`). Returns false and leaves both unchanged if the slot wasn't measured yet.
+     *
+     * Doesn't allocate any memory and may be called from any thread, while the scheduler is running.
+     *
+     * Throws a `std::out_of_range` if there is no such slot.
+     * Throws a `std::invalid_argument` if `measurements` doesn't hold one element per sensor.
+     */
+    bool getLatestMeasurement(
+        const std::size_t slot,
+        arma::Row<double>& measurements,
+        std::chrono::steady_clock::time_point& measurementTime) const;
+
+    /**
+     * Returns the latest measurement of the `slot`-th sensors.
+     *
+     * Throws a `std::out_of_range` if there is no such slot.
+     * Throws a `std::logic_error` if the slot wasn't measured yet.
+     */
+    arma::Row<double> getLatestMeasurement(
+        const std::size_t slot) const;
+
+    /**
+     * The number of measurements published by the `slot`-th slot, i.e. excluding failed ones.
+     */
+    std::uint64_t getNumberOfMeasurements(
+        const std::size_t slot) const;
+
+    /**
+     * The number of deadlines the `slot`-th slot missed, because a measurement (of this or another slot) took too long.
+     */
+    std::uint64_t getNumberOfOverruns(
+        const std::size_t slot) const;
+
+    /**
+     * The number of measurements of the `slot`-th slot that threw a `std::runtime_error` (e.g. a failed transfer). These are dropped, while the scheduling continues.
+     */
+    std::uint64_t getNumberOfFailedMeasurements(
+        const std::size_t slot) const;
+
+    /**
+     * The maximal delay between a deadline of the `slot`-th slot and the start of its measurement, including the wake-up latency of the scheduling thread (see `::demo::timing::getWakeUpLatency`).
+     */
+    std::chrono::nanoseconds getMaximalLateness(
+        const std::size_t slot) const;
+
+    /**
+     * Resets the overrun and failure counters, as well as the maximal lateness of all slots, e.g. after the start-up.
+     */
+    void resetStatistics();
+
+    ~SensorScheduler();
+
+   protected:
+    struct Slot {
+      Sensors& sensors;
+      const std::chrono::steady_clock::duration measurementInterval;
+      /**
+       * Only accessed by the scheduling thread (or while it isn't running).
+       */
+      std::chrono::steady_clock::time_point deadline;
+      arma::Row<double> measurement;
+
+      /**
+       * A seqlock-protected double buffer of the latest measurements (see `::demo::ExtensionSensors`): Measurement `n` is written into `measurements[n % 2]`, after `measurementBegun` was set to `n` and before `measurementCompleted` is set to `n`. Readers retry if `measurementBegun` advanced by two or more while copying.
+       */
+      std::array<std::unique_ptr<std::atomic<double>[]>, 2> measurements;
+      std::array<std::atomic<std::chrono::steady_clock::rep>, 2> measurementTimes;
+      std::atomic<std::uint64_t> measurementBegun;
+      std::atomic<std::uint64_t> measurementCompleted;
+
+      std::atomic<std::uint64_t> numberOfOverruns;
+      std::atomic<std::uint64_t> numberOfFailedMeasurements;
+      std::atomic<std::chrono::nanoseconds::rep> maximalLateness;
+
+      explicit Slot(
+          Sensors& sensors,
+          const std::chrono::steady_clock::duration measurementInterval);
+    };
+
+    /**
+     * Slots contain atomics, which can't be moved when the vector grows.
+     */
+    std::vector<std::unique_ptr<Slot>> slots_;
+
+    std::atomic<bool> killSchedulingThread_;
+    std::thread schedulingThread_;
+
+    void schedule();
+
+    void measure(
+        Slot& slot);
+
+    const Slot& getSlot(
+        const std::size_t slot) const;
+  };
+}
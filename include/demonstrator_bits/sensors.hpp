@@ -1,11 +1,18 @@
 #pragma once
 
 // C++ standard library
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 // Armadillo
 #include <armadillo>
 
+// Demonstrator
+#include "demonstrator_bits/sampleFilters.hpp"
+
 namespace demo {
   class Sensors {
    public:
@@ -29,18 +36,161 @@ namespace demo {
 
     arma::Row<double> measure();
 
+    /**
+     * Same as `measure()`, but writes the measured values into `measuredValues`, which must already hold `numberOfSensors_` elements.
+     *
+     * All intermediate results are kept in storage preallocated by `setNumberOfSamplesPerMeasurment` and `setMeasurementCorrections`, so a measurement doesn't allocate any memory by itself (as long as the sensors override `measureImplementationInto`). This makes it suitable for control loops, which would otherwise spend a notable part of each cycle in the allocator.
+     *
+     * Throws a `std::invalid_argument` if `measuredValues` doesn't hold `numberOfSensors_` elements.
+     */
+    void measureInto(
+        arma::Row<double>& measuredValues);
+
     void setMeasurementCorrections(
         const arma::Mat<double>& measurementCorrections);
     arma::Mat<double> getMeasurementCorrections() const;
 
+    /**
+     * Takes exactly `numberOfSamplesPerMeasuement` samples per measurement, which also ends the adaptive sampling (see `setAdaptiveNumberOfSamplesPerMeasurement`).
+     */
     void setNumberOfSamplesPerMeasurment(
         const std::size_t numberOfSamplesPerMeasuement);
+    /**
+     * Returns the maximal number of samples per measurement, if sampling adaptively.
+     */
     std::size_t getNumberOfSamplesPerMeasuement() const;
 
+    /**
+     * Adapts the number of samples to the current noise: After `minimalNumberOfSamples` (but at least 2) samples, a measurement stops as soon as the estimated standard error of each sensor's mean (i.e. the standard deviation of its samples divided by the square root of their number) is at most `standardErrorTolerance`, or after `maximalNumberOfSamples` samples. The tolerance is given in measured units, before the correction. The median of all samples is taken as before, whose standard error is about 25% larger than the mean's for Gaussian noise.
+     *
+     * Steady readings thereby take as few samples as possible, while noisy ones take more. As the standard error is estimated from the measurement's own samples, very few samples may agree by chance and stop the measurement too early, so a minimum of 3 to 5 samples is advisable. Setting both bounds to the same number is equivalent to `setNumberOfSamplesPerMeasurment`.
+     *
+     * Throws a `std::domain_error` if `minimalNumberOfSamples` is 0 or `standardErrorTolerance` is negative or not finite.
+     * Throws a `std::logic_error` if `maximalNumberOfSamples` is less than `minimalNumberOfSamples`.
+     */
+    void setAdaptiveNumberOfSamplesPerMeasurement(
+        const std::size_t minimalNumberOfSamples,
+        const std::size_t maximalNumberOfSamples,
+        const double standardErrorTolerance);
+    std::size_t getMinimalNumberOfSamplesPerMeasurement() const;
+    double getStandardErrorTolerance() const;
+
+    /**
+     * The standard deviation of each sensor's samples within a measurement, pooled over all measurements with at least two samples since the noise statistics were reset. 0 until there was such a measurement.
+     */
+    arma::Row<double> getNoiseStandardDeviations() const;
+
+    /**
+     * The number of samples each sensor is expected to need per measurement, based on its noise, i.e. `(noise / standardErrorTolerance)^2`, within the bounds of the adaptive sampling. A measurement takes as many samples as its noisiest sensor needs.
+     */
+    arma::Row<double> getExpectedNumbersOfSamplesPerMeasurement() const;
+
+    /**
+     * The average number of samples (i.e. hardware reads) per measurement since the noise statistics were reset.
+     */
+    double getAverageNumberOfSamplesPerMeasurement() const;
+
+    void resetNoiseStatistics();
+
+    /**
+     * Replaces the median over all samples of a measurement by a streaming filter (e.g. a `::demo::SampleFilterPipeline`), which is updated with each sample and keeps its state between measurements. A filtered measurement therefore needs a single sample (i.e. hardware read), which is the default number of samples per measurement. With more samples, each one updates the filter and the last result is returned.
+     *
+     * The filter sees the clamped, but uncorrected samples, and its results are clamped again before being corrected. Passing `nullptr` restores the median.
+     *
+     * Throws a `std::invalid_argument` if the filter was constructed for a different number of sensors.
+     */
+    void setSampleFilter(
+        std::unique_ptr<SampleFilter> sampleFilter);
+
+    /**
+     * Keeps the last `sampleHistoryCapacity` samples (i.e. hardware reads, before being filtered or corrected), together with the time they were taken, in a ring buffer. All sensors are sampled together, so they share one timestamp per sample. Samples that are not newer than the latest recorded one (e.g. the same asynchronous sample, read twice) are skipped. Changing the capacity discards the history. Defaults to 32 samples.
+     *
+     * Throws a `std::domain_error` if the capacity is less than 2.
+     */
+    void setSampleHistoryCapacity(
+        const std::size_t sampleHistoryCapacity);
+    std::size_t getSampleHistoryCapacity() const;
+
+    /**
+     * The time range covered by the sample history, within which `sampleAt()` can interpolate.
+     *
+     * Throws a `std::logic_error` if no sample was recorded yet.
+     */
+    std::chrono::steady_clock::time_point getOldestSampleTime() const;
+    std::chrono::steady_clock::time_point getLatestSampleTime() const;
+
+    /**
+     * Returns the (corrected) values at `time`, linearly interpolated between the two recorded samples around it, without reading the sensors again. This allows to combine different sensors at a common instant, e.g. the latest time all of them were sampled at.
+     *
+     * Like `measure()`, this must not be called concurrently to a measurement.
+     *
+     * Throws a `std::out_of_range` if `time` is not within the time range of the sample history.
+     */
+    arma::Row<double> sampleAt(
+        const std::chrono::steady_clock::time_point time) const;
+
    protected:
     arma::Mat<double> measurementCorrections_;
     std::size_t numberOfSamplesPerMeasuement_;
+    std::size_t minimalNumberOfSamplesPerMeasurement_;
+    double standardErrorTolerance_;
+    std::unique_ptr<SampleFilter> sampleFilter_;
+
+    /**
+     * The running mean and sum of squared deviations (see Welford's algorithm) of each sensor's samples within the current measurement.
+     */
+    arma::Row<double> measurementMeans_;
+    arma::Row<double> measurementSumsOfSquares_;
+
+    /**
+     * The noise statistics, accumulated over all measurements since the last `resetNoiseStatistics()`. The pooled variance of each sensor is its sum of squared deviations divided by the degrees of freedom (the number of samples minus one per measurement).
+     */
+    arma::Row<double> noiseSumsOfSquares_;
+    std::uint64_t noiseDegreesOfFreedom_;
+    std::uint64_t numberOfMeasurements_;
+    std::uint64_t numberOfSamples_;
+
+    /**
+     * The difference between each row of `measurementCorrections_` and its successor, followed by a row of zeros (so that the maximal measurable value needs no special case), as well as the number of rows per measured unit. Both are precomputed by `setMeasurementCorrections`, so that correcting a value takes a single multiply-add.
+     */
+    arma::Mat<double> measurementCorrectionSlopes_;
+    double measurementCorrectionIndexScale_;
+
+    /**
+     * The preallocated storage of `measureInto`. The samples are stored with one column per sensor, so that the samples of a sensor are contiguous when selecting their median.
+     */
+    arma::Mat<double> measurementSamples_;
+    arma::Row<double> measurementSample_;
+
+    /**
+     * The sample history, with one row per sample. The `n`-th recorded sample is stored at row `n % sampleHistoryCapacity_`.
+     */
+    arma::Mat<double> sampleHistory_;
+    std::vector<std::chrono::steady_clock::time_point> sampleHistoryTimes_;
+    std::uint64_t numberOfRecordedSamples_;
 
     virtual arma::Row<double> measureImplementation() = 0;
+
+    /**
+     * Writes a single sample into `measurements`, which already holds `numberOfSensors_` elements. Sensors which know when the sample was actually taken (e.g. by a background thread) set `sampleTime` accordingly. Otherwise, the sample is assumed to be taken in the middle of the call.
+     *
+     * Defaults to copying the result of `measureImplementation()`. Sensors should override this if they can measure without allocating memory.
+     */
+    virtual void measureImplementationInto(
+        arma::Row<double>& measurements,
+        std::chrono::steady_clock::time_point& sampleTime);
+
+    /**
+     * Takes over the measurement settings of `sensors` (i.e. the corrections, the number of samples, the sample filter and the sample history capacity), as needed by the move constructors of derived classes, which delegate to their main constructor.
+     */
+    void moveMeasurementSettings(
+        Sensors& sensors);
+
+    /**
+     * Maps a (clamped) sample of the `n`-th sensor to its corrected value.
+     */
+    double correct(
+        const std::size_t n,
+        const double sample) const;
   };
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 // C++ standard library
 #include <atomic>
+#include <chrono>
+#include <mutex>
 #include <thread>
 
 // Demonstrator
@@ -49,12 +51,21 @@ namespace demo {
     struct termios newSerial_;
     struct termios oldSerial_;
 
+    /**
+     * The latest attitudes, received by the measurement thread at `attitudesTime_` (i.e. when their line was read). Both are protected by `attitudesMutex_`.
+     */
     arma::Row<double>::fixed<3> attitudes_;
+    std::chrono::steady_clock::time_point attitudesTime_;
+    std::mutex attitudesMutex_;
 
     std::atomic<bool> killContinuousMeasurementThread_;
     std::thread continuousMeasurementThread_;
 
     arma::Row<double> measureImplementation() override;
+
+    void measureImplementationInto(
+        arma::Row<double>& measurements,
+        std::chrono::steady_clock::time_point& sampleTime) override;
     
     void asynchronousMeasurement();
   };
@@ -1,8 +1,20 @@
 #pragma once
 
 // C++ standard library
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
+// Unix library
+#include <poll.h>
+
 // Armadillo
 #include <armadillo>
 
@@ -19,6 +31,12 @@
  *         |                   |
  *         +--100 Ohm--[echo]--+
  *
+ * Each sensor is triggered with a 10 microsecond pulse, after which its echo pin is high for 58 microseconds per centimetre to the next obstacle. Echoes that don't start within a few milliseconds, or last longer than the maximal distance, are read as the maximal distance. Their timeouts are therefore derived from the maximal distance, instead of waiting for the sensor's own timeout of up to 38 milliseconds.
+ *
+ * The sensors are triggered in ranging groups (see `setRangingGroups()`). All sensors of a group are triggered together, and all of their echoes are watched within a single loop, which timestamps the rising and falling edge of each pin independently. By default, each group holds a single sensor, i.e. the sensors are triggered one after another. Each group is only triggered after a guard time has passed since the previous one was completed (see `setRangingGroupGuardTime()`), so that late echoes of one group aren't received by the next. By default, the guard time only applies if a group holds more than one sensor.
+ *
+ * By default, each measurement ranges all groups in the calling thread. After `runAsynchronous()` was called, a ranging thread cycles through the groups instead. Each completed group is published right away into a snapshot of the latest distances, which is read without locking by `getLatestDistances()` and `measure()`, and passed to all subscribers (see `subscribe()`). Consumers therefore react to each sensor as soon as its echo completed, instead of waiting for a whole measurement.
+ *
  * [1]: http://www.micropik.com/PDF/HCSR04.pdf
  */
 namespace demo {
@@ -38,9 +56,190 @@ namespace demo {
     DistanceSensors(DistanceSensors&) = delete;
     DistanceSensors& operator=(DistanceSensors&) = delete;
 
+    /**
+     * Let the kernel timestamp the echo edges of all sensors, using the specified GPIO character device (usually `/dev/gpiochip0`). Instead of busy-polling each pin, the measurement then sleeps until the edges occurred and the echo duration is independent of scheduler wake-ups.
+     *
+     * Throws a `std::runtime_error` if any line could not be requested.
+     * Throws a `std::logic_error` if the sensors are ranging asynchronously.
+     */
+    void useGpioChipEdgeEvents(
+        const std::string& gpioChipPath);
+
+    /**
+     * Triggers the sensors of each group together, and the groups one after another (in the given order), so that a measurement takes as long as the number of groups, instead of the number of sensors. Sensors whose bursts would be heard by each other (e.g. neighbouring sensors facing in similar directions) must be put into different groups, such as the opposite sensors of a hexagon `{{0, 3}, {1, 4}, {2, 5}}`.
+     *
+     * Throws a `std::out_of_range` if a group contains a sensor number that is not less than the number of sensors.
+     * Throws a `std::invalid_argument` if a group is empty, or not every sensor is part of exactly one group.
+     * Throws a `std::logic_error` if the sensors are ranging asynchronously.
+     */
+    void setRangingGroups(
+        const std::vector<std::vector<std::size_t>>& rangingGroups);
+    std::vector<std::vector<std::size_t>> getRangingGroups() const;
+
+    /**
+     * Sets the minimal time between completing one ranging group and triggering the next one. A burst may still be reflected by obstacles beyond the maximal distance after its group was completed (or timed out), and would then be received as an echo by the next group.
+     *
+     * The guard time adds to each group of a measurement (or ranging round). Unless set explicitly, it therefore follows the ranging groups: It is 0 while each group holds a single sensor (as by default), which keeps the sequential ranging as fast as before, and the maximal echo duration otherwise (e.g. about 2 milliseconds at a maximal distance of 0.35 metres). As a group is completed only after its bursts were sent, the reflections of all obstacles within the measurable range have then returned. Sensors that hear each other's late echoes while ranging sequentially, or obstacles far beyond the maximal distance, need a longer guard time.
+     *
+     * Throws a `std::domain_error` if the guard time is negative.
+     * Throws a `std::logic_error` if the sensors are ranging asynchronously.
+     */
+    void setRangingGroupGuardTime(
+        const std::chrono::microseconds rangingGroupGuardTime);
+    std::chrono::microseconds getRangingGroupGuardTime() const;
+
+    /**
+     * Registers a callback, which is called with the number of a sensor and its new distance (the median of its recent ranges, clamped to the measurable range, but not corrected), whenever the ranging thread completed its range. Subscribers are called in the order they were registered, by the ranging thread (or the thread starting it, for the first round), and therefore must not block. Exceptions thrown by a subscriber are discarded. Moving the sensors moves the subscribers along.
+     *
+     * Throws a `std::logic_error` if the sensors are ranging asynchronously.
+     */
+    void subscribe(
+        std::function<void(const std::size_t, const double)> subscriber);
+
+    /**
+     * Starts (or restarts) ranging all groups every `rangingInterval` in a separate thread. The interval is measured between absolute deadlines, so that it doesn't drift by the echo durations. If a round overruns its interval, the missed deadlines are skipped. The data sheet suggests at least 60 milliseconds per sensor, so that a previous burst isn't received as an echo.
+     *
+     * The first round is ranged in the calling thread, so that the snapshot is valid as soon as this returns. `measure()` then returns the latest snapshot. Instead of repeating it, the (maximal) number of samples per measurement sets the number of recent ranges per sensor, whose median is published, so that a single missed echo doesn't show up as the maximal distance. It is read once when the ranging starts. Moving the sensors moves the ranging along.
+     *
+     * Throws a `std::domain_error` if the interval is not greater than 0.
+     */
+    void runAsynchronous(
+        const std::chrono::microseconds rangingInterval);
+
+    /**
+     * Stops the ranging thread, if any. This may take up to the ranging interval, if the thread is sleeping. Afterwards, each measurement ranges all groups in the calling thread again.
+     */
+    void stopAsynchronous();
+
+    bool isRunningAsynchronous() const;
+
+    /**
+     * Copies the latest distance of each sensor (the median of its recent ranges, clamped to the measurable range, but not corrected) into `distances` (which must already hold one element per sensor), together with the time its latest range was completed. Returns false and leaves both unchanged if the sensors were never ranged asynchronously.
+     *
+     * As each group is published on its own, the snapshot may combine ranges of two consecutive rounds, but never a partially updated group. Doesn't allocate any memory and may be called from any thread, while the sensors are ranging.
+     *
+     * Throws a `std::invalid_argument` if `distances` doesn't hold one element per sensor.
+     */
+    bool getLatestDistances(
+        arma::Row<double>& distances,
+        std::chrono::steady_clock::time_point& rangeTime) const;
+
+    /**
+     * The number of ranging groups published since the sensors were first ranged asynchronously, e.g. to derive the achieved ranging rate.
+     */
+    std::uint64_t getNumberOfAsynchronousRanges() const;
+
+    ~DistanceSensors();
+
    protected:
+    enum class EchoState : unsigned int {
+      /**
+       * Waiting for the polled level to be low, before a rising edge is derived from it. A level that is still high after the trigger is a previous echo (or a stuck sensor), not the start of a new one. Captured edges skip this state, as a rising edge implies that the level was low before.
+       */
+      Triggered,
+      /**
+       * Waiting for the rising edge of the echo.
+       */
+      Listening,
+      /**
+       * Waiting for the falling edge of the echo.
+       */
+      Started,
+      Completed
+    };
+
     std::vector<Pin> pins_;
 
+    /**
+     * The longest echo within the measurable range, i.e. the maximal distance at 58 microseconds per centimetre.
+     */
+    const std::chrono::steady_clock::duration maximalEchoDuration_;
+
+    std::vector<std::vector<std::size_t>> rangingGroups_;
+
+    std::chrono::microseconds rangingGroupGuardTime_;
+    /**
+     * Indicates that the guard time wasn't set explicitly, and is updated by `setRangingGroups()`.
+     */
+    bool isDefaultRangingGroupGuardTime_;
+    /**
+     * The time the previous ranging group was completed, from which the guard time is measured.
+     */
+    std::chrono::steady_clock::time_point previousRangeEnd_;
+
+    /**
+     * The state of each sensor's echo and the time it started, as well as the file descriptors to poll for edges, preallocated for `range()`.
+     */
+    std::vector<EchoState> echoStates_;
+    std::vector<std::chrono::steady_clock::time_point> echoStarts_;
+    std::vector<struct ::pollfd> pollFileDescriptors_;
+
+    std::vector<std::function<void(const std::size_t, const double)>> subscribers_;
+
+    std::chrono::microseconds rangingInterval_;
+    std::atomic<bool> killRangingThread_;
+    std::thread rangingThread_;
+
+    /**
+     * The latest distance of each sensor, only accessed by the ranging thread (or while it isn't running).
+     */
+    arma::Row<double> rangedDistances_;
+
+    /**
+     * The latest ranges of each sensor, with one row per range, of which `rangedDistances_` holds the median. The `k`-th range of the `n`-th sensor is stored at row `k % recentRanges_.n_rows`, with `numbersOfRecentRanges_[n]` counting them. Only accessed by the ranging thread (or while it isn't running).
+     */
+    arma::Mat<double> recentRanges_;
+    std::vector<std::size_t> numbersOfRecentRanges_;
+    std::vector<double> sortedRecentRanges_;
+
+    /**
+     * A seqlock-protected double buffer of `rangedDistances_` (see `::demo::ExtensionSensors`), republished after each completed group: Range `n` is written into `latestDistances_[n % 2]`, after `rangeBegun_` was set to `n` and before `rangeCompleted_` is set to `n`. Readers retry if `rangeBegun_` advanced by two or more while copying.
+     */
+    std::array<std::unique_ptr<std::atomic<double>[]>, 2> latestDistances_;
+    /**
+     * The time each buffered range was completed, as `std::chrono::steady_clock` ticks.
+     */
+    std::array<std::atomic<std::chrono::steady_clock::rep>, 2> latestRangeTimes_;
+    std::atomic<std::uint64_t> rangeBegun_;
+    std::atomic<std::uint64_t> rangeCompleted_;
+
     arma::Row<double> measureImplementation() override;
+
+    void measureImplementationInto(
+        arma::Row<double>& measurements,
+        std::chrono::steady_clock::time_point& sampleTime) override;
+
+    /**
+     * Triggers all sensors of `rangingGroup` and writes their distances into `distances`, once all echoes were completed or timed out.
+     */
+    void range(
+        const std::vector<std::size_t>& rangingGroup,
+        arma::Row<double>& distances);
+
+    /**
+     * Advances the echo of the `n`-th sensor by a signal edge (either captured or derived from a changed level). Returns true if the echo was completed.
+     */
+    bool updateEcho(
+        const std::size_t n,
+        const SignalEdge& signalEdge,
+        arma::Row<double>& distances);
+
+    /**
+     * Ranges each group into `rangedDistances_`, publishes it and notifies the subscribers. Returns early if the ranging thread is stopped meanwhile.
+     */
+    void rangeAllGroups();
+
+    void rangeContinuously();
+
+    /**
+     * Stops the ranging thread, but keeps `rangingInterval_`, so that the ranging can be resumed by the moved-to instance.
+     */
+    void stopRangingThread();
+
+    /**
+     * Stops the ranging thread of `distanceSensors` and moves its pins out, before the move constructor delegates to the main constructor.
+     */
+    static std::vector<Pin> releasePins(
+        DistanceSensors& distanceSensors);
   };
 }
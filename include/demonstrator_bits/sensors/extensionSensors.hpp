@@ -1,6 +1,13 @@
 #pragma once
 
 // C++ standard library
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
 #include <vector>
 
 // Armadillo
@@ -17,6 +24,12 @@ namespace demo {
    *
    * Represents an array of extension sensors that are attached to [PRODUCT NAME HERE][1] linear actuators. Sensors can be queried for its current extension through SPI.
    *
+   * The sensors are read by one or more MCP3008 ADCs, with one conversion per channel. Channel `n` is the `n % 8`-th input of the ADC selected as slave `n / 8` of `spi`, i.e. channels 0 to 7 are read via `CE0`, 8 to 15 via `CE1` and the following ones via the additional chip selects (see `::demo::Gpio::allocateSpi`).
+   *
+   * All conversions of a measurement are submitted together via `::demo::Spi::transfer`, grouped by ADC. If `spi` uses the hardware SPI controller (see `::demo::Spi::useSpiDevice`), this takes a single system call per ADC at `CE0` and `CE1`. As all ADCs share the bus and the MCP3008 converts while being clocked, the conversions of different ADCs can't overlap, so the acquisition time grows with the number of channels, not the number of ADCs.
+   *
+   * By default, each measurement performs its conversions in the calling thread. After `runAsynchronous()` was called, a sampling thread converts all channels periodically instead, and `measure()` only reads (and corrects) the latest sample, without waiting for the ADC or contending for the SPI bus.
+   *
    * [1]: http://INSERT-PRODUCT-PAGE-HERE
    */
   class ExtensionSensors : public Sensors {
@@ -36,10 +49,84 @@ namespace demo {
     ExtensionSensors(ExtensionSensors&) = delete;
     ExtensionSensors& operator=(ExtensionSensors&) = delete;
 
+    /**
+     * Starts (or restarts) sampling all channels every `samplingInterval` in a separate thread. The interval is measured between absolute deadlines, so that it doesn't drift by the conversion time. If a conversion overruns its interval, the missed deadlines are skipped.
+     *
+     * `measure()` then returns the latest sample, so setting more than one sample per measurement only repeats it. Moving the sensors moves the sampling along.
+     */
+    void runAsynchronous(
+        const std::chrono::microseconds samplingInterval);
+
+    /**
+     * Stops the sampling thread, if any. Afterwards, each measurement performs its conversions in the calling thread again.
+     */
+    void stopAsynchronous();
+
+    bool isRunningAsynchronous() const;
+
+    /**
+     * The number of samples taken by the sampling thread since `runAsynchronous()` was called, e.g. to derive the achieved sampling rate.
+     */
+    std::uint64_t getNumberOfAsynchronousSamples() const;
+
+    ~ExtensionSensors();
+
    protected:
     Spi spi_;
     const std::vector<unsigned int> channels_;
 
+    /**
+     * The 3-byte conversion commands (a start bit and the single-ended channel selection) of all channels, and the corresponding responses.
+     */
+    std::vector<std::uint8_t> commands_;
+    std::vector<std::uint8_t> responses_;
+    std::vector<Backend::SpiTransfer> transfers_;
+
+    std::chrono::microseconds samplingInterval_;
+    std::atomic<bool> killSamplingThread_;
+    std::thread samplingThread_;
+
+    /**
+     * A seqlock-protected double buffer of raw 10-bit conversions, written by the sampling thread and read by `measure()` without locking.
+     *
+     * Sample `n` is written into `samples_[n % 2]`, after `sampleBegun_` was set to `n` and before `sampleCompleted_` is set to `n`. Readers copy `samples_[sampleCompleted_ % 2]` and retry if the writer began overwriting the same buffer meanwhile, i.e. `sampleBegun_` advanced by two or more. Each buffer holds one conversion per sensor, as there may be more than 8 channels (with several ADCs).
+     */
+    std::array<std::unique_ptr<std::atomic<std::uint16_t>[]>, 2> samples_;
+    /**
+     * The middle of each buffered sample's conversions, as `std::chrono::steady_clock` ticks.
+     */
+    std::array<std::atomic<std::chrono::steady_clock::rep>, 2> sampleTimes_;
+    std::atomic<std::uint64_t> sampleBegun_;
+    std::atomic<std::uint64_t> sampleCompleted_;
+
     arma::Row<double> measureImplementation() override;
+
+    void measureImplementationInto(
+        arma::Row<double>& measurements,
+        std::chrono::steady_clock::time_point& sampleTime) override;
+
+    /**
+     * Converts all channels into `responses_` and returns the middle of the conversions, as the time of the sample.
+     */
+    std::chrono::steady_clock::time_point convert();
+
+    /**
+     * Extracts the 10-bit result of the `n`-th channel from `responses_`.
+     */
+    std::uint16_t getConversionResult(
+        const std::size_t n) const;
+
+    void sample();
+
+    /**
+     * Stops the sampling thread, but keeps `samplingInterval_`, so that the sampling can be resumed by the moved-to instance.
+     */
+    void stopSamplingThread();
+
+    /**
+     * Stops the sampling thread of `extensionSensors` and moves its SPI out, before the move constructor delegates to the main constructor.
+     */
+    static Spi releaseSpi(
+        ExtensionSensors& extensionSensors);
   };
 }
@@ -1,15 +1,20 @@
 #pragma once
 
 // C++ standard library
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 // Armadillo
 #include <armadillo>
 
 // Demonstrator
+#include "demonstrator_bits/boardProfile.hpp"
 #include "demonstrator_bits/i2c.hpp"
 #include "demonstrator_bits/pin.hpp"
+#include "demonstrator_bits/pinGroup.hpp"
 
 namespace demo {
   /**
@@ -17,6 +22,8 @@ namespace demo {
    *
    * This class issues commands to an array of [PRODUCT NAME HERE][1] linear actuators.
    *
+   * The speeds are set via the PWM outputs of a PCA9685, and the directions via GPIO pins. Both are shadowed, so that `run()` only writes the direction pins if any direction changed, and only the PWM registers whose value changed (coalesced into as few block writes as possible).
+   *
    * [1]: http://INSERT-PRODUCT-PAGE-HERE
    */
   class ServoControllers {
@@ -26,11 +33,25 @@ namespace demo {
     
     const double maximalSpeed_;
 
+    /**
+     * The PWM frequency and the oscillator's start-up time are taken from `boardTimings`, which should be the timings of the board profile the direction pins were allocated with.
+     */
     explicit ServoControllers(
         std::vector<Pin>&& directionPins,
         I2c&& i2c,
         const std::vector<unsigned int>& channels,
-        const double maximalSpeed);
+        const double maximalSpeed,
+        const BoardTimings& boardTimings = BoardTimings());
+
+    /**
+     * Same as above, but with already grouped direction pins. The `n`-th pin of the group sets the direction of the `n`-th controller.
+     */
+    explicit ServoControllers(
+        PinGroup&& directionPins,
+        I2c&& i2c,
+        const std::vector<unsigned int>& channels,
+        const double maximalSpeed,
+        const BoardTimings& boardTimings = BoardTimings());
 
     explicit ServoControllers(
         ServoControllers&& servoControllers);
@@ -41,15 +62,71 @@ namespace demo {
     ServoControllers(ServoControllers&) = delete;
     ServoControllers& operator=(ServoControllers&) = delete;
 
+    /**
+     * Does nothing after `stopImmediately()` was called, until `stop()` is called.
+     */
     void run(
         const std::vector<bool>& forwards,
         const arma::Row<double>& speeds);
 
+    /**
+     * Stops all controllers by setting each channel's duty cycle to 0, with `::demo::I2cBus::Priority::Stop`. Unlike `run()`, all registers are written, regardless of their shadowed values. Only the channels of these controllers are written.
+     *
+     * Also ends a previous `stopImmediately()`, so that `run()` takes effect again.
+     */
     void stop();
 
+    /**
+     * Turns off all PWM outputs at once, by writing the full OFF bit to the PCA9685's ALL_LED_OFF register within a single bus transaction (instead of writing each channel's registers, as `stop()` does). The PCA9685 loads this into the registers of all 16 channels, so channels not driven by these controllers stay off as well, until they are written again.
+     *
+     * Afterwards, `run()` does nothing, keeping the outputs off until `stop()` is called, which sets the duty cycles of these controllers to 0 again.
+     *
+     * Doesn't throw, take locks or allocate memory, so it can be called from any thread (also while another one is within `run()`) and from signal handlers (given a hardware backend). If the I2C bus runs asynchronously, the write preempts and discards all pending updates of the PCA9685. Returns false if the write failed (or couldn't be submitted).
+     */
+    bool stopImmediately() noexcept;
+
+    /**
+     * The number of PWM register writes issued by `run()` and `stop()`, respectively skipped, as the register already held the value.
+     */
+    std::uint64_t getNumberOfIssuedRegisterWrites() const;
+    std::uint64_t getNumberOfSuppressedRegisterWrites() const;
+
    protected:
-    std::vector<Pin> directionPins_;
+    /**
+     * The direction of all controllers is set at once, with bit `n` being low if the `n`-th controller runs forwards.
+     */
+    PinGroup directionPins_;
 
     I2c i2c_;
+
+    BoardTimings boardTimings_;
+
+    /**
+     * The last written values of the LEDn_ON_L, LEDn_ON_H, LEDn_OFF_L and LEDn_OFF_H registers of all 16 PCA9685 channels, starting at LED0_ON_L (0x06).
+     */
+    std::array<std::uint8_t, 4 * 16> ledRegisters_;
+    /**
+     * Bit `n` is set if `ledRegisters_[n]` is known to match the register.
+     */
+    std::uint64_t knownLedRegisters_;
+
+    std::uint32_t directions_;
+    bool areDirectionsKnown_;
+
+    /**
+     * Set by `stopImmediately()` and cleared by `stop()`. While set, the shadowed registers are outdated, as the ALL_LED write overwrote them.
+     */
+    std::atomic<bool> isStoppedImmediately_;
+
+    std::atomic<std::uint64_t> numberOfIssuedRegisterWrites_;
+    std::atomic<std::uint64_t> numberOfSuppressedRegisterWrites_;
+
+    /**
+     * Writes the directions and duty cycles, skipping all values that match their shadowed ones.
+     */
+    void update(
+        const std::vector<bool>& forwards,
+        const arma::Row<double>& speeds,
+        const I2cBus::Priority priority);
   };
 }
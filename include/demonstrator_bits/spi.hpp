@@ -1,12 +1,24 @@
 #pragma once
 
+// C++ standard library
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+#include "demonstrator_bits/pin.hpp"
+
 namespace demo {
   /**
-   * An instance of this class represents an [SPI][1] master node, communicating over the GPIO pins of a Raspberry Pi with a single slave.
+   * An instance of this class represents an [SPI][1] master node, communicating over the GPIO pins of a Raspberry Pi with one or more slaves.
+   *
+   * This class allocates the five `demo::Spi::Pin`s for the duration of its lifetime, and deallocates them automatically on destruction. Slave 0 is selected via `CE0`, slave 1 via `CE1` and each further slave via one of the additional chip select pins passed to `::demo::Gpio::allocateSpi`. Each transfer names its slave in `::demo::Backend::SpiTransfer::slave`.
    *
-   * This class allocates the four `demo::Spi::Pin`s for the duration of its lifetime, and deallocates them automatically on destruction.
+   * Like pins, instances of this class must be obtained from `::demo::Gpio` – for more details, look at the `::demo::Pin` class docs.
    *
-   * Like pins, instances of this class must be obtained from `::demo::Gpio` – for more details, look at the `::demo::Pin` class docs.
+   * By default, the protocol is bit-banged over the GPIO pins. Calling `useSpiDevice()` switches `transfer()` to the hardware SPI controller of the backend for the slaves at `CE0` and `CE1`, which clocks consecutive transfers to the same slave within a single system call instead. Transfers to the additional chip selects remain bit-banged, as the controller can only select slaves via `CE0` and `CE1`.
    *
    * [1]: https://en.wikipedia.org/wiki/Serial_Peripheral_Interface_Bus
    */
@@ -20,12 +32,29 @@ namespace demo {
     };
 
     enum class Pin : unsigned int {
+      /**
+       * `CE0`, selecting slave 0.
+       */
       ChipSelect = 8,
+      /**
+       * `CE1`, selecting slave 1.
+       */
+      ChipSelect1 = 7,
       Miso = 9,
       Mosi = 10,
       Clock = 11
     };
 
+    /**
+     * The clock polarity and phase, see `::demo::Backend::SpiMode`.
+     */
+    using Mode = Backend::SpiMode;
+
+    enum class BitOrder : unsigned int {
+      MostSignificantBitFirst = 0,
+      LeastSignificantBitFirst = 1
+    };
+
     Spi& operator=(Spi&) = delete;
     Spi(Spi&) = delete;
 
@@ -33,18 +62,120 @@ namespace demo {
 
     Spi& operator=(Spi&&);
 
+    /**
+     * Sets a single pin, e.g. to hand-code a protocol that doesn't fit `transfer()`. Switches the pin to output mode on every call.
+     */
     void set(
         const Pin pin,
         const Digital value);
 
+    /**
+     * Reads a single pin. Switches the pin to input mode on every call.
+     */
     Digital get(
         const Pin pin);
 
+    /**
+     * Selects slave 0, sends the first `length` bytes of `transmitted` while receiving as many bytes into `received`, and deselects the slave again. `received` may be `nullptr`, if the response is of no interest.
+     *
+     * If the protocol is bit-banged, the pin directions are set once (until `set()` or `get()` change them) and whole bytes are clocked without any further mode switch.
+     */
+    void transfer(
+        const std::uint8_t* transmitted,
+        std::uint8_t* received,
+        const std::size_t length);
+
+    /**
+     * Performs the transfers one after another, selecting the transfer's slave during each transfer.
+     *
+     * If the hardware SPI controller is used, each run of consecutive transfers to the same slave is submitted as a single message. Therefore, ordering the transfers by slave minimises the number of system calls.
+     *
+     * Throws a `std::invalid_argument` if any transfer's slave is not less than `getNumberOfSlaves()`.
+     */
+    void transfer(
+        const std::vector<Backend::SpiTransfer>& transfers);
+
+    /**
+     * Sets the clock polarity and phase used by `transfer()`. Defaults to `Mode::Mode0`.
+     *
+     * If the hardware SPI controller is used, it is reopened with the new mode.
+     */
+    void setMode(
+        const Mode mode);
+
+    Mode getMode() const;
+
+    /**
+     * Sets the order in which the bits of each byte are sent and received by `transfer()`. Defaults to `BitOrder::MostSignificantBitFirst`.
+     */
+    void setBitOrder(
+        const BitOrder bitOrder);
+
+    BitOrder getBitOrder() const;
+
+    /**
+     * The number of slaves that can be selected, i.e. 2 (for `CE0` and `CE1`) plus the number of additional chip select pins.
+     */
+    std::size_t getNumberOfSlaves() const;
+
+    /**
+     * Let `transfer()` use the backend's hardware SPI controller (see `::demo::Backend::openSpiDevice`) for the slaves at `CE0` and `CE1`, clocked at (at most) `clockFrequency` Hz. Calling this again reopens the controller with the new clock.
+     *
+     * Throws a `std::runtime_error` if the controller could not be opened for `CE0`, in which case the protocol remains bit-banged. If only `CE1` could not be opened (e.g. as the device tree configures a single chip select), its transfers are bit-banged.
+     */
+    void useSpiDevice(
+        const unsigned int clockFrequency);
+
+    bool isUsingSpiDevice() const;
+
     virtual ~Spi();
 
    protected:
-    Spi();
+    explicit Spi(
+        std::vector<::demo::Pin>&& chipSelectPins);
 
     bool ownsSpi_;
+
+    /**
+     * The additional chip selects, for slaves 2 and up.
+     */
+    std::vector<::demo::Pin> chipSelectPins_;
+    /**
+     * The chip select pin of each slave, as a bitmask for `::demo::Backend::set`.
+     */
+    std::vector<std::uint32_t> chipSelectMasks_;
+
+    /**
+     * The handles returned by `::demo::Backend::openSpiDevice` for `CE0` and `CE1`, or -1 if the respective slave is bit-banged.
+     */
+    std::array<int, 2> spiDeviceHandles_;
+    unsigned int clockFrequency_;
+
+    Mode mode_;
+    BitOrder bitOrder_;
+
+    /**
+     * Indicates that all chip select, clock and MOSI pins are in output mode and MISO is in input mode, so that bit-banged transfers can skip switching them.
+     */
+    bool arePinDirectionsConfigured_;
+
+    /**
+     * Performs the transfers most significant bit first, without any ownership check.
+     */
+    void transferMostSignificantBitFirst(
+        const std::vector<Backend::SpiTransfer>& transfers);
+
+    /**
+     * Bit-bangs a single transfer, most significant bit first.
+     */
+    void bitBang(
+        const Backend::SpiTransfer& transfer);
+
+    /**
+     * Hands the SPI pins (back) to the hardware SPI controller.
+     */
+    void connectPinsToController();
+
+    void closeSpiDevices();
   };
 }
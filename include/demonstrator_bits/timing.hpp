@@ -0,0 +1,65 @@
+#pragma once
+
+// C++ standard library
+#include <chrono>
+
+namespace demo {
+  /**
+   * Delays for bit-banged protocols, such as the trigger pulse of a HC-SR04 or the latch of the distance indicators.
+   *
+   * `std::this_thread::sleep_for` only guarantees to sleep *at least* the requested duration and usually overshoots by the scheduler's wake-up latency (about 50–100 microseconds on a Raspberry Pi), which exceeds most protocol delays by far. Therefore, this module provides
+   *
+   * - `busyWait()`, which spins on the clock and is accurate to about the duration of a single clock read, but keeps the core busy,
+   * - `sleepUntil()`, which sleeps until an absolute deadline (using `clock_nanosleep` with `TIMER_ABSTIME`), so that periodic deadlines don't accumulate drift, and
+   * - `wait()`/`waitUntil()`, which sleep until shortly before the deadline and spin for the remainder. This is the recommended default.
+   *
+   * The clock read duration and the wake-up latency (the margin reserved for spinning) are measured by `calibrate()`, which is called automatically on first use.
+   *
+   * All deadlines use `std::chrono::steady_clock`, which is based on `CLOCK_MONOTONIC` on Linux.
+   */
+  namespace timing {
+    /**
+     * (Re-)measures the duration of a clock read and the wake-up latency of `sleepUntil()`. Takes a few milliseconds.
+     *
+     * Should be called again if the scheduling of the calling thread changes (e.g. after switching to a real-time policy), as this usually reduces the wake-up latency.
+     */
+    void calibrate();
+
+    /**
+     * The time needed to read `std::chrono::steady_clock::now()`, i.e. the resolution of `busyWait()`.
+     */
+    std::chrono::nanoseconds getClockReadDuration();
+
+    /**
+     * The (calibrated) time by which `sleepUntil()` may overshoot its deadline. `waitUntil()` spins for this long before the deadline.
+     */
+    std::chrono::nanoseconds getWakeUpLatency();
+
+    /**
+     * Spins until `duration` has passed, without yielding the processor.
+     */
+    void busyWait(
+        const std::chrono::nanoseconds duration);
+
+    /**
+     * Spins until `deadline` is reached. Never returns before the deadline, but may overshoot it by up to a clock read.
+     */
+    void busyWaitUntil(
+        const std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Sleeps until `deadline` is reached (returns immediately if it already passed). Interruptions by signals are resumed.
+     */
+    void sleepUntil(
+        const std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Sleeps until the wake-up latency before `deadline` and spins for the remainder. Delays shorter than the wake-up latency are only spun.
+     */
+    void waitUntil(
+        const std::chrono::steady_clock::time_point deadline);
+
+    void wait(
+        const std::chrono::nanoseconds duration);
+  }
+}
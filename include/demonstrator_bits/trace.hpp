@@ -0,0 +1,220 @@
+#pragma once
+#include "demonstrator_bits/config.hpp"
+
+// C++ standard library
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace demo {
+  /**
+   * Binary tracing of all pin, SPI and I2C accesses, e.g. to reconstruct the bus traffic of a single measurement.
+   *
+   * Writing a (debugging) message to `std::cout` for every access takes microseconds and distorts the timing of bit-banged protocols beyond recognition. Instead, each access is stored as a fixed-size `Record` in a ring buffer of the calling thread, which takes about as long as reading the clock and doesn't need any lock. A background thread (started by `start()`) periodically drains all rings into a file, which can be decoded offline via `readFile()` (or the `maintainTrace` application).
+   *
+   * Tracing is only compiled in if `USE_TRACE` is defined. Otherwise, `record()` is empty and `start()` throws.
+   */
+  namespace trace {
+    enum class Component : std::uint8_t {
+      Pin = 0,
+      Spi = 1,
+      I2c = 2,
+      /**
+       * A `::demo::PinGroup` access, the address being the register mask of its pins (bit `n` represents pin `n`) and the value the written, respectively read bitmask.
+       */
+      PinGroup = 3
+    };
+
+    enum class Operation : std::uint8_t {
+      /**
+       * Sets a pin, respectively writes a register.
+       */
+      Set = 0,
+      /**
+       * Reads a pin, respectively a register.
+       */
+      Get = 1,
+      /**
+       * Starts waiting for a signal edge, the value being the time-out in microseconds.
+       */
+      WaitForSignalEdge = 2,
+      /**
+       * A rising (value 1) or falling (value 0) signal edge was captured.
+       */
+      SignalEdge = 3,
+      /**
+       * No signal edge was captured before the time-out.
+       */
+      Timeout = 4,
+      /**
+       * An SPI transfer (either submitted to the hardware SPI controller or bit-banged) or an I2C block write, the address being the SPI slave, respectively the first I2C register, and the value the number of bytes.
+       */
+      Transfer = 5
+    };
+
+    /**
+     * A single access. The layout is fixed, as records are written to the trace file as-is.
+     */
+    struct Record {
+      /**
+       * Nanoseconds since the epoch of `std::chrono::steady_clock`.
+       */
+      std::uint64_t timestamp;
+      /**
+       * Numbers the traced threads in the order of their first record, starting with 0.
+       */
+      std::uint32_t threadNumber;
+      /**
+       * The written or read value.
+       */
+      std::uint32_t value;
+      /**
+       * The pin number (using BCM GPIO numbering), respectively the register number.
+       */
+      std::uint16_t address;
+      Component component;
+      Operation operation;
+      std::uint32_t reserved;
+    };
+
+    static_assert(sizeof(Record) == 24, "trace::Record: The record must be 24 bytes, as it is part of the file format.");
+
+    /**
+     * A single-producer, single-consumer ring of records. Each traced thread owns one, which is only drained by the background thread.
+     */
+    class Ring {
+     public:
+      /**
+       * The number of records a ring can hold. Records that don't fit (as the background thread didn't drain the ring in time) are dropped and counted.
+       */
+      static const std::size_t CAPACITY = 8192;
+
+      explicit Ring(
+          const std::uint32_t threadNumber);
+
+      Ring(Ring&) = delete;
+      Ring& operator=(Ring&) = delete;
+
+      inline void push(
+          const Component component,
+          const Operation operation,
+          const unsigned int address,
+          const unsigned int value) {
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= CAPACITY) {
+          numberOfDroppedRecords_.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+
+        Record& record = records_[head % CAPACITY];
+        record.timestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        record.threadNumber = threadNumber_;
+        record.value = static_cast<std::uint32_t>(value);
+        record.address = static_cast<std::uint16_t>(address);
+        record.component = component;
+        record.operation = operation;
+        record.reserved = 0;
+        // Publishes the record to the background thread.
+        head_.store(head + 1, std::memory_order_release);
+      }
+
+      /**
+       * Moves all pushed records to the end of `records` and returns their number. Must only be called by a single thread at a time.
+       */
+      std::size_t drain(
+          std::vector<Record>& records);
+
+      /**
+       * Discards all pushed records.
+       */
+      void clear();
+
+      std::uint64_t getNumberOfDroppedRecords() const;
+
+      const std::uint32_t threadNumber_;
+
+     protected:
+      // The producer's and consumer's positions are separated by the records, so that they don't share a cache line.
+      std::atomic<std::uint64_t> head_;
+      std::array<Record, CAPACITY> records_;
+      std::atomic<std::uint64_t> tail_;
+      std::atomic<std::uint64_t> numberOfDroppedRecords_;
+    };
+
+    /**
+     * Creates and registers the ring of the calling thread. Called once per thread by `record()`.
+     */
+    std::shared_ptr<Ring> registerThread();
+
+    /**
+     * Indicates whether `start()` was called (and `stop()` wasn't called since). Should only be accessed via `isRecording()`.
+     */
+    extern std::atomic<bool> isStarted;
+
+    inline bool isRecording() {
+      return isStarted.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Appends a record to the calling thread's ring, if tracing was started. Compiles to nothing if `USE_TRACE` isn't defined.
+     */
+    inline void record(
+        const Component component,
+        const Operation operation,
+        const unsigned int address,
+        const unsigned int value) {
+#if defined(USE_TRACE)
+      if (!isRecording()) {
+        return;
+      }
+
+      // Registered on the first record of each thread and kept alive by the background thread until it is drained, even if the thread exits.
+      static thread_local const std::shared_ptr<Ring> ring = registerThread();
+      ring->push(component, operation, address, value);
+#else
+      static_cast<void>(component);
+      static_cast<void>(operation);
+      static_cast<void>(address);
+      static_cast<void>(value);
+#endif
+    }
+
+    /**
+     * Starts recording and the background thread, which appends the rings' records to `path` every `drainInterval`. An existing file is overwritten.
+     *
+     * Throws a `std::logic_error` if tracing was already started or the library was built without `USE_TRACE`, and a `std::runtime_error` if the file could not be opened.
+     */
+    void start(
+        const std::string& path,
+        const std::chrono::milliseconds drainInterval = std::chrono::milliseconds(10));
+
+    /**
+     * Stops recording, drains all remaining records and closes the file. Does nothing if tracing wasn't started.
+     */
+    void stop();
+
+    /**
+     * The total number of records dropped since the last `start()`, as a ring was full.
+     */
+    std::uint64_t getNumberOfDroppedRecords();
+
+    /**
+     * Reads all records from a trace file, sorted by their timestamp.
+     *
+     * Throws a `std::runtime_error` if the file could not be read or isn't a trace file.
+     */
+    std::vector<Record> readFile(
+        const std::string& path);
+
+    std::string getComponentName(
+        const Component component);
+
+    std::string getOperationName(
+        const Operation operation);
+  }
+}
@@ -0,0 +1,157 @@
+#include "demonstrator_bits/backend.hpp"
+
+// C++ standard library
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// Unix library
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace demo {
+  bool Backend::get(
+      const unsigned int pinNumber) {
+    return ((getLevels() >> pinNumber) & 1u) != 0;
+  }
+
+  void Backend::setI2cRegisters(
+      const int handle,
+      const unsigned int address,
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues) {
+    if (numberOfValues > MAXIMAL_NUMBER_OF_I2C_VALUES) {
+      throw std::invalid_argument("Backend.setI2cRegisters: The number of values must not be greater than " + std::to_string(MAXIMAL_NUMBER_OF_I2C_VALUES) + ".");
+    }
+
+    if (!trySetI2cRegisters(handle, address, firstRegisterNumber, values, numberOfValues)) {
+      throw std::runtime_error("Backend.setI2cRegisters: Could not write to the I2C slave at address " + std::to_string(address) + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+  }
+
+  bool Backend::trySetI2cRegisters(
+      const int handle,
+      const unsigned int address,
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues) noexcept {
+    // The message is assembled on the stack, as a signal handler must not allocate memory.
+    std::array<std::uint8_t, MAXIMAL_NUMBER_OF_I2C_VALUES + 1> buffer;
+    if (numberOfValues + 1 > buffer.size()) {
+      return false;
+    }
+
+    buffer[0] = static_cast<std::uint8_t>(firstRegisterNumber);
+    std::copy(values, values + numberOfValues, buffer.begin() + 1);
+
+    struct ::i2c_msg message;
+    message.addr = static_cast<decltype(message.addr)>(address);
+    message.flags = 0;
+    message.len = static_cast<decltype(message.len)>(numberOfValues + 1);
+    message.buf = buffer.data();
+
+    // Unlike `I2C_SLAVE` and `::write`, `I2C_RDWR` addresses each message on its own, so that all slaves share the same file descriptor.
+    struct ::i2c_rdwr_ioctl_data messages;
+    messages.msgs = &message;
+    messages.nmsgs = 1;
+
+    return ::ioctl(handle, I2C_RDWR, &messages) >= 0;
+  }
+
+  unsigned int Backend::getI2cRegister(
+      const int handle,
+      const unsigned int address,
+      const unsigned int registerNumber) {
+    std::uint8_t registerNumberByte = static_cast<std::uint8_t>(registerNumber);
+    std::uint8_t value = 0;
+
+    std::array<struct ::i2c_msg, 2> parts;
+    parts.at(0).addr = static_cast<decltype(parts.at(0).addr)>(address);
+    parts.at(0).flags = 0;
+    parts.at(0).len = 1;
+    parts.at(0).buf = &registerNumberByte;
+    parts.at(1).addr = static_cast<decltype(parts.at(1).addr)>(address);
+    parts.at(1).flags = I2C_M_RD;
+    parts.at(1).len = 1;
+    parts.at(1).buf = &value;
+
+    struct ::i2c_rdwr_ioctl_data messages;
+    messages.msgs = parts.data();
+    messages.nmsgs = static_cast<decltype(messages.nmsgs)>(parts.size());
+
+    if (::ioctl(handle, I2C_RDWR, &messages) < 0) {
+      throw std::runtime_error("Backend.getI2cRegister: Could not read from the I2C slave at address " + std::to_string(address) + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    return value;
+  }
+
+  void Backend::closeI2cBus(
+      const int handle) {
+    ::close(handle);
+  }
+
+  int Backend::openSpiDevice(
+      const unsigned int chipSelect,
+      const unsigned int clockFrequency,
+      const SpiMode mode) {
+    const std::string spiDevicePath = "/dev/spidev0." + std::to_string(chipSelect);
+
+    const int fileDescriptor = ::open(spiDevicePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+      throw std::runtime_error("Backend.openSpiDevice: Could not open " + spiDevicePath + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    // The mode's bits match the ones of `SPI_CPOL` and `SPI_CPHA`.
+    std::uint8_t spiMode = static_cast<std::uint8_t>(mode);
+    std::uint8_t bitsPerWord = 8;
+    std::uint32_t maximalClockFrequency = clockFrequency;
+    if (::ioctl(fileDescriptor, SPI_IOC_WR_MODE, &spiMode) < 0 || ::ioctl(fileDescriptor, SPI_IOC_WR_BITS_PER_WORD, &bitsPerWord) < 0 || ::ioctl(fileDescriptor, SPI_IOC_WR_MAX_SPEED_HZ, &maximalClockFrequency) < 0) {
+      const std::string error = std::strerror(errno);
+      ::close(fileDescriptor);
+      throw std::runtime_error("Backend.openSpiDevice: Could not configure " + spiDevicePath + ": " + error);
+    }
+
+    return fileDescriptor;
+  }
+
+  void Backend::transferSpi(
+      const int handle,
+      const std::vector<SpiTransfer>& transfers) {
+    if (transfers.empty()) {
+      return;
+    }
+
+    if (transfers.size() * sizeof(struct ::spi_ioc_transfer) >= (1u << _IOC_SIZEBITS)) {
+      throw std::invalid_argument("Backend.transferSpi: The message must not contain more than " + std::to_string(((1u << _IOC_SIZEBITS) - 1) / sizeof(struct ::spi_ioc_transfer)) + " transfers.");
+    }
+
+    std::vector<struct ::spi_ioc_transfer> messages(transfers.size());
+    for (std::size_t n = 0; n < transfers.size(); ++n) {
+      std::memset(&messages.at(n), 0, sizeof(struct ::spi_ioc_transfer));
+      messages.at(n).tx_buf = reinterpret_cast<std::uintptr_t>(transfers.at(n).transmitted);
+      messages.at(n).rx_buf = reinterpret_cast<std::uintptr_t>(transfers.at(n).received);
+      messages.at(n).len = static_cast<std::uint32_t>(transfers.at(n).length);
+      // Deselects the slave between two transfers (and keeps the default after the last one, which is to deselect it).
+      messages.at(n).cs_change = (n + 1 < transfers.size() ? 1 : 0);
+    }
+
+    // `SPI_IOC_MESSAGE(n)` expects `n` to be a compile-time constant, so the request is assembled the same way, but at runtime.
+    const unsigned long request = _IOC(_IOC_WRITE, SPI_IOC_MAGIC, 0, messages.size() * sizeof(struct ::spi_ioc_transfer));
+    if (::ioctl(handle, request, messages.data()) < 0) {
+      throw std::runtime_error("Backend.transferSpi: Could not transfer the message: " + static_cast<std::string>(std::strerror(errno)));
+    }
+  }
+
+  void Backend::closeSpiDevice(
+      const int handle) {
+    ::close(handle);
+  }
+}
@@ -0,0 +1,55 @@
+#include "demonstrator_bits/backends/gpioMemBackend.hpp"
+
+// C++ standard library
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// Unix library
+#include <fcntl.h>
+
+// Demonstrator
+#include "demonstrator_bits/gpioRegisters.hpp"
+
+namespace demo {
+  GpioMemBackend::GpioMemBackend(
+      const std::string& i2cDevicePath,
+      const std::string& uartDevicePath)
+      : i2cDevicePath_(i2cDevicePath),
+        uartDevicePath_(uartDevicePath) {
+  }
+
+  void GpioMemBackend::setMode(
+      const unsigned int pinNumber,
+      const Mode mode) {
+    // `Backend::Mode` uses the same values as the function select registers.
+    GpioRegisters::setMode(pinNumber, static_cast<GpioRegisters::Mode>(mode));
+  }
+
+  void GpioMemBackend::set(
+      const std::uint32_t mask) {
+    GpioRegisters::set(mask);
+  }
+
+  void GpioMemBackend::clear(
+      const std::uint32_t mask) {
+    GpioRegisters::clear(mask);
+  }
+
+  std::uint32_t GpioMemBackend::getLevels() {
+    return GpioRegisters::getLevels();
+  }
+
+  int GpioMemBackend::openI2cBus() {
+    const int handle = ::open(i2cDevicePath_.c_str(), O_RDWR | O_CLOEXEC);
+    if (handle < 0) {
+      throw std::runtime_error("GpioMemBackend.openI2cBus: Could not open " + i2cDevicePath_ + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    return handle;
+  }
+
+  std::string GpioMemBackend::getUartDevicePath() {
+    return uartDevicePath_;
+  }
+}
@@ -0,0 +1,476 @@
+#include "demonstrator_bits/backends/simulatedBackend.hpp"
+#include "demonstrator_bits/config.hpp"
+
+// C++ standard library
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Unix library
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace demo {
+  namespace {
+    // The bit-banged SPI pins, as used by `::demo::Spi`.
+    const unsigned int adcChipSelect0Pin = 8;
+    const unsigned int adcChipSelect1Pin = 7;
+    const unsigned int adcMisoPin = 9;
+    const unsigned int adcMosiPin = 10;
+    const unsigned int adcClockPin = 11;
+  }
+
+  SimulatedBackend::SimulatedBackend()
+      : outputPins_(0),
+        outputLevels_(0),
+        uartMasterFileDescriptor_(-1),
+        uartSlaveFileDescriptor_(-1),
+        attitude_({{0.0, 0.0, 0.0}}),
+        attitudeOffset_({{0.0, 0.0, 0.0}}),
+        killImuThread_(false) {
+    adcs_[adcChipSelect0Pin];
+    adcs_[adcChipSelect1Pin];
+
+    // Power-on values of the PCA9685: MODE1 (sleeping, responding to the all-call address), MODE2 (totem pole outputs) and the pre-scaler for 200Hz.
+    pca9685Registers_.fill(0);
+    pca9685Registers_.at(0x00) = 0x11;
+    pca9685Registers_.at(0x01) = 0x04;
+    pca9685Registers_.at(0xFE) = 0x1E;
+  }
+
+  void SimulatedBackend::setMode(
+      const unsigned int pinNumber,
+      const Mode mode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (mode == Mode::Output) {
+      outputPins_ |= 1u << pinNumber;
+    } else {
+      outputPins_ &= ~(1u << pinNumber);
+    }
+  }
+
+  void SimulatedBackend::set(
+      const std::uint32_t mask) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const std::uint32_t previousLevels = outputLevels_;
+    outputLevels_ |= mask & outputPins_;
+    updateDevices(previousLevels);
+  }
+
+  void SimulatedBackend::clear(
+      const std::uint32_t mask) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const std::uint32_t previousLevels = outputLevels_;
+    outputLevels_ &= ~(mask & outputPins_);
+    updateDevices(previousLevels);
+  }
+
+  std::uint32_t SimulatedBackend::getLevels() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::uint32_t inputLevels = 0;
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& echoStart : echoStarts_) {
+      if (now >= echoStart.second && now < echoEnds_.at(echoStart.first)) {
+        inputLevels |= 1u << echoStart.first;
+      }
+    }
+
+    for (const auto& adc : adcs_) {
+      if (adc.second.getOutput()) {
+        inputLevels |= 1u << adcMisoPin;
+      }
+    }
+
+    return (outputLevels_ & outputPins_) | (inputLevels & ~outputPins_);
+  }
+
+  int SimulatedBackend::openI2cBus() {
+    return 1;
+  }
+
+  void SimulatedBackend::setI2cRegisters(
+      const int handle,
+      const unsigned int address,
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues) {
+    static_cast<void>(handle);
+    if (address != PCA9685_ADDRESS) {
+      throw std::runtime_error("SimulatedBackend.setI2cRegisters: There is no simulated I2C device at address " + std::to_string(address) + ".");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // MODE1 bit 5 enables the auto-increment.
+    const bool isAutoIncrementing = (pca9685Registers_.at(0x00) & 0x20) != 0;
+    unsigned int registerNumber = firstRegisterNumber;
+    for (std::size_t n = 0; n < numberOfValues; ++n) {
+      if (registerNumber >= 0xFA && registerNumber <= 0xFD) {
+        // ALL_LED_ON_L to ALL_LED_OFF_H are loaded into the respective register of all 16 channels, and read back as 0.
+        for (unsigned int channel = 0; channel < 16; ++channel) {
+          pca9685Registers_.at(0x06 + 4 * channel + registerNumber - 0xFA) = values[n];
+        }
+      } else {
+        pca9685Registers_.at(registerNumber) = values[n];
+      }
+      if (isAutoIncrementing) {
+        registerNumber = (registerNumber + 1) % static_cast<unsigned int>(pca9685Registers_.size());
+      }
+    }
+  }
+
+  bool SimulatedBackend::trySetI2cRegisters(
+      const int handle,
+      const unsigned int address,
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues) noexcept {
+    try {
+      setI2cRegisters(handle, address, firstRegisterNumber, values, numberOfValues);
+    } catch (...) {
+      return false;
+    }
+
+    return true;
+  }
+
+  unsigned int SimulatedBackend::getI2cRegister(
+      const int handle,
+      const unsigned int address,
+      const unsigned int registerNumber) {
+    static_cast<void>(handle);
+    if (address != PCA9685_ADDRESS) {
+      throw std::runtime_error("SimulatedBackend.getI2cRegister: There is no simulated I2C device at address " + std::to_string(address) + ".");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return pca9685Registers_.at(registerNumber);
+  }
+
+  void SimulatedBackend::closeI2cBus(
+      const int handle) {
+    static_cast<void>(handle);
+  }
+
+  std::string SimulatedBackend::getUartDevicePath() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (uartMasterFileDescriptor_ == -1) {
+      // The master is non-blocking, so that the simulated IMU doesn't stall if no one reads its output.
+      uartMasterFileDescriptor_ = ::posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+      if (uartMasterFileDescriptor_ < 0 || ::grantpt(uartMasterFileDescriptor_) != 0 || ::unlockpt(uartMasterFileDescriptor_) != 0) {
+        throw std::runtime_error("SimulatedBackend.getUartDevicePath: Could not create a pseudo terminal: " + static_cast<std::string>(std::strerror(errno)));
+      }
+      uartDevicePath_ = ::ptsname(uartMasterFileDescriptor_);
+
+      uartSlaveFileDescriptor_ = ::open(uartDevicePath_.c_str(), O_RDWR | O_NOCTTY);
+      if (uartSlaveFileDescriptor_ < 0) {
+        throw std::runtime_error("SimulatedBackend.getUartDevicePath: Could not open " + uartDevicePath_ + ": " + static_cast<std::string>(std::strerror(errno)));
+      }
+
+      // Disables the echo, as the IMU would otherwise receive its own output.
+      struct ::termios settings;
+      ::tcgetattr(uartSlaveFileDescriptor_, &settings);
+      settings.c_lflag &= ~static_cast<tcflag_t>(ECHO);
+      ::tcsetattr(uartSlaveFileDescriptor_, TCSANOW, &settings);
+
+      if (::demo::isVerbose) {
+        std::cout << "Simulating the IMU on " << uartDevicePath_ << std::endl;
+      }
+
+      imuThread_ = std::thread(&SimulatedBackend::simulateImu, this);
+    }
+
+    return uartDevicePath_;
+  }
+
+  int SimulatedBackend::openSpiDevice(
+      const unsigned int chipSelect,
+      const unsigned int clockFrequency,
+      const SpiMode mode) {
+    static_cast<void>(clockFrequency);
+    static_cast<void>(mode);
+
+    if (chipSelect > 1) {
+      throw std::runtime_error("SimulatedBackend.openSpiDevice: There is no simulated SPI device at chip select " + std::to_string(chipSelect) + ".");
+    }
+
+    return static_cast<int>(chipSelect);
+  }
+
+  void SimulatedBackend::transferSpi(
+      const int handle,
+      const std::vector<SpiTransfer>& transfers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Mcp3008& adc = adcs_.at(handle == 0 ? adcChipSelect0Pin : adcChipSelect1Pin);
+    for (const auto& transfer : transfers) {
+      adc.select();
+      for (std::size_t n = 0; n < transfer.length; ++n) {
+        std::uint8_t received = 0;
+        for (unsigned int bit = 8; bit > 0; --bit) {
+          // Mode 0: The master samples on the rising edge, while the slave shifts on the falling edge.
+          received = static_cast<std::uint8_t>((received << 1) | (adc.getOutput() ? 1 : 0));
+          adc.clockRisingEdge(((transfer.transmitted[n] >> (bit - 1)) & 1u) != 0);
+          adc.clockFallingEdge();
+        }
+        if (transfer.received != nullptr) {
+          transfer.received[n] = received;
+        }
+      }
+      adc.deselect();
+    }
+  }
+
+  void SimulatedBackend::closeSpiDevice(
+      const int handle) {
+    static_cast<void>(handle);
+  }
+
+  void SimulatedBackend::setDistance(
+      const unsigned int pinNumber,
+      const double distance) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    distances_[pinNumber] = distance;
+  }
+
+  void SimulatedBackend::setAnalogValue(
+      const unsigned int channel,
+      const unsigned int value) {
+    setAnalogValue(adcChipSelect0Pin, channel, value);
+  }
+
+  void SimulatedBackend::setAnalogValue(
+      const unsigned int chipSelectPin,
+      const unsigned int channel,
+      const unsigned int value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    adcs_[chipSelectPin].setAnalogValue(channel, value);
+  }
+
+  void SimulatedBackend::setAnalogNoise(
+      const unsigned int channel,
+      const double standardDeviation) {
+    setAnalogNoise(adcChipSelect0Pin, channel, standardDeviation);
+  }
+
+  void SimulatedBackend::setAnalogNoise(
+      const unsigned int chipSelectPin,
+      const unsigned int channel,
+      const double standardDeviation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    adcs_[chipSelectPin].setAnalogNoise(channel, standardDeviation);
+  }
+
+  unsigned int SimulatedBackend::getPca9685Register(
+      const unsigned int registerNumber) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return pca9685Registers_.at(registerNumber);
+  }
+
+  void SimulatedBackend::setAttitude(
+      const double yaw,
+      const double pitch,
+      const double roll) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    attitude_ = {{yaw, pitch, roll}};
+  }
+
+  SimulatedBackend::~SimulatedBackend() {
+    if (imuThread_.joinable()) {
+      killImuThread_ = true;
+      imuThread_.join();
+    }
+
+    if (uartSlaveFileDescriptor_ != -1) {
+      ::close(uartSlaveFileDescriptor_);
+    }
+    if (uartMasterFileDescriptor_ != -1) {
+      ::close(uartMasterFileDescriptor_);
+    }
+  }
+
+  void SimulatedBackend::updateDevices(
+      const std::uint32_t previousLevels) {
+    const std::uint32_t risingPins = ~previousLevels & outputLevels_;
+    const std::uint32_t fallingPins = previousLevels & ~outputLevels_;
+
+    // HC-SR04: The falling edge of the trigger pulse starts the echo.
+    if (fallingPins != 0) {
+      const auto now = std::chrono::steady_clock::now();
+      for (unsigned int pinNumber = 0; pinNumber < 32; ++pinNumber) {
+        if ((fallingPins >> pinNumber) & 1u) {
+          const auto distance = distances_.find(pinNumber);
+          // 58us per centimetre, as stated in the data sheet.
+          const std::chrono::nanoseconds echoDuration(static_cast<std::chrono::nanoseconds::rep>((distance != distances_.end() ? distance->second : 0.2) * 5800000.0));
+          echoStarts_[pinNumber] = now + std::chrono::microseconds(250);
+          echoEnds_[pinNumber] = echoStarts_[pinNumber] + echoDuration;
+        }
+      }
+    }
+
+    // MCP3008: Selected while chip select is low. Deselected ADCs ignore the clock.
+    for (auto& adc : adcs_) {
+      if ((fallingPins >> adc.first) & 1u) {
+        adc.second.select();
+      } else if ((risingPins >> adc.first) & 1u) {
+        adc.second.deselect();
+      }
+
+      if ((risingPins >> adcClockPin) & 1u) {
+        adc.second.clockRisingEdge(((outputLevels_ >> adcMosiPin) & 1u) != 0);
+      } else if ((fallingPins >> adcClockPin) & 1u) {
+        adc.second.clockFallingEdge();
+      }
+    }
+  }
+
+  SimulatedBackend::Mcp3008::Mcp3008()
+      : sampledValue_(0),
+        isSelected_(false),
+        numberOfCommandBits_(0),
+        command_(0),
+        numberOfOutputEdges_(0),
+        output_(false) {
+    analogValues_.fill(512);
+    analogNoises_.fill(0.0);
+  }
+
+  void SimulatedBackend::Mcp3008::setAnalogValue(
+      const unsigned int channel,
+      const unsigned int value) {
+    if (channel > 7) {
+      throw std::domain_error("SimulatedBackend.setAnalogValue: The channel must be within [0, 7].");
+    } else if (value > 1023) {
+      throw std::domain_error("SimulatedBackend.setAnalogValue: The value must be within [0, 1023].");
+    }
+
+    analogValues_.at(channel) = value;
+  }
+
+  void SimulatedBackend::Mcp3008::setAnalogNoise(
+      const unsigned int channel,
+      const double standardDeviation) {
+    if (channel > 7) {
+      throw std::domain_error("SimulatedBackend.setAnalogNoise: The channel must be within [0, 7].");
+    } else if (!(standardDeviation >= 0.0)) {
+      throw std::domain_error("SimulatedBackend.setAnalogNoise: The standard deviation must be greater than or equal to 0.");
+    }
+
+    analogNoises_.at(channel) = standardDeviation;
+  }
+
+  void SimulatedBackend::Mcp3008::select() {
+    isSelected_ = true;
+    numberOfCommandBits_ = 0;
+    command_ = 0;
+    numberOfOutputEdges_ = 0;
+    output_ = false;
+  }
+
+  void SimulatedBackend::Mcp3008::deselect() {
+    isSelected_ = false;
+    output_ = false;
+  }
+
+  void SimulatedBackend::Mcp3008::clockRisingEdge(
+      const bool input) {
+    // Leading zeros are ignored until the start bit is received.
+    if (!isSelected_ || numberOfCommandBits_ >= 5 || (numberOfCommandBits_ == 0 && !input)) {
+      return;
+    }
+
+    command_ = (command_ << 1) | (input ? 1u : 0u);
+    ++numberOfCommandBits_;
+
+    if (numberOfCommandBits_ == 5) {
+      const unsigned int channel = command_ & 0x7;
+      sampledValue_ = analogValues_.at(channel);
+      if (analogNoises_.at(channel) > 0.0) {
+        const double noisyValue = std::round(static_cast<double>(sampledValue_) + std::normal_distribution<double>(0.0, analogNoises_.at(channel))(noiseGenerator_));
+        sampledValue_ = static_cast<unsigned int>(std::min(std::max(noisyValue, 0.0), 1023.0));
+      }
+    }
+  }
+
+  void SimulatedBackend::Mcp3008::clockFallingEdge() {
+    if (!isSelected_ || numberOfCommandBits_ < 5) {
+      output_ = false;
+      return;
+    }
+
+    ++numberOfOutputEdges_;
+    const unsigned int value = sampledValue_;
+    if (numberOfOutputEdges_ <= 2) {
+      // The end of the sample period, followed by the null bit.
+      output_ = false;
+    } else if (numberOfOutputEdges_ <= 12) {
+      output_ = ((value >> (12 - numberOfOutputEdges_)) & 1u) != 0;
+    } else if (numberOfOutputEdges_ <= 21) {
+      output_ = ((value >> (numberOfOutputEdges_ - 12)) & 1u) != 0;
+    } else {
+      output_ = false;
+    }
+  }
+
+  bool SimulatedBackend::Mcp3008::getOutput() const {
+    return output_;
+  }
+
+  void SimulatedBackend::simulateImu() {
+    auto nextLine = std::chrono::steady_clock::now();
+    std::string received;
+
+    while (!killImuThread_) {
+      struct ::pollfd pollFileDescriptor;
+      pollFileDescriptor.fd = uartMasterFileDescriptor_;
+      pollFileDescriptor.events = POLLIN;
+      const auto remainingTime = std::chrono::duration_cast<std::chrono::milliseconds>(nextLine - std::chrono::steady_clock::now());
+      if (::poll(&pollFileDescriptor, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, remainingTime.count()))) > 0) {
+        char buffer[64];
+        const ssize_t numberOfReceivedChars = ::read(uartMasterFileDescriptor_, buffer, sizeof(buffer));
+        if (numberOfReceivedChars > 0) {
+          received.append(buffer, static_cast<std::size_t>(numberOfReceivedChars));
+          if (received.find("#r") != std::string::npos) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            attitudeOffset_ = attitude_;
+            received.clear();
+          } else if (received.size() > 1) {
+            // Keeps the last character, as it might be the first half of a command.
+            received.erase(0, received.size() - 1);
+          }
+        }
+        continue;
+      }
+
+      char line[64];
+      int lineLength;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lineLength = std::snprintf(line, sizeof(line), "#YPR=%.2f,%.2f,%.2f\n", attitude_.at(0) - attitudeOffset_.at(0), attitude_.at(1) - attitudeOffset_.at(1), attitude_.at(2) - attitudeOffset_.at(2));
+      }
+      // Lines that don't fit into the pseudo terminal's buffer (as no one reads them) are dropped, like on a real serial line.
+      static_cast<void>(::write(uartMasterFileDescriptor_, line, static_cast<std::size_t>(lineLength)));
+
+      nextLine += std::chrono::milliseconds(20);
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#include "demonstrator_bits/backends/wiringPiBackend.hpp"
+
+#if defined(USE_WIRINGPI)
+// C++ standard library
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// Unix library
+#include <fcntl.h>
+
+// WiringPi
+#include <wiringPi.h>
+
+namespace demo {
+  WiringPiBackend::WiringPiBackend() {
+    ::wiringPiSetupGpio();
+  }
+
+  void WiringPiBackend::setMode(
+      const unsigned int pinNumber,
+      const Mode mode) {
+    if (mode == Mode::Alternate0) {
+      ::pinModeAlt(static_cast<int>(pinNumber), static_cast<int>(mode));
+    } else {
+      ::pinMode(static_cast<int>(pinNumber), mode == Mode::Output ? OUTPUT : INPUT);
+    }
+  }
+
+  void WiringPiBackend::set(
+      const std::uint32_t mask) {
+    for (unsigned int pinNumber = 0; pinNumber < 32; ++pinNumber) {
+      if ((mask >> pinNumber) & 1u) {
+        ::digitalWrite(static_cast<int>(pinNumber), HIGH);
+      }
+    }
+  }
+
+  void WiringPiBackend::clear(
+      const std::uint32_t mask) {
+    for (unsigned int pinNumber = 0; pinNumber < 32; ++pinNumber) {
+      if ((mask >> pinNumber) & 1u) {
+        ::digitalWrite(static_cast<int>(pinNumber), LOW);
+      }
+    }
+  }
+
+  std::uint32_t WiringPiBackend::getLevels() {
+    std::uint32_t levels = 0;
+    // Pins 0 and 1 are reserved for the ID EEPROM and pins above 27 are not available on the pin header.
+    for (unsigned int pinNumber = 2; pinNumber < 28; ++pinNumber) {
+      levels |= (get(pinNumber) ? 1u : 0u) << pinNumber;
+    }
+
+    return levels;
+  }
+
+  bool WiringPiBackend::get(
+      const unsigned int pinNumber) {
+    return ::digitalRead(static_cast<int>(pinNumber)) != 0;
+  }
+
+  int WiringPiBackend::openI2cBus() {
+    // Same as `::wiringPiI2CSetup`, which uses the first I2C bus on revision 1 boards and the second one on all later boards.
+    const std::string i2cDevicePath = (::piBoardRev() == 1 ? "/dev/i2c-0" : "/dev/i2c-1");
+
+    const int handle = ::open(i2cDevicePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (handle < 0) {
+      throw std::runtime_error("WiringPiBackend.openI2cBus: Could not open " + i2cDevicePath + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    return handle;
+  }
+
+  std::string WiringPiBackend::getUartDevicePath() {
+    return "/dev/ttyAMA0";
+  }
+}
+#endif
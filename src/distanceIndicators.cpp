@@ -2,39 +2,112 @@
 
 // C++ standard library
 #include <algorithm>
-#include <bitset>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <ratio>
 #include <stdexcept>
-#include <thread>
+#include <string>
 // IWYU pragma: no_include <ext/alloc_traits.h>
 
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/timing.hpp"
+#include "demonstrator_bits/trace.hpp"
+
 namespace demo {
+  namespace {
+    /**
+     * The LED states of each band, as listed in the class documentation. The lowest LED (red) is stored at bit 0, while the MY9221's two unused outputs (bits 10 and 11) remain off.
+     */
+    constexpr std::array<std::uint16_t, DistanceIndicators::numberOfBands_> patterns = {{
+        0b000000000011,
+        0b000000000010,
+        0b000000000100,
+        0b000000001100,
+        0b000000011100,
+        0b000000111100,
+        0b000001111100,
+        0b000011111100,
+        0b000111111100,
+        0b001111111100}};
+
+    /**
+     * Selects 16 bit grayscale code at 1001 Hz.
+     */
+    const std::uint16_t commandWord = 0x310;
+  }
+
+  constexpr unsigned int DistanceIndicators::numberOfBands_;
+  constexpr std::size_t DistanceIndicators::frameLength_;
+
   DistanceIndicators::DistanceIndicators(
       Pin&& clockPin,
       std::vector<Pin>&& dataPins,
       const double minimalDistance,
       const double warningDistance,
-      const double maximalDistance)
-      : numberOfIndicators_(dataPins.size()),
+      const double maximalDistance,
+      const BoardTimings& boardTimings)
+      : DistanceIndicators(std::move(clockPin), Gpio::allocatePinGroup(std::move(dataPins)), minimalDistance, warningDistance, maximalDistance, boardTimings) {
+  }
+
+  DistanceIndicators::DistanceIndicators(
+      Pin&& clockPin,
+      PinGroup&& dataPins,
+      const double minimalDistance,
+      const double warningDistance,
+      const double maximalDistance,
+      const BoardTimings& boardTimings)
+      : numberOfIndicators_(dataPins.getNumberOfPins()),
         clockPin_(std::move(clockPin)),
         dataPins_(std::move(dataPins)),
+        boardTimings_(boardTimings),
         minimalDistance_(minimalDistance),
         warningDistance_(warningDistance),
-        maximalDistance_(maximalDistance) {
+        maximalDistance_(maximalDistance),
+        bands_(numberOfIndicators_, numberOfBands_),
+        dataPinsMask_(dataPins_.getMask()),
+        frameInterval_(0),
+        killEmissionThread_(false),
+        requestedBands_(numberOfIndicators_),
+        isRefreshRequested_(false),
+        hasPendingRequest_(false),
+        numberOfRequestedFrames_(0),
+        numberOfEmittedFrames_(0),
+        numberOfCoalescedFrames_(0),
+        numberOfPickedUpRequests_(0) {
     if (numberOfIndicators_ == 0) {
       throw std::domain_error("DistanceIndicators: The number of indicators must be greater than 0.");
-    } else if (dataPins_.size() != numberOfIndicators_) {
+    } else if (dataPins_.getNumberOfPins() != numberOfIndicators_) {
       throw std::invalid_argument("DistanceIndicators: The number of data pins must be equal to the number of indicators.");
     }
 
     clockPin_.set(Pin::Digital::Low);
+
+    // The command word is sent on all data pins, most significant bit first.
+    for (std::size_t n = 0; n < 16; ++n) {
+      frame_.at(n) = ((commandWord >> (15 - n)) & 1u) ? dataPinsMask_ : 0;
+    }
+    encodeFrame();
+    emittedFrame_.fill(~dataPinsMask_);
+
+    ::sem_init(&pendingRequest_, 0, 0);
   }
 
   DistanceIndicators::DistanceIndicators(
       DistanceIndicators&& distanceIndicator)
-      : DistanceIndicators(std::move(distanceIndicator.clockPin_), std::move(distanceIndicator.dataPins_), distanceIndicator.minimalDistance_, distanceIndicator.warningDistance_, distanceIndicator.maximalDistance_) {
+      : DistanceIndicators(releaseClockPin(distanceIndicator), std::move(distanceIndicator.dataPins_), distanceIndicator.minimalDistance_, distanceIndicator.warningDistance_, distanceIndicator.maximalDistance_, distanceIndicator.boardTimings_) {
+    bands_ = distanceIndicator.bands_;
+    frame_ = distanceIndicator.frame_;
+    emittedFrame_ = distanceIndicator.emittedFrame_;
+
+    if (distanceIndicator.frameInterval_.count() > 0) {
+      runAsynchronous(distanceIndicator.frameInterval_);
+      distanceIndicator.frameInterval_ = std::chrono::microseconds(0);
+    }
   }
 
   DistanceIndicators& DistanceIndicators::operator=(
@@ -49,69 +122,286 @@ namespace demo {
       throw std::invalid_argument("DistanceIndicators.operator=: The maximal distances values equal.");
     } 
     
-    clockPin_ = std::move(distanceIndicator.clockPin_);
+    stopAsynchronous();
+    clockPin_ = releaseClockPin(distanceIndicator);
     dataPins_ = std::move(distanceIndicator.dataPins_);
+    boardTimings_ = distanceIndicator.boardTimings_;
+    dataPinsMask_ = distanceIndicator.dataPinsMask_;
+    bands_ = distanceIndicator.bands_;
+    frame_ = distanceIndicator.frame_;
+    emittedFrame_ = distanceIndicator.emittedFrame_;
+
+    if (distanceIndicator.frameInterval_.count() > 0) {
+      runAsynchronous(distanceIndicator.frameInterval_);
+      distanceIndicator.frameInterval_ = std::chrono::microseconds(0);
+    }
 
     return *this;
   }
 
+  DistanceIndicators::~DistanceIndicators() {
+    stopEmissionThread();
+    ::sem_destroy(&pendingRequest_);
+  }
+
   void DistanceIndicators::setIndication(
       const arma::Row<double>& distances) {
     if (distances.size() != numberOfIndicators_) {
       throw std::invalid_argument("DistanceIndicators.setIndication: The number of distances must be equal to the number of indicators.");
-    } else if (minimalDistance_ >= warningDistance_) {
+    }
+
+    if (emissionThread_.joinable()) {
+      for (std::size_t n = 0; n < distances.n_elem; ++n) {
+        requestedBands_.at(n).store(getBand(distances(n)), std::memory_order_relaxed);
+      }
+      request();
+      return;
+    }
+
+    numberOfRequestedFrames_.fetch_add(1, std::memory_order_relaxed);
+    bool hasChangedBands = false;
+    for (std::size_t n = 0; n < distances.n_elem; ++n) {
+      const unsigned int band = getBand(distances(n));
+      hasChangedBands |= (band != bands_.at(n));
+      bands_.at(n) = band;
+    }
+
+    if (hasChangedBands) {
+      encodeFrame();
+    }
+
+    if (frame_ != emittedFrame_) {
+      emitIndication();
+    }
+  }
+
+  void DistanceIndicators::setIndication(
+      const std::size_t n,
+      const double distance) {
+    if (n >= numberOfIndicators_) {
+      throw std::out_of_range("DistanceIndicators.setIndication: The indicator number (" + std::to_string(n) + ") must be less than the number of indicators (" + std::to_string(numberOfIndicators_) + ").");
+    }
+
+    const unsigned int band = getBand(distance);
+    if (emissionThread_.joinable()) {
+      requestedBands_.at(n).store(band, std::memory_order_relaxed);
+      request();
+      return;
+    }
+
+    numberOfRequestedFrames_.fetch_add(1, std::memory_order_relaxed);
+    if (band != bands_.at(n)) {
+      bands_.at(n) = band;
+      encodeFrame();
+    }
+
+    if (frame_ != emittedFrame_) {
+      emitIndication();
+    }
+  }
+
+  void DistanceIndicators::refreshIndication() {
+    if (emissionThread_.joinable()) {
+      isRefreshRequested_.store(true, std::memory_order_relaxed);
+      request();
+      return;
+    }
+
+    numberOfRequestedFrames_.fetch_add(1, std::memory_order_relaxed);
+    emitIndication();
+  }
+
+  void DistanceIndicators::runAsynchronous(
+      const std::chrono::microseconds frameInterval) {
+    if (frameInterval.count() <= 0) {
+      throw std::domain_error("DistanceIndicators.runAsynchronous: The frame interval must be greater than 0.");
+    }
+
+    stopEmissionThread();
+    frameInterval_ = frameInterval;
+
+    // Requests for single bars keep the bands of all other bars.
+    for (std::size_t n = 0; n < numberOfIndicators_; ++n) {
+      requestedBands_.at(n).store(bands_.at(n), std::memory_order_relaxed);
+    }
+    isRefreshRequested_ = false;
+    hasPendingRequest_ = false;
+    numberOfPickedUpRequests_ = numberOfRequestedFrames_.load(std::memory_order_relaxed);
+
+    killEmissionThread_ = false;
+    emissionThread_ = std::thread(&DistanceIndicators::emitRequestedFrames, this);
+  }
+
+  void DistanceIndicators::stopAsynchronous() {
+    stopEmissionThread();
+    frameInterval_ = std::chrono::microseconds(0);
+  }
+
+  bool DistanceIndicators::isRunningAsynchronous() const {
+    return emissionThread_.joinable();
+  }
+
+  std::uint64_t DistanceIndicators::getNumberOfRequestedFrames() const {
+    return numberOfRequestedFrames_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t DistanceIndicators::getNumberOfEmittedFrames() const {
+    return numberOfEmittedFrames_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t DistanceIndicators::getNumberOfCoalescedFrames() const {
+    return numberOfCoalescedFrames_.load(std::memory_order_relaxed);
+  }
+
+  unsigned int DistanceIndicators::getBand(
+      const double distance) const {
+    if (minimalDistance_ >= warningDistance_) {
       throw std::logic_error("DistanceIndicators.setIndication: The warning distance must be greater than the minimal one.");
     } else if (warningDistance_ >= maximalDistance_) {
       throw std::logic_error("DistanceIndicators.setIndication: The maximal distance must be greater than the warning distance.");
     }
 
-    const arma::Row<double>& limitedDistances = arma::clamp(distances, minimalDistance_, maximalDistance_);
+    const double limitedDistance = std::max(std::min(distance, maximalDistance_), minimalDistance_);
 
-    // Calculate LED states. The lowest LED (red) is stored at index 0.
-    std::vector<std::bitset<12>> states;
-    for (std::size_t n = 0; n < distances.n_elem; ++n) {
-      const double distance = std::max(std::min(distances.at(n), maximalDistance_), minimalDistance_);
+    if (limitedDistance > warningDistance_) {
+      // Bands 2 to 9 light up 1 to 8 green LEDs.
+      return 1 + static_cast<unsigned int>(std::ceil(8.0 * (limitedDistance - warningDistance_) / (maximalDistance_ - warningDistance_)));
+    } else {
+      return (limitedDistance <= minimalDistance_ ? 0 : 1);
+    }
+  }
 
-      if (distance > warningDistance_) {
-        states.push_back(0b001111111100 & (static_cast<unsigned int>(std::pow(2.0, std::ceil(8.0 * (distance - warningDistance_) / (maximalDistance_ - warningDistance_))) - 1.0) << 2));
-      } else {
-        states.push_back(0b000000000011 & (2 + (distance <= minimalDistance_ ? 1 : 0)));
+  void DistanceIndicators::encodeFrame() {
+    // Each LED is sent as 16 equal bits, starting with the lowest LED. The n-th bar is connected to the n-th pin of the group.
+    for (std::size_t led = 0; led < 12; ++led) {
+      std::uint32_t highPins = 0;
+      for (std::size_t bar = 0; bar < numberOfIndicators_; ++bar) {
+        const std::uint16_t pattern = (bands_.at(bar) < numberOfBands_ ? patterns.at(bands_.at(bar)) : 0);
+        highPins |= static_cast<std::uint32_t>((pattern >> led) & 1u) << dataPins_.getPinNumber(bar);
       }
+
+      std::fill_n(frame_.begin() + static_cast<std::ptrdiff_t>(16 + 16 * led), 16, highPins);
     }
+  }
+
+  void DistanceIndicators::emitIndication() {
+    // Switches the pins to output mode (unless already done) and checks their ownership, before they are written directly.
+    clockPin_.set(Pin::Digital::Low);
+    dataPins_.write(0);
+
+    Backend& backend = Gpio::getBackend();
+    const std::uint32_t clockMask = 1u << clockPin_.getPinNumber();
+    trace::record(trace::Component::Pin, trace::Operation::Transfer, clockPin_.getPinNumber(), static_cast<unsigned int>(frameLength_));
 
-    // Send the `state` patterns to the LED bars. Because all MY9221 are connected to the same clock pin, we need to set all data pins ahead one bit at a time, then clock once. The exact order is:
-    //  1. Send 16 bit command word 0x310 on all pins. This selects 16 bit grayscale code at 1001 Hz.
-    //  2. For every bit in `currentState`, send 16x high (or 16x low, depending on the current bit value) on the respective pin.
-    //  3. Conclude with 4 high/low toggles on the data pins while keeping the clock at a constant level.
-    unsigned int clock = 0;
+    // The MY9221 samples its data on both clock edges.
+    std::uint32_t highPins = 0;
+    for (std::size_t n = 0; n < frameLength_; n += 2) {
+      if (frame_[n] != highPins) {
+        highPins = frame_[n];
+        backend.set(highPins);
+        backend.clear(dataPinsMask_ & ~highPins);
+      }
+      backend.set(clockMask);
 
-    // Step 1: Send command word 0x310. Iterate over the lower 16 bits of that
-    // number and set the data pins accordingly.
-    for (unsigned int i = 16; i > 0; --i) {
-      for (auto& pin : dataPins_) {
-        pin.set(0x310 & (1 << (i - 1)));
+      if (frame_[n + 1] != highPins) {
+        highPins = frame_[n + 1];
+        backend.set(highPins);
+        backend.clear(dataPinsMask_ & ~highPins);
       }
-      clockPin_.set(++clock % 2);
+      backend.clear(clockMask);
+    }
+
+    // Send latch command.
+    timing::wait(boardTimings_.indicatorLatchDelay);
+    const std::uint32_t allDataPins = static_cast<std::uint32_t>((1ull << numberOfIndicators_) - 1);
+    dataPins_.write(0);
+    for (unsigned int i = 0; i < 4; ++i) {
+      dataPins_.write(allDataPins);
+      dataPins_.write(0);
+    }
+
+    emittedFrame_ = frame_;
+    numberOfEmittedFrames_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void DistanceIndicators::request() {
+    // Publishes the mailbox's bands along with the count, pairing with the load in `pickUpRequest()`.
+    numberOfRequestedFrames_.fetch_add(1, std::memory_order_release);
+    if (!hasPendingRequest_.exchange(true, std::memory_order_acq_rel)) {
+      ::sem_post(&pendingRequest_);
+    }
+  }
+
+  bool DistanceIndicators::pickUpRequest() {
+    // Requests after this point wake the emission thread again, while all requests before are read below.
+    hasPendingRequest_.exchange(false, std::memory_order_acq_rel);
+
+    const std::uint64_t numberOfRequests = numberOfRequestedFrames_.load(std::memory_order_acquire);
+    if (numberOfRequests - numberOfPickedUpRequests_ > 1) {
+      numberOfCoalescedFrames_.fetch_add(numberOfRequests - numberOfPickedUpRequests_ - 1, std::memory_order_relaxed);
+    }
+    numberOfPickedUpRequests_ = numberOfRequests;
+
+    bool hasChangedBands = false;
+    for (std::size_t n = 0; n < numberOfIndicators_; ++n) {
+      const unsigned int band = requestedBands_.at(n).load(std::memory_order_relaxed);
+      hasChangedBands |= (band != bands_.at(n));
+      bands_.at(n) = band;
+    }
+
+    if (hasChangedBands) {
+      encodeFrame();
+    }
+
+    if (isRefreshRequested_.exchange(false, std::memory_order_relaxed) || frame_ != emittedFrame_) {
+      emitIndication();
+      return true;
     }
 
-    // Step 2: Send on/off state as 16 bit greyscale values.
-    for (unsigned int led = 0; led < 12; ++led) {
-      for (std::size_t bar = 0; bar < dataPins_.size(); ++bar) {
-        dataPins_.at(bar).set(states.at(bar).test(led));
+    return false;
+  }
+
+  void DistanceIndicators::emitRequestedFrames() {
+    auto nextEmission = std::chrono::steady_clock::now();
+
+    while (true) {
+      // Retries if interrupted by a signal.
+      while (::sem_wait(&pendingRequest_) != 0) {
       }
-      for (unsigned int i = 0; i < 16; ++i) {
-        clockPin_.set(++clock % 2);
+
+      // Bounds the frame rate. Further requests until then are coalesced into this frame.
+      timing::sleepUntil(nextEmission);
+      if (killEmissionThread_) {
+        break;
       }
-    }
 
-    // Step 3: Send latch command.
-    std::this_thread::sleep_for(std::chrono::microseconds(220));
-    for (auto& pin : dataPins_) {
-      pin.set(Pin::Digital::Low);
-      for (unsigned int i = 0; i < 4; ++i) {
-        pin.set(Pin::Digital::High);
-        pin.set(Pin::Digital::Low);
+      try {
+        if (pickUpRequest()) {
+          nextEmission = std::chrono::steady_clock::now() + frameInterval_;
+        }
+      } catch (const std::runtime_error&) {
+        // As the requesting thread already returned, a failed emission only drops this frame.
+        continue;
       }
     }
   }
+
+  void DistanceIndicators::stopEmissionThread() {
+    if (!emissionThread_.joinable()) {
+      return;
+    }
+
+    killEmissionThread_ = true;
+    ::sem_post(&pendingRequest_);
+    emissionThread_.join();
+
+    // Sends the latest request, if the emission thread didn't pick it up anymore. Otherwise, the frame is unchanged and therefore skipped.
+    pickUpRequest();
+  }
+
+  Pin DistanceIndicators::releaseClockPin(
+      DistanceIndicators& distanceIndicators) {
+    distanceIndicators.stopEmissionThread();
+    return std::move(distanceIndicators.clockPin_);
+  }
 }
@@ -0,0 +1,102 @@
+#include "demonstrator_bits/edgeEventSource.hpp"
+#include "demonstrator_bits/config.hpp"
+
+// C++ standard library
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Unix library
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace demo {
+  int EdgeEventSource::getFileDescriptor() const {
+    return -1;
+  }
+
+  GpioChipEdgeEventSource::GpioChipEdgeEventSource(
+      const std::string& gpioChipPath,
+      const unsigned int lineOffset)
+      : fileDescriptor_(-1) {
+    if (::demo::isVerbose) {
+      std::cout << "Requesting edge events for line " << lineOffset << " of " << gpioChipPath << std::endl;
+    }
+
+    int chipFileDescriptor = ::open(gpioChipPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (chipFileDescriptor < 0) {
+      throw std::runtime_error("GpioChipEdgeEventSource: Could not open " + gpioChipPath + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    struct ::gpio_v2_line_request request;
+    std::memset(&request, 0, sizeof(request));
+    request.offsets[0] = lineOffset;
+    request.num_lines = 1;
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    std::strncpy(request.consumer, "demonstrator", sizeof(request.consumer) - 1);
+
+    const int result = ::ioctl(chipFileDescriptor, GPIO_V2_GET_LINE_IOCTL, &request);
+    const int requestError = errno;
+    // The line request stays valid after the chip is closed.
+    ::close(chipFileDescriptor);
+
+    if (result < 0) {
+      throw std::runtime_error("GpioChipEdgeEventSource: Could not request edge events for line " + std::to_string(lineOffset) + ": " + static_cast<std::string>(std::strerror(requestError)));
+    }
+
+    fileDescriptor_ = request.fd;
+  }
+
+  GpioChipEdgeEventSource::~GpioChipEdgeEventSource() {
+    if (fileDescriptor_ != -1) {
+      ::close(fileDescriptor_);
+    }
+  }
+
+  bool GpioChipEdgeEventSource::waitForSignalEdge(
+      const std::chrono::steady_clock::time_point deadline,
+      SignalEdge& signalEdge) {
+    struct ::pollfd pollFileDescriptor;
+    pollFileDescriptor.fd = fileDescriptor_;
+    pollFileDescriptor.events = POLLIN;
+
+    while (true) {
+      const std::chrono::nanoseconds remainingTime = std::max(std::chrono::nanoseconds(0), std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now()));
+      struct ::timespec timeout;
+      timeout.tv_sec = static_cast<decltype(timeout.tv_sec)>(remainingTime.count() / 1000000000);
+      timeout.tv_nsec = static_cast<decltype(timeout.tv_nsec)>(remainingTime.count() % 1000000000);
+
+      // `ppoll` is used instead of `poll`, as the latter only supports a millisecond resolution.
+      const int numberOfReadyFileDescriptors = ::ppoll(&pollFileDescriptor, 1, &timeout, nullptr);
+      if (numberOfReadyFileDescriptors < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+
+        throw std::runtime_error("GpioChipEdgeEventSource.waitForSignalEdge: " + static_cast<std::string>(std::strerror(errno)));
+      } else if (numberOfReadyFileDescriptors == 0) {
+        return false;
+      }
+
+      struct ::gpio_v2_line_event event;
+      if (::read(fileDescriptor_, &event, sizeof(event)) != sizeof(event)) {
+        throw std::runtime_error("GpioChipEdgeEventSource.waitForSignalEdge: Could not read the edge event.");
+      }
+
+      signalEdge.isRising = (event.id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+      signalEdge.timestamp = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(event.timestamp_ns)));
+      return true;
+    }
+  }
+
+  int GpioChipEdgeEventSource::getFileDescriptor() const {
+    return fileDescriptor_;
+  }
+}
@@ -2,14 +2,60 @@
 #include "demonstrator_bits/config.hpp"
 
 // C++ standard library
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 #include <stdexcept>
 
+// Demonstrator
+#if defined(USE_WIRINGPI) && !defined(USE_GPIOMEM)
+#include "demonstrator_bits/backends/wiringPiBackend.hpp"
+#else
+#include "demonstrator_bits/backends/gpioMemBackend.hpp"
+#endif
+
 namespace demo {
   // Sets all elements in `ownedPins_` to false.
   decltype(Gpio::ownedPins_) Gpio::ownedPins_({});
   decltype(Gpio::mutex_) Gpio::mutex_;
+  decltype(Gpio::backend_) Gpio::backend_;
+  decltype(Gpio::currentBackend_) Gpio::currentBackend_(nullptr);
+  decltype(Gpio::backendMutex_) Gpio::backendMutex_;
+
+  void Gpio::setBackend(
+      std::shared_ptr<Backend> backend) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> backendLock(backendMutex_);
+
+    if (!backend) {
+      throw std::invalid_argument("Gpio.setBackend: The backend must not be empty.");
+    } else if (std::any_of(ownedPins_.cbegin(), ownedPins_.cend(), [](const bool isOwned) {return isOwned;})) {
+      throw std::runtime_error("Gpio.setBackend: The backend must not be replaced while pins are allocated.");
+    }
+
+    backend_ = std::move(backend);
+    currentBackend_ = backend_.get();
+  }
+
+  Backend& Gpio::getBackend() {
+    Backend* backend = currentBackend_.load();
+    if (backend == nullptr) {
+      std::lock_guard<std::mutex> backendLock(backendMutex_);
+
+      if (!backend_) {
+#if defined(USE_WIRINGPI) && !defined(USE_GPIOMEM)
+        backend_ = std::make_shared<WiringPiBackend>();
+#else
+        backend_ = std::make_shared<GpioMemBackend>();
+#endif
+        currentBackend_ = backend_.get();
+      }
+
+      backend = backend_.get();
+    }
+
+    return *backend;
+  }
 
   Pin Gpio::allocatePin(
       const unsigned int pinNumber) {
@@ -31,7 +77,39 @@ namespace demo {
     return Pin(pinNumber);
   }
 
+  PinGroup Gpio::allocatePinGroup(
+      std::vector<Pin>&& pins) {
+    if (::demo::isVerbose) {
+      std::cout << "Grouping " << pins.size() << " pins" << std::endl;
+    }
+
+    if (pins.empty()) {
+      throw std::domain_error("Gpio.allocatePinGroup: The pin group must contain at least one pin.");
+    } else if (pins.size() > 32) {
+      throw std::domain_error("Gpio.allocatePinGroup: The pin group must not contain more than 32 pins.");
+    }
+
+    for (const auto& pin : pins) {
+      if (!pin.ownsPin_) {
+        throw std::runtime_error("Gpio.allocatePinGroup: All pins must be owned.");
+      }
+    }
+
+    return PinGroup(std::move(pins));
+  }
+
   Spi Gpio::allocateSpi() {
+    return allocateSpi({});
+  }
+
+  Spi Gpio::allocateSpi(
+      std::vector<Pin>&& chipSelectPins) {
+    for (const auto& chipSelectPin : chipSelectPins) {
+      if (!chipSelectPin.ownsPin_) {
+        throw std::runtime_error("Gpio.allocateSpi: All chip select pins must be owned.");
+      }
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (::demo::isVerbose) {
@@ -50,12 +128,16 @@ namespace demo {
     ownedPins_.at(8) = true;
     ownedPins_.at(9) = true;
 
-    return Spi();
+    return Spi(std::move(chipSelectPins));
   }
 
-  I2c Gpio::allocateI2c() {
+  std::shared_ptr<I2cBus> Gpio::allocateI2cBus() {
     std::lock_guard<std::mutex> lock(mutex_);
 
+    if (::demo::isVerbose) {
+      std::cout << "Allocating I2C pins" << std::endl;
+    }
+
     // The pin number is reduced by 2 as the GPIO pins range from 2 to 27, but the array's indices range from 0 to 25.
     if (ownedPins_.at(0) || ownedPins_.at(1)) {
       throw std::runtime_error("The I2C pins must not already be allocated");
@@ -65,7 +147,12 @@ namespace demo {
     ownedPins_.at(0) = true;
     ownedPins_.at(1) = true;
 
-    return I2c();
+    // The constructor is only accessible to `Gpio`, which rules out `std::make_shared`.
+    return std::shared_ptr<I2cBus>(new I2cBus());
+  }
+
+  I2c Gpio::allocateI2c() {
+    return allocateI2cBus()->getDevice(0x40);
   }
 
   Uart Gpio::allocateUart() {
@@ -120,17 +207,17 @@ namespace demo {
   }
 
   void Gpio::deallocate(
-      I2c& i2c) {
+      I2cBus& i2cBus) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (::demo::isVerbose) {
       std::cout << "Deallocating I2C pins" << std::endl;
     }
 
-    if (i2c.ownsI2c_) {
+    if (i2cBus.ownsI2cBus_) {
       ownedPins_.at(0) = false;
       ownedPins_.at(1) = false;
-      i2c.ownsI2c_ = false;
+      i2cBus.ownsI2cBus_ = false;
     }
   }
 
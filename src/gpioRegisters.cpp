@@ -0,0 +1,133 @@
+#include "demonstrator_bits/gpioRegisters.hpp"
+#include "demonstrator_bits/config.hpp"
+
+// C++ standard library
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// Unix library
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace demo {
+  // Word offsets within the register block, as described in the BCM2835 ARM peripherals data sheet (section 6.1).
+  static const std::size_t GPFSEL0 = 0;
+  static const std::size_t GPSET0 = 7;
+  static const std::size_t GPCLR0 = 10;
+  static const std::size_t GPLEV0 = 13;
+
+  decltype(GpioRegisters::registers_) GpioRegisters::registers_(nullptr);
+  decltype(GpioRegisters::mutex_) GpioRegisters::mutex_;
+
+  void GpioRegisters::map(
+      const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mapUnsynchronised(path);
+  }
+
+  void GpioRegisters::mapUnsynchronised(
+      const std::string& path) {
+    if (::demo::isVerbose) {
+      std::cout << "Mapping GPIO registers from " << path << std::endl;
+    }
+
+    int fileDescriptor = ::open(path.c_str(), O_RDWR | O_SYNC | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+      throw std::runtime_error("GpioRegisters.map: Could not open " + path + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    void* registers = ::mmap(nullptr, MAPPED_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    // The mapping stays valid after the file descriptor is closed.
+    ::close(fileDescriptor);
+
+    if (registers == MAP_FAILED) {
+      throw std::runtime_error("GpioRegisters.map: Could not map " + path + ": " + static_cast<std::string>(std::strerror(errno)));
+    }
+
+    volatile std::uint32_t* previousRegisters = registers_.exchange(static_cast<volatile std::uint32_t*>(registers));
+    if (previousRegisters != nullptr) {
+      ::munmap(const_cast<std::uint32_t*>(previousRegisters), MAPPED_SIZE);
+    }
+  }
+
+  void GpioRegisters::unmap() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    volatile std::uint32_t* previousRegisters = registers_.exchange(nullptr);
+    if (previousRegisters != nullptr) {
+      ::munmap(const_cast<std::uint32_t*>(previousRegisters), MAPPED_SIZE);
+    }
+  }
+
+  bool GpioRegisters::isMapped() {
+    return registers_ != nullptr;
+  }
+
+  void GpioRegisters::setMode(
+      const unsigned int pinNumber,
+      const GpioRegisters::Mode mode) {
+    if (pinNumber > 53) {
+      throw std::domain_error("GpioRegisters.setMode: The pin number must be within [0, 53].");
+    }
+
+    volatile std::uint32_t* registers = getRegisters();
+    // Each function select register holds the 3-bit function of 10 pins.
+    volatile std::uint32_t& functionSelect = registers[GPFSEL0 + pinNumber / 10];
+    const unsigned int shift = (pinNumber % 10) * 3;
+
+    // Most calls don't change the function, so we avoid to lock in this case.
+    if (((functionSelect >> shift) & 0b111) == static_cast<unsigned int>(mode)) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    functionSelect = (functionSelect & ~(0b111u << shift)) | (static_cast<std::uint32_t>(mode) << shift);
+  }
+
+  GpioRegisters::Mode GpioRegisters::getMode(
+      const unsigned int pinNumber) {
+    if (pinNumber > 53) {
+      throw std::domain_error("GpioRegisters.getMode: The pin number must be within [0, 53].");
+    }
+
+    const unsigned int function = (getRegisters()[GPFSEL0 + pinNumber / 10] >> ((pinNumber % 10) * 3)) & 0b111;
+    if (function == static_cast<unsigned int>(Mode::Alternate0)) {
+      return Mode::Alternate0;
+    }
+
+    // Other alternative functions are reported as outputs, as they are driven by some peripheral.
+    return function == 0 ? Mode::Input : Mode::Output;
+  }
+
+  void GpioRegisters::set(
+      const std::uint32_t mask) {
+    getRegisters()[GPSET0] = mask;
+  }
+
+  void GpioRegisters::clear(
+      const std::uint32_t mask) {
+    getRegisters()[GPCLR0] = mask;
+  }
+
+  std::uint32_t GpioRegisters::getLevels() {
+    return getRegisters()[GPLEV0];
+  }
+
+  volatile std::uint32_t* GpioRegisters::getRegisters() {
+    volatile std::uint32_t* registers = registers_.load(std::memory_order_acquire);
+
+    if (registers == nullptr) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Another thread may have mapped the registers while we were waiting for the lock.
+      if (registers_ == nullptr) {
+        mapUnsynchronised("/dev/gpiomem");
+      }
+      registers = registers_;
+    }
+
+    return registers;
+  }
+}
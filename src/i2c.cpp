@@ -2,36 +2,32 @@
 #include "demonstrator_bits/config.hpp"
 
 // C++ standard library
-#include <iostream>
 #include <stdexcept>
-
-// WiringPi
-#include <wiringPiI2C.h>
+#include <utility>
 
 // Demonstrator
-#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/trace.hpp"
 
 namespace demo {
-  I2c::I2c()
-      : fileDescriptor_(::wiringPiI2CSetup(0x40)),
+  I2c::I2c(
+      std::shared_ptr<I2cBus> bus,
+      const unsigned int address)
+      : bus_(std::move(bus)),
+        address_(address),
         ownsI2c_(true) {
-    if (fileDescriptor_ < 0) {
-      throw std::runtime_error("I2c: Could not connect to the I2C device.");
-    }
   }
 
   I2c::I2c(I2c&& other)
-      : fileDescriptor_(other.fileDescriptor_),
+      : bus_(std::move(other.bus_)),
+        address_(other.address_),
         ownsI2c_(other.ownsI2c_) {
     other.ownsI2c_ = false;
   }
 
   I2c& I2c::operator=(I2c&& other) {
-    if (ownsI2c_) {
-      Gpio::deallocate(*this);
-    }
-
-    fileDescriptor_ = other.fileDescriptor_,
+    // Releases the previous bus, which is deallocated if this was its last device.
+    bus_ = std::move(other.bus_);
+    address_ = other.address_;
     ownsI2c_ = other.ownsI2c_;
 
     other.ownsI2c_ = false;
@@ -41,39 +37,62 @@ namespace demo {
   void I2c::set(
       const unsigned int registerNumber,
       const unsigned int value) {
-    if (::demo::isVerbose) {
-      std::cout << "Setting register " << registerNumber << " to " << value << std::endl;
+    trace::record(trace::Component::I2c, trace::Operation::Set, registerNumber, value);
+
+    if (!ownsI2c_) {
+      throw std::runtime_error("I2C must be owned to be accessed.");
     }
 
+    const std::uint8_t byte = static_cast<std::uint8_t>(value);
+    bus_->write(address_, registerNumber, &byte, 1, I2cBus::Priority::Routine);
+  }
+
+  void I2c::set(
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues,
+      const I2cBus::Priority priority) {
+    trace::record(trace::Component::I2c, trace::Operation::Transfer, firstRegisterNumber, static_cast<unsigned int>(numberOfValues));
+
     if (!ownsI2c_) {
       throw std::runtime_error("I2C must be owned to be accessed.");
     }
 
-    ::wiringPiI2CWriteReg8(fileDescriptor_, static_cast<int>(registerNumber), static_cast<int>(value));
+    bus_->write(address_, firstRegisterNumber, values, numberOfValues, priority);
   }
 
-  unsigned int I2c::get(
-      const unsigned int registerNumber) {
-    if (::demo::isVerbose) {
-      std::cout << "Reading register " << registerNumber << ". ";
+  bool I2c::trySet(
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues,
+      const I2cBus::Priority priority) noexcept {
+    if (!ownsI2c_) {
+      return false;
     }
 
+    return bus_->tryWrite(address_, firstRegisterNumber, values, numberOfValues, priority);
+  }
+
+  unsigned int I2c::get(
+      const unsigned int registerNumber) {
     if (!ownsI2c_) {
       throw std::runtime_error("I2C must be owned to be accessed.");
     }
 
-    unsigned int output = static_cast<unsigned int>(::wiringPiI2CReadReg8(fileDescriptor_, static_cast<int>(registerNumber)));
+    unsigned int output = bus_->read(address_, registerNumber);
+    trace::record(trace::Component::I2c, trace::Operation::Get, registerNumber, output);
+
+    return output;
+  }
 
-    if (::demo::isVerbose) {
-      std::cout << "Received " << output << "." << std::endl;
+  void I2c::flush() {
+    if (!ownsI2c_) {
+      throw std::runtime_error("I2C must be owned to be accessed.");
     }
 
-    return output;
+    bus_->flush();
   }
 
   I2c::~I2c() {
-    if (ownsI2c_) {
-      Gpio::deallocate(*this);
-    }
   }
 }
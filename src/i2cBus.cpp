@@ -0,0 +1,278 @@
+#include "demonstrator_bits/i2cBus.hpp"
+
+// C++ standard library
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Demonstrator
+#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/i2c.hpp"
+
+namespace demo {
+  I2cBus::TransactionQueue::TransactionQueue()
+      : pushPosition_(0),
+        popPosition_(0) {
+    for (std::size_t n = 0; n < cells_.size(); ++n) {
+      cells_.at(n).sequence = n;
+    }
+  }
+
+  bool I2cBus::TransactionQueue::push(
+      const Transaction& transaction) noexcept {
+    std::size_t position = pushPosition_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position % QUEUE_CAPACITY];
+      const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+      if (sequence == position) {
+        // Claims the cell. On failure, `position` is updated to the current push position.
+        if (pushPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.transaction = transaction;
+          // Publishes the transaction to the bus thread.
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        // The cell still holds the transaction pushed one round earlier.
+        return false;
+      } else {
+        position = pushPosition_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool I2cBus::TransactionQueue::pop(
+      Transaction& transaction) {
+    Cell& cell = cells_[popPosition_ % QUEUE_CAPACITY];
+    if (cell.sequence.load(std::memory_order_acquire) != popPosition_ + 1) {
+      return false;
+    }
+
+    transaction = cell.transaction;
+    // Frees the cell for the next round.
+    cell.sequence.store(popPosition_ + QUEUE_CAPACITY, std::memory_order_release);
+    ++popPosition_;
+
+    return true;
+  }
+
+  I2cBus::I2cBus()
+      : handle_(Gpio::getBackend().openI2cBus()),
+        ownsI2cBus_(true),
+        isRunningAsynchronous_(false),
+        killBusThread_(false),
+        numberOfFailedWrites_(0),
+        numberOfSubmittedWrites_(0) {
+    stopWriteNumbers_.fill(0);
+    ::sem_init(&numberOfPendingTransactions_, 0, 0);
+  }
+
+  I2c I2cBus::getDevice(
+      const unsigned int address) {
+    if (address < 0x03 || address > 0x77) {
+      throw std::domain_error("I2cBus.getDevice: The address must be within [3, 119].");
+    }
+
+    return I2c(shared_from_this(), address);
+  }
+
+  void I2cBus::runAsynchronous() {
+    if (busThread_.joinable()) {
+      return;
+    }
+
+    killBusThread_ = false;
+    busThread_ = std::thread(&I2cBus::drain, this);
+    isRunningAsynchronous_ = true;
+  }
+
+  void I2cBus::stopAsynchronous() {
+    if (!busThread_.joinable()) {
+      return;
+    }
+
+    flush();
+    isRunningAsynchronous_ = false;
+
+    killBusThread_ = true;
+    ::sem_post(&numberOfPendingTransactions_);
+    busThread_.join();
+  }
+
+  bool I2cBus::isRunningAsynchronous() const {
+    return isRunningAsynchronous_;
+  }
+
+  void I2cBus::flush() {
+    if (!isRunningAsynchronous_) {
+      return;
+    }
+
+    Transaction transaction;
+    transaction.type = Transaction::Type::Flush;
+    submitAndWait(transaction);
+  }
+
+  std::uint64_t I2cBus::getNumberOfFailedWrites() const {
+    return numberOfFailedWrites_.load(std::memory_order_relaxed);
+  }
+
+  I2cBus::~I2cBus() {
+    stopAsynchronous();
+
+    if (ownsI2cBus_) {
+      Gpio::getBackend().closeI2cBus(handle_);
+      Gpio::deallocate(*this);
+    }
+
+    ::sem_destroy(&numberOfPendingTransactions_);
+  }
+
+  void I2cBus::write(
+      const unsigned int address,
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues,
+      const Priority priority) {
+    if (numberOfValues > Backend::MAXIMAL_NUMBER_OF_I2C_VALUES) {
+      throw std::invalid_argument("I2cBus.write: The number of values must not be greater than " + std::to_string(Backend::MAXIMAL_NUMBER_OF_I2C_VALUES) + ".");
+    }
+
+    if (!isRunningAsynchronous_) {
+      Gpio::getBackend().setI2cRegisters(handle_, address, firstRegisterNumber, values, numberOfValues);
+      return;
+    }
+
+    // A full queue means that the bus can't keep up, so the caller has to wait after all.
+    while (!tryWrite(address, firstRegisterNumber, values, numberOfValues, priority)) {
+      std::this_thread::yield();
+    }
+  }
+
+  bool I2cBus::tryWrite(
+      const unsigned int address,
+      const unsigned int firstRegisterNumber,
+      const std::uint8_t* values,
+      const std::size_t numberOfValues,
+      const Priority priority) noexcept {
+    if (numberOfValues > Backend::MAXIMAL_NUMBER_OF_I2C_VALUES) {
+      return false;
+    }
+
+    if (!isRunningAsynchronous_) {
+      return Gpio::getBackend().trySetI2cRegisters(handle_, address, firstRegisterNumber, values, numberOfValues);
+    }
+
+    Transaction transaction;
+    transaction.type = Transaction::Type::Write;
+    transaction.priority = priority;
+    transaction.number = numberOfSubmittedWrites_.fetch_add(1) + 1;
+    transaction.address = address;
+    transaction.firstRegisterNumber = firstRegisterNumber;
+    std::copy(values, values + numberOfValues, transaction.values.begin());
+    transaction.numberOfValues = numberOfValues;
+
+    if (!queues_[static_cast<std::size_t>(priority)].push(transaction)) {
+      return false;
+    }
+    ::sem_post(&numberOfPendingTransactions_);
+
+    return true;
+  }
+
+  unsigned int I2cBus::read(
+      const unsigned int address,
+      const unsigned int registerNumber) {
+    if (!isRunningAsynchronous_) {
+      return Gpio::getBackend().getI2cRegister(handle_, address, registerNumber);
+    }
+
+    unsigned int value = 0;
+    bool hasFailed = false;
+
+    Transaction transaction;
+    transaction.type = Transaction::Type::Read;
+    transaction.address = address;
+    transaction.firstRegisterNumber = registerNumber;
+    transaction.readValue = &value;
+    transaction.hasFailed = &hasFailed;
+    submitAndWait(transaction);
+
+    if (hasFailed) {
+      throw std::runtime_error("I2cBus.read: Could not read from the I2C slave at address " + std::to_string(address) + ".");
+    }
+
+    return value;
+  }
+
+  void I2cBus::submitAndWait(
+      Transaction& transaction) {
+    ::sem_t completion;
+    ::sem_init(&completion, 0, 0);
+    transaction.completion = &completion;
+
+    // The calling thread waits for the result anyway, so there is no point in failing on a full queue.
+    while (!queues_.at(static_cast<std::size_t>(Priority::Routine)).push(transaction)) {
+      std::this_thread::yield();
+    }
+    ::sem_post(&numberOfPendingTransactions_);
+
+    // Retries if interrupted by a signal.
+    while (::sem_wait(&completion) != 0) {
+    }
+    ::sem_destroy(&completion);
+  }
+
+  void I2cBus::execute(
+      const Transaction& transaction) {
+    switch (transaction.type) {
+      case Transaction::Type::Write: {
+          std::uint64_t& stopWriteNumber = stopWriteNumbers_.at(transaction.address);
+          if (transaction.priority == Priority::Stop) {
+            stopWriteNumber = std::max(stopWriteNumber, transaction.number);
+          } else if (transaction.number < stopWriteNumber) {
+            break;
+          }
+
+          try {
+            Gpio::getBackend().setI2cRegisters(handle_, transaction.address, transaction.firstRegisterNumber, transaction.values.data(), transaction.numberOfValues);
+          } catch (const std::runtime_error&) {
+            numberOfFailedWrites_.fetch_add(1, std::memory_order_relaxed);
+          }
+        } break;
+      case Transaction::Type::Read: {
+          try {
+            *transaction.readValue = Gpio::getBackend().getI2cRegister(handle_, transaction.address, transaction.firstRegisterNumber);
+          } catch (const std::runtime_error&) {
+            *transaction.hasFailed = true;
+          }
+          ::sem_post(transaction.completion);
+        } break;
+      case Transaction::Type::Flush: {
+          ::sem_post(transaction.completion);
+        } break;
+    }
+  }
+
+  void I2cBus::drain() {
+    Transaction transaction;
+
+    while (true) {
+      // Retries if interrupted by a signal.
+      while (::sem_wait(&numberOfPendingTransactions_) != 0) {
+      }
+
+      if (killBusThread_) {
+        break;
+      }
+
+      // Stop writes preempt all pending routine transactions. If both queues appear empty, a producer was interrupted between claiming and publishing its cell, and will finish shortly.
+      while (!queues_.at(static_cast<std::size_t>(Priority::Stop)).pop(transaction) && !queues_.at(static_cast<std::size_t>(Priority::Routine)).pop(transaction)) {
+        std::this_thread::yield();
+      }
+
+      execute(transaction);
+    }
+  }
+}
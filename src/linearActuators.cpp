@@ -8,7 +8,17 @@
 #include <stdexcept>
 #include <vector>
 
+// Demonstrator
+#include "demonstrator_bits/timing.hpp"
+
 namespace demo {
+  namespace {
+    /**
+     * The PCA9685 sets its duty cycles in 4096 steps, as `4095 * speed`, rounded down (see `ServoControllers::run`).
+     */
+    const double dutyCycleSteps = 4095.0;
+  }
+
   LinearActuators::LinearActuators(
       ServoControllers&& servoControllers,
       ExtensionSensors&& extensionSensors,
@@ -24,12 +34,18 @@ namespace demo {
     }
     
     setAcceptableExtensionDeviation(0.0);
+    setControllerGains(150.0, 5.0, 0.0);
+    setControlInterval(std::chrono::milliseconds(10));
+    setMaximalAcceleration(10.0);
   }
 
   LinearActuators::LinearActuators(
       LinearActuators&& linearActuators)
       : LinearActuators(std::move(linearActuators.servoControllers_), std::move(linearActuators.extensionSensors_), linearActuators.minimalAllowedExtension_, linearActuators.maximalAllowedExtension_) {
     setAcceptableExtensionDeviation(linearActuators.acceptableExtensionDeviation_);
+    setControllerGains(linearActuators.proportionalGain_, linearActuators.integralGain_, linearActuators.derivativeGain_);
+    setControlInterval(linearActuators.controlInterval_);
+    setMaximalAcceleration(linearActuators.maximalAcceleration_);
   }
 
   LinearActuators& LinearActuators::operator=(
@@ -46,6 +62,9 @@ namespace demo {
     extensionSensors_ = std::move(linearActuators.extensionSensors_);
     
     setAcceptableExtensionDeviation(linearActuators.acceptableExtensionDeviation_);
+    setControllerGains(linearActuators.proportionalGain_, linearActuators.integralGain_, linearActuators.derivativeGain_);
+    setControlInterval(linearActuators.controlInterval_);
+    setMaximalAcceleration(linearActuators.maximalAcceleration_);
 
     return *this;
   }
@@ -65,8 +84,16 @@ namespace demo {
       reachExtensionThread_.join();
     }
     
+    ControlParameters parameters;
+    parameters.acceptableExtensionDeviation = acceptableExtensionDeviation_;
+    parameters.proportionalGain = proportionalGain_;
+    parameters.integralGain = integralGain_;
+    parameters.derivativeGain = derivativeGain_;
+    parameters.controlInterval = controlInterval_;
+    parameters.maximalAcceleration = maximalAcceleration_;
+
     killReachExtensionThread_ = false;
-    reachExtensionThread_ = std::thread(&LinearActuators::reachExtension, this, extensions, speeds);
+    reachExtensionThread_ = std::thread(&LinearActuators::reachExtension, this, extensions, speeds, parameters);
   }
 
   arma::Row<double> LinearActuators::getExtensions() {
@@ -75,35 +102,72 @@ namespace demo {
 
   void LinearActuators::reachExtension(
       const arma::Row<double>& extensions,
-      const arma::Row<double>& maximalSpeeds) {
-    arma::Row<double> limitedExtensions = arma::clamp(extensions, minimalAllowedExtension_, maximalAllowedExtension_);
-    arma::Row<double> currentExtension = extensionSensors_.measure();
+      const arma::Row<double>& maximalSpeeds,
+      const ControlParameters& parameters) {
+    const arma::Row<double>& limitedExtensions = arma::clamp(extensions, minimalAllowedExtension_, maximalAllowedExtension_);
+    const arma::Row<double>& limitedMaximalSpeeds = arma::clamp(maximalSpeeds, 0.0, 1.0);
+
+    // The state of each actuator's controller. Positive speeds extend the actuator.
+    arma::Row<double> integrals(numberOfActuators_, arma::fill::zeros);
+    arma::Row<double> speeds(numberOfActuators_, arma::fill::zeros);
+    std::vector<bool> forwards(numberOfActuators_, true);
 
-    bool hasReachedPosition = arma::all(arma::abs(limitedExtensions - currentExtension) <= acceptableExtensionDeviation_);
+    arma::Row<double> currentExtensions = extensionSensors_.measure();
+    arma::Row<double> previousExtensions = currentExtensions;
+    // The first iteration assumes a regular interval since the (virtual) previous measurement.
+    auto measurementTime = std::chrono::steady_clock::now();
+    auto previousMeasurementTime = measurementTime - parameters.controlInterval;
+    auto deadline = measurementTime;
+
+    while (!killReachExtensionThread_) {
+      const arma::Row<double>& errors = limitedExtensions - currentExtensions;
+      if (arma::all(arma::abs(errors) <= parameters.acceptableExtensionDeviation)) {
+        break;
+      }
+
+      const double elapsedTime = std::chrono::duration<double>(measurementTime - previousMeasurementTime).count();
+      // An infinite acceleration must not be multiplied by a zero interval.
+      const double maximalSpeedChange = (std::isinf(parameters.maximalAcceleration) ? parameters.maximalAcceleration : parameters.maximalAcceleration * elapsedTime);
 
-    std::vector<bool> forwards(numberOfActuators_, false);
-    arma::Row<double> speeds = maximalSpeeds;
-    while (!hasReachedPosition && !killReachExtensionThread_) {
-      const arma::Row<double>& deviations = currentExtension - limitedExtensions;
       for (std::size_t n = 0; n < numberOfActuators_; ++n) {
-        if (std::abs(deviations(n)) <= acceptableExtensionDeviation_) {
+        if (std::abs(errors(n)) <= parameters.acceptableExtensionDeviation) {
+          // Holds the actuator within the deadband, without integrating the (noisy) remaining error.
           speeds(n) = 0.0;
-        } else {
-          speeds(n) = maximalSpeeds(n);
-
-          if (deviations(n) > 0) {
-            forwards.at(n) = false;
-          } else {
-            forwards.at(n) = true;
-          }
+          continue;
+        }
+
+        const double integral = integrals(n) + errors(n) * elapsedTime;
+        const double velocity = (currentExtensions(n) - previousExtensions(n)) / elapsedTime;
+        const double unlimitedSpeed = parameters.proportionalGain * errors(n) + parameters.integralGain * integral - parameters.derivativeGain * velocity;
+
+        // Ramps towards the requested speed and cuts it off at the plateau.
+        double speed = std::min(std::max(unlimitedSpeed, speeds(n) - maximalSpeedChange), speeds(n) + maximalSpeedChange);
+        speed = std::min(std::max(speed, -limitedMaximalSpeeds(n)), limitedMaximalSpeeds(n));
+        speed = std::copysign(std::floor(std::abs(speed) * dutyCycleSteps) / dutyCycleSteps, speed);
+
+        // Speeds below a single duty cycle step are rounded to 0, which is left to the integral term.
+        if (std::abs(speed - unlimitedSpeed) < 1.0 / dutyCycleSteps || errors(n) * integrals(n) < 0) {
+          integrals(n) = integral;
+        }
+
+        speeds(n) = speed;
+        if (speed != 0.0) {
+          forwards.at(n) = speed > 0.0;
         }
       }
 
-      servoControllers_.run(forwards, speeds);
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      currentExtension = extensionSensors_.measure();
+      servoControllers_.run(forwards, arma::abs(speeds));
 
-      hasReachedPosition = arma::all(arma::abs(limitedExtensions - currentExtension) <= acceptableExtensionDeviation_);
+      deadline += parameters.controlInterval;
+      timing::sleepUntil(deadline);
+      if (std::chrono::steady_clock::now() - deadline >= parameters.controlInterval) {
+        deadline = std::chrono::steady_clock::now();
+      }
+
+      previousExtensions = currentExtensions;
+      previousMeasurementTime = measurementTime;
+      currentExtensions = extensionSensors_.measure();
+      measurementTime = std::chrono::steady_clock::now();
     }
 
     servoControllers_.stop();
@@ -137,4 +201,58 @@ namespace demo {
   double LinearActuators::getMaximalExtensionDeviation() const {
     return acceptableExtensionDeviation_;
   }
+
+  void LinearActuators::setControllerGains(
+      const double proportionalGain,
+      const double integralGain,
+      const double derivativeGain) {
+    if (!std::isfinite(proportionalGain) || !std::isfinite(integralGain) || !std::isfinite(derivativeGain)) {
+      throw std::domain_error("LinearActuators.setControllerGains: The gains must be finite.");
+    } else if (proportionalGain < 0 || integralGain < 0 || derivativeGain < 0) {
+      throw std::domain_error("LinearActuators.setControllerGains: The gains must be positive (or 0).");
+    }
+
+    proportionalGain_ = proportionalGain;
+    integralGain_ = integralGain;
+    derivativeGain_ = derivativeGain;
+  }
+
+  double LinearActuators::getProportionalGain() const {
+    return proportionalGain_;
+  }
+
+  double LinearActuators::getIntegralGain() const {
+    return integralGain_;
+  }
+
+  double LinearActuators::getDerivativeGain() const {
+    return derivativeGain_;
+  }
+
+  void LinearActuators::setControlInterval(
+      const std::chrono::microseconds controlInterval) {
+    if (controlInterval.count() <= 0) {
+      throw std::domain_error("LinearActuators.setControlInterval: The control interval must be greater than 0.");
+    }
+
+    controlInterval_ = controlInterval;
+  }
+
+  std::chrono::microseconds LinearActuators::getControlInterval() const {
+    return controlInterval_;
+  }
+
+  void LinearActuators::setMaximalAcceleration(
+      const double maximalAcceleration) {
+    // Also rejects NaN.
+    if (!(maximalAcceleration > 0)) {
+      throw std::domain_error("LinearActuators.setMaximalAcceleration: The maximal acceleration must be greater than 0.");
+    }
+
+    maximalAcceleration_ = maximalAcceleration;
+  }
+
+  double LinearActuators::getMaximalAcceleration() const {
+    return maximalAcceleration_;
+  }
 }
@@ -2,16 +2,15 @@
 #include "demonstrator_bits/config.hpp"
 
 // C++ standard library
-#include <iostream>
+#include <algorithm>
 #include <ratio>
 #include <stdexcept>
 #include <thread>
 
-// WiringPi
-#include <wiringPi.h>
-
 // Demonstrator
+#include "demonstrator_bits/backend.hpp"
 #include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/trace.hpp"
 
 namespace demo {
   Pin::Pin(
@@ -21,7 +20,8 @@ namespace demo {
 
   Pin::Pin(Pin&& other)
       : pinNumber_(other.pinNumber_),
-        ownsPin_(other.ownsPin_) {
+        ownsPin_(other.ownsPin_),
+        edgeEventSource_(std::move(other.edgeEventSource_)) {
     other.ownsPin_ = false;
   }
 
@@ -32,6 +32,7 @@ namespace demo {
 
     pinNumber_ = other.pinNumber_;
     ownsPin_ = other.ownsPin_;
+    edgeEventSource_ = std::move(other.edgeEventSource_);
 
     other.ownsPin_ = false;
     return *this;
@@ -39,16 +40,19 @@ namespace demo {
 
   void Pin::set(
       const Pin::Digital value) {
-    if (::demo::isVerbose) {
-      std::cout << "Setting pin " << pinNumber_ << " to " << static_cast<unsigned int>(value) << std::endl;
-    }
+    trace::record(trace::Component::Pin, trace::Operation::Set, pinNumber_, static_cast<unsigned int>(value));
 
     if (!ownsPin_) {
       throw std::runtime_error("The pin must be owned to be accessed.");
     }
 
-    ::pinMode(static_cast<int>(pinNumber_), OUTPUT);
-    ::digitalWrite(static_cast<int>(pinNumber_), static_cast<int>(value));
+    Backend& backend = Gpio::getBackend();
+    backend.setMode(pinNumber_, Backend::Mode::Output);
+    if (value == Digital::High) {
+      backend.set(1u << pinNumber_);
+    } else {
+      backend.clear(1u << pinNumber_);
+    }
   }
 
   void Pin::set(
@@ -57,65 +61,107 @@ namespace demo {
   }
 
   Pin::Digital Pin::get() {
-    if (::demo::isVerbose) {
-      std::cout << "Reading pin " << pinNumber_ << ". ";
-    }
-
     if (!ownsPin_) {
       throw std::runtime_error("The pin must be owned to be accessed.");
     }
 
-    ::pinMode(static_cast<int>(pinNumber_), INPUT);
-    Digital output = (::digitalRead(static_cast<int>(pinNumber_)) == 0 ? Digital::Low : Digital::High);
-
-    if (::demo::isVerbose) {
-      std::cout << "Received " << static_cast<unsigned int>(output) << "." << std::endl;
-    }
+    Digital output = readSignal();
+    trace::record(trace::Component::Pin, trace::Operation::Get, pinNumber_, static_cast<unsigned int>(output));
 
     return output;
   }
 
   std::chrono::microseconds Pin::waitForSignalEdge(
       const std::chrono::microseconds timeout) {
-    if (::demo::isVerbose) {
-      std::cout << "Waiting for signal edge on pin " << pinNumber_ << ". ";
+    auto start = std::chrono::steady_clock::now();
+
+    SignalEdge signalEdge;
+    if (!captureSignalEdge(timeout, start, signalEdge)) {
+      return timeout;
     }
 
+    return std::max(std::chrono::microseconds(0), std::chrono::duration_cast<std::chrono::microseconds>(signalEdge.timestamp - start));
+  }
+
+  bool Pin::captureSignalEdge(
+      const std::chrono::microseconds timeout,
+      const std::chrono::steady_clock::time_point since,
+      SignalEdge& signalEdge) {
+    trace::record(trace::Component::Pin, trace::Operation::WaitForSignalEdge, pinNumber_, static_cast<unsigned int>(timeout.count()));
+
     if (!ownsPin_) {
       throw std::runtime_error("The pin must be owned to be accessed.");
     }
 
-    // Hard deactivates verbosity, as the following commands may spam the console to much, especially if the time-out is reached.
-    bool wasVerbose = ::demo::isVerbose;
-    ::demo::isVerbose = false;
-
-    Digital currentSignal = get();
+    // The signal is read without any trace records, as these would flood the rings, especially if the time-out is reached.
+    const Digital currentSignal = readSignal();
 
     auto start = std::chrono::steady_clock::now();
-    auto end = std::chrono::steady_clock::now();
-    while (get() == currentSignal) {
-      std::this_thread::sleep_for(std::chrono::nanoseconds(500));
-      end = std::chrono::steady_clock::now();
-
-      if (end - start >= timeout) {
-        ::demo::isVerbose = wasVerbose;
-        if (::demo::isVerbose) {
-          std::cout << "Timeout." << std::endl;
+    bool hasCapturedSignalEdge = false;
+    if (edgeEventSource_) {
+      // Skips all queued edges that are older than `since`, e.g. edges caused by previously writing to this pin.
+      while (edgeEventSource_->waitForSignalEdge(start + timeout, signalEdge)) {
+        if (signalEdge.timestamp >= since) {
+          hasCapturedSignalEdge = true;
+          break;
+        }
+      }
+    } else {
+      auto end = std::chrono::steady_clock::now();
+      while (end - start < timeout) {
+        const Digital signal = readSignal();
+        end = std::chrono::steady_clock::now();
+
+        if (signal != currentSignal) {
+          signalEdge.isRising = (signal == Digital::High);
+          signalEdge.timestamp = end;
+          hasCapturedSignalEdge = true;
+          break;
         }
 
-        return timeout;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(500));
       }
     }
 
-    std::chrono::microseconds duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    if (hasCapturedSignalEdge) {
+      trace::record(trace::Component::Pin, trace::Operation::SignalEdge, pinNumber_, signalEdge.isRising ? 1 : 0);
+    } else {
+      trace::record(trace::Component::Pin, trace::Operation::Timeout, pinNumber_, 0);
+    }
+
+    return hasCapturedSignalEdge;
+  }
+
+  void Pin::setEdgeEventSource(
+      std::unique_ptr<EdgeEventSource> edgeEventSource) {
+    if (!ownsPin_) {
+      throw std::runtime_error("The pin must be owned to be accessed.");
+    }
+
+    edgeEventSource_ = std::move(edgeEventSource);
+  }
+
+  void Pin::useGpioChipEdgeEvents(
+      const std::string& gpioChipPath) {
+    setEdgeEventSource(std::unique_ptr<EdgeEventSource>(new GpioChipEdgeEventSource(gpioChipPath, pinNumber_)));
+  }
 
-    // Restore verbosity
-    ::demo::isVerbose = wasVerbose;
-    if (::demo::isVerbose) {
-      std::cout << "Took " << duration.count() << "us." << std::endl;
+  unsigned int Pin::getPinNumber() const {
+    if (!ownsPin_) {
+      throw std::runtime_error("The pin must be owned to be accessed.");
     }
 
-    return duration;
+    return pinNumber_;
+  }
+
+  EdgeEventSource* Pin::getEdgeEventSource() {
+    return edgeEventSource_.get();
+  }
+
+  Pin::Digital Pin::readSignal() {
+    Backend& backend = Gpio::getBackend();
+    backend.setMode(pinNumber_, Backend::Mode::Input);
+    return (backend.get(pinNumber_) ? Digital::High : Digital::Low);
   }
 
   Pin::~Pin() {
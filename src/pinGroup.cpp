@@ -0,0 +1,116 @@
+#include "demonstrator_bits/pinGroup.hpp"
+#include "demonstrator_bits/config.hpp"
+
+// C++ standard library
+#include <stdexcept>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/trace.hpp"
+
+namespace demo {
+  PinGroup::PinGroup(
+      std::vector<Pin>&& pins)
+      : pins_(std::move(pins)),
+        pinsMask_(0),
+        isOutput_(false),
+        isInput_(false),
+        ownsPins_(true) {
+    for (const auto& pin : pins_) {
+      pinsMask_ |= 1u << pin.pinNumber_;
+    }
+  }
+
+  PinGroup::PinGroup(PinGroup&& other)
+      : pins_(std::move(other.pins_)),
+        pinsMask_(other.pinsMask_),
+        isOutput_(other.isOutput_),
+        isInput_(other.isInput_),
+        ownsPins_(other.ownsPins_) {
+    other.ownsPins_ = false;
+  }
+
+  PinGroup& PinGroup::operator=(PinGroup&& other) {
+    // The previously owned pins are deallocated by their destructors.
+    pins_ = std::move(other.pins_);
+    pinsMask_ = other.pinsMask_;
+    isOutput_ = other.isOutput_;
+    isInput_ = other.isInput_;
+    ownsPins_ = other.ownsPins_;
+
+    other.ownsPins_ = false;
+    return *this;
+  }
+
+  void PinGroup::write(
+      const std::uint32_t bitmask) {
+    if (!ownsPins_) {
+      throw std::runtime_error("The pin group must be owned to be accessed.");
+    }
+
+    Backend& backend = Gpio::getBackend();
+    if (!isOutput_) {
+      for (const auto& pin : pins_) {
+        backend.setMode(pin.pinNumber_, Backend::Mode::Output);
+      }
+      isOutput_ = true;
+      isInput_ = false;
+    }
+
+    std::uint32_t highPins = 0;
+    for (std::size_t n = 0; n < pins_.size(); ++n) {
+      highPins |= ((bitmask >> n) & 1u) << pins_[n].pinNumber_;
+    }
+
+    backend.set(highPins);
+    backend.clear(pinsMask_ & ~highPins);
+    trace::record(trace::Component::PinGroup, trace::Operation::Set, pinsMask_, bitmask);
+  }
+
+  std::uint32_t PinGroup::read() {
+    if (!ownsPins_) {
+      throw std::runtime_error("The pin group must be owned to be accessed.");
+    }
+
+    std::uint32_t output = 0;
+    Backend& backend = Gpio::getBackend();
+    if (!isInput_) {
+      for (const auto& pin : pins_) {
+        backend.setMode(pin.pinNumber_, Backend::Mode::Input);
+      }
+      isInput_ = true;
+      isOutput_ = false;
+    }
+
+    const std::uint32_t levels = backend.getLevels();
+    for (std::size_t n = 0; n < pins_.size(); ++n) {
+      output |= ((levels >> pins_[n].pinNumber_) & 1u) << n;
+    }
+
+    trace::record(trace::Component::PinGroup, trace::Operation::Get, pinsMask_, output);
+
+    return output;
+  }
+
+  std::size_t PinGroup::getNumberOfPins() const {
+    return pins_.size();
+  }
+
+  std::uint32_t PinGroup::getMask() const {
+    if (!ownsPins_) {
+      throw std::runtime_error("The pin group must be owned to be accessed.");
+    }
+
+    return pinsMask_;
+  }
+
+  unsigned int PinGroup::getPinNumber(
+      const std::size_t n) const {
+    if (!ownsPins_) {
+      throw std::runtime_error("The pin group must be owned to be accessed.");
+    }
+
+    return pins_.at(n).pinNumber_;
+  }
+}
@@ -0,0 +1,214 @@
+#include "demonstrator_bits/sensorScheduler.hpp"
+
+// C++ standard library
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Demonstrator
+#include "demonstrator_bits/timing.hpp"
+
+namespace demo {
+  SensorScheduler::Slot::Slot(
+      Sensors& sensors,
+      const std::chrono::steady_clock::duration measurementInterval)
+      : sensors(sensors),
+        measurementInterval(measurementInterval),
+        measurement(sensors.numberOfSensors_),
+        measurementBegun(0),
+        measurementCompleted(0),
+        numberOfOverruns(0),
+        numberOfFailedMeasurements(0),
+        maximalLateness(0) {
+    for (std::size_t k = 0; k < measurements.size(); ++k) {
+      measurements.at(k).reset(new std::atomic<double>[sensors.numberOfSensors_]);
+      measurementTimes.at(k) = 0;
+    }
+  }
+
+  SensorScheduler::SensorScheduler()
+      : killSchedulingThread_(false) {
+  }
+
+  SensorScheduler::~SensorScheduler() {
+    stopAsynchronous();
+  }
+
+  std::size_t SensorScheduler::addSensors(
+      Sensors& sensors,
+      const std::chrono::microseconds measurementInterval) {
+    if (measurementInterval.count() <= 0) {
+      throw std::domain_error("SensorScheduler.addSensors: The measurement interval must be greater than 0.");
+    } else if (isRunningAsynchronous()) {
+      throw std::logic_error("SensorScheduler.addSensors: Sensors can only be added while the scheduler isn't running.");
+    }
+
+    slots_.push_back(std::unique_ptr<Slot>(new Slot(sensors, measurementInterval)));
+    return slots_.size() - 1;
+  }
+
+  std::size_t SensorScheduler::getNumberOfSlots() const {
+    return slots_.size();
+  }
+
+  std::chrono::microseconds SensorScheduler::getMeasurementInterval(
+      const std::size_t slot) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(getSlot(slot).measurementInterval);
+  }
+
+  void SensorScheduler::runAsynchronous() {
+    stopAsynchronous();
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& slot : slots_) {
+      slot->deadline = now;
+    }
+
+    killSchedulingThread_ = false;
+    schedulingThread_ = std::thread(&SensorScheduler::schedule, this);
+  }
+
+  void SensorScheduler::stopAsynchronous() {
+    if (schedulingThread_.joinable()) {
+      killSchedulingThread_ = true;
+      schedulingThread_.join();
+    }
+  }
+
+  bool SensorScheduler::isRunningAsynchronous() const {
+    return schedulingThread_.joinable();
+  }
+
+  bool SensorScheduler::getLatestMeasurement(
+      const std::size_t slot,
+      arma::Row<double>& measurements,
+      std::chrono::steady_clock::time_point& measurementTime) const {
+    const Slot& selectedSlot = getSlot(slot);
+    if (measurements.n_elem != selectedSlot.sensors.numberOfSensors_) {
+      throw std::invalid_argument("SensorScheduler.getLatestMeasurement: The number of measurements (" + std::to_string(measurements.n_elem) + ") must be equal to the number of sensors (" + std::to_string(selectedSlot.sensors.numberOfSensors_) + ").");
+    }
+
+    std::uint64_t measurementNumber;
+    std::chrono::steady_clock::rep measurementTimeCount;
+    do {
+      measurementNumber = selectedSlot.measurementCompleted.load(std::memory_order_acquire);
+      if (measurementNumber == 0) {
+        return false;
+      }
+
+      for (std::size_t n = 0; n < measurements.n_elem; ++n) {
+        measurements(n) = selectedSlot.measurements.at(measurementNumber % 2)[n].load(std::memory_order_relaxed);
+      }
+      measurementTimeCount = selectedSlot.measurementTimes.at(measurementNumber % 2).load(std::memory_order_relaxed);
+      // Orders the copy before the check, pairing with the fence in `measure()`.
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (selectedSlot.measurementBegun.load(std::memory_order_relaxed) > measurementNumber + 1);
+
+    measurementTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(measurementTimeCount));
+    return true;
+  }
+
+  arma::Row<double> SensorScheduler::getLatestMeasurement(
+      const std::size_t slot) const {
+    arma::Row<double> measurements(getSlot(slot).sensors.numberOfSensors_);
+    std::chrono::steady_clock::time_point measurementTime;
+    if (!getLatestMeasurement(slot, measurements, measurementTime)) {
+      throw std::logic_error("SensorScheduler.getLatestMeasurement: The sensors were not measured yet.");
+    }
+
+    return measurements;
+  }
+
+  std::uint64_t SensorScheduler::getNumberOfMeasurements(
+      const std::size_t slot) const {
+    return getSlot(slot).measurementCompleted.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t SensorScheduler::getNumberOfOverruns(
+      const std::size_t slot) const {
+    return getSlot(slot).numberOfOverruns.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t SensorScheduler::getNumberOfFailedMeasurements(
+      const std::size_t slot) const {
+    return getSlot(slot).numberOfFailedMeasurements.load(std::memory_order_relaxed);
+  }
+
+  std::chrono::nanoseconds SensorScheduler::getMaximalLateness(
+      const std::size_t slot) const {
+    return std::chrono::nanoseconds(getSlot(slot).maximalLateness.load(std::memory_order_relaxed));
+  }
+
+  void SensorScheduler::resetStatistics() {
+    for (auto& slot : slots_) {
+      slot->numberOfOverruns.store(0, std::memory_order_relaxed);
+      slot->numberOfFailedMeasurements.store(0, std::memory_order_relaxed);
+      slot->maximalLateness.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void SensorScheduler::schedule() {
+    if (slots_.empty()) {
+      return;
+    }
+
+    while (!killSchedulingThread_) {
+      Slot* dueSlot = slots_.front().get();
+      for (auto& slot : slots_) {
+        if (slot->deadline < dueSlot->deadline) {
+          dueSlot = slot.get();
+        }
+      }
+
+      timing::sleepUntil(dueSlot->deadline);
+      if (killSchedulingThread_) {
+        break;
+      }
+
+      const std::chrono::nanoseconds::rep lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - dueSlot->deadline).count();
+      if (lateness > dueSlot->maximalLateness.load(std::memory_order_relaxed)) {
+        dueSlot->maximalLateness.store(lateness, std::memory_order_relaxed);
+      }
+
+      measure(*dueSlot);
+
+      dueSlot->deadline += dueSlot->measurementInterval;
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= dueSlot->deadline) {
+        // Skips all missed deadlines, but keeps the phase of the slot's deadlines.
+        const auto numberOfMissedDeadlines = (now - dueSlot->deadline) / dueSlot->measurementInterval + 1;
+        dueSlot->deadline += numberOfMissedDeadlines * dueSlot->measurementInterval;
+        dueSlot->numberOfOverruns.fetch_add(static_cast<std::uint64_t>(numberOfMissedDeadlines), std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void SensorScheduler::measure(
+      Slot& slot) {
+    try {
+      slot.sensors.measureInto(slot.measurement);
+    } catch (const std::runtime_error&) {
+      slot.numberOfFailedMeasurements.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    const std::uint64_t measurementNumber = slot.measurementCompleted.load(std::memory_order_relaxed) + 1;
+    slot.measurementBegun.store(measurementNumber, std::memory_order_relaxed);
+    // Orders the announcement before overwriting the buffer, pairing with the fence in `getLatestMeasurement()`.
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t n = 0; n < slot.measurement.n_elem; ++n) {
+      slot.measurements.at(measurementNumber % 2)[n].store(slot.measurement(n), std::memory_order_relaxed);
+    }
+    slot.measurementTimes.at(measurementNumber % 2).store(slot.sensors.getLatestSampleTime().time_since_epoch().count(), std::memory_order_relaxed);
+    slot.measurementCompleted.store(measurementNumber, std::memory_order_release);
+  }
+
+  const SensorScheduler::Slot& SensorScheduler::getSlot(
+      const std::size_t slot) const {
+    if (slot >= slots_.size()) {
+      throw std::out_of_range("SensorScheduler.getSlot: The slot number (" + std::to_string(slot) + ") must be less than the number of slots (" + std::to_string(slots_.size()) + ").");
+    }
+
+    return *slots_.at(slot);
+  }
+}
@@ -1,8 +1,10 @@
 #include "demonstrator_bits/sensors.hpp"
 
 // C++ standard library
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
+#include <utility>
 
 // Mantella
 #include <mantella>
@@ -27,13 +29,17 @@ namespace demo {
 
     setMeasurementCorrections(arma::join_cols(arma::zeros<arma::Row<double>>(numberOfSensors_) + minimalMeasurableValue_, arma::zeros<arma::Row<double>>(numberOfSensors_) + maximalMeasurableValue_));
     setNumberOfSamplesPerMeasurment(1);
+
+    measurementMeans_.set_size(numberOfSensors_);
+    measurementSumsOfSquares_.set_size(numberOfSensors_);
+    resetNoiseStatistics();
+    setSampleHistoryCapacity(32);
   }
 
   Sensors::Sensors(
       Sensors&& sensors)
       : Sensors(sensors.numberOfSensors_, sensors.minimalMeasurableValue_, sensors.maximalMeasurableValue_) {
-    setMeasurementCorrections(sensors.measurementCorrections_);
-    setNumberOfSamplesPerMeasurment(sensors.numberOfSamplesPerMeasuement_);
+    moveMeasurementSettings(sensors);
   }
 
   Sensors& Sensors::operator=(
@@ -46,30 +52,120 @@ namespace demo {
       throw std::invalid_argument("Sensors.operator=: The maximal measurable values must be equal.");
     }
     
-    setMeasurementCorrections(sensors.measurementCorrections_);
-    setNumberOfSamplesPerMeasurment(sensors.numberOfSamplesPerMeasuement_);
+    moveMeasurementSettings(sensors);
 
     return *this;
   }
 
   arma::Row<double> Sensors::measure() {
-    arma::Mat<double> measurements(numberOfSamplesPerMeasuement_, numberOfSensors_);
-    for (std::size_t n = 0; n < numberOfSamplesPerMeasuement_; ++n) {
-      measurements.row(n) = arma::clamp(measureImplementation(), minimalMeasurableValue_, maximalMeasurableValue_);
+    arma::Row<double> measuredValues(numberOfSensors_);
+    measureInto(measuredValues);
+    return measuredValues;
+  }
+
+  void Sensors::measureInto(
+      arma::Row<double>& measuredValues) {
+    if (measuredValues.n_elem != numberOfSensors_) {
+      throw std::invalid_argument("Sensors.measureInto: The number of measured values must be equal to the number of sensors.");
     }
 
-    const arma::Row<double>& measurementIndices = (arma::median(measurements) - minimalMeasurableValue_) * (measurementCorrections_.n_rows - 1) / (maximalMeasurableValue_ - minimalMeasurableValue_);
-        
-    const arma::Row<arma::uword>& lowerMeasurementIndices = arma::conv_to<arma::Row<arma::uword>>::from(arma::floor(measurementIndices));
-    const arma::Row<arma::uword>& upperMeasurementIndices = arma::conv_to<arma::Row<arma::uword>>::from(arma::ceil(measurementIndices));
-    const arma::Row<double>& measurementIndicesDifferenz = measurementIndices - lowerMeasurementIndices;
-    
-    arma::Row<double> measuredValues(numberOfSensors_);
+    measurementMeans_.zeros();
+    measurementSumsOfSquares_.zeros();
+    // The standard error can only be estimated from two or more samples.
+    const std::size_t minimalNumberOfSamples = (minimalNumberOfSamplesPerMeasurement_ < numberOfSamplesPerMeasuement_ ? std::max<std::size_t>(minimalNumberOfSamplesPerMeasurement_, 2) : numberOfSamplesPerMeasuement_);
+    const double maximalVarianceOfMean = standardErrorTolerance_ * standardErrorTolerance_;
+
+    std::size_t numberOfSamples = 0;
+    while (numberOfSamples < numberOfSamplesPerMeasuement_) {
+      const auto sampleStart = std::chrono::steady_clock::now();
+      std::chrono::steady_clock::time_point sampleTime;
+      measureImplementationInto(measurementSample_, sampleTime);
+      if (sampleTime == std::chrono::steady_clock::time_point()) {
+        sampleTime = sampleStart + (std::chrono::steady_clock::now() - sampleStart) / 2;
+      }
+      ++numberOfSamples;
+
+      bool isPreciseEnough = true;
+      for (std::size_t k = 0; k < numberOfSensors_; ++k) {
+        measurementSample_(k) = std::min(std::max(measurementSample_(k), minimalMeasurableValue_), maximalMeasurableValue_);
+
+        const double deviation = measurementSample_(k) - measurementMeans_(k);
+        measurementMeans_(k) += deviation / static_cast<double>(numberOfSamples);
+        measurementSumsOfSquares_(k) += deviation * (measurementSample_(k) - measurementMeans_(k));
+        // The estimated variance of the mean is the samples' variance (with Bessel's correction), divided by their number.
+        isPreciseEnough = isPreciseEnough && numberOfSamples > 1 && measurementSumsOfSquares_(k) <= maximalVarianceOfMean * static_cast<double>(numberOfSamples * (numberOfSamples - 1));
+      }
+
+      if (numberOfRecordedSamples_ == 0 || sampleTime > sampleHistoryTimes_.at((numberOfRecordedSamples_ - 1) % sampleHistoryTimes_.size())) {
+        const std::size_t sampleHistoryIndex = numberOfRecordedSamples_ % sampleHistoryTimes_.size();
+        for (std::size_t k = 0; k < numberOfSensors_; ++k) {
+          sampleHistory_(sampleHistoryIndex, k) = measurementSample_(k);
+        }
+        sampleHistoryTimes_.at(sampleHistoryIndex) = sampleTime;
+        ++numberOfRecordedSamples_;
+      }
+
+      if (sampleFilter_) {
+        sampleFilter_->update(measurementSample_);
+      } else {
+        for (std::size_t k = 0; k < numberOfSensors_; ++k) {
+          measurementSamples_(numberOfSamples - 1, k) = measurementSample_(k);
+        }
+      }
+
+      if (numberOfSamples >= minimalNumberOfSamples && isPreciseEnough) {
+        break;
+      }
+    }
+
+    ++numberOfMeasurements_;
+    numberOfSamples_ += numberOfSamples;
+    if (numberOfSamples > 1) {
+      noiseSumsOfSquares_ += measurementSumsOfSquares_;
+      noiseDegreesOfFreedom_ += numberOfSamples - 1;
+    }
+
+    const std::size_t middleSampleIndex = numberOfSamples / 2;
     for (std::size_t n = 0; n < numberOfSensors_; ++n) {
-      measuredValues(n) = (1.0 - measurementIndicesDifferenz(n)) * measurementCorrections_(lowerMeasurementIndices(n), n) +  measurementIndicesDifferenz(n) * measurementCorrections_(upperMeasurementIndices(n), n);
+      double measuredValue;
+      if (sampleFilter_) {
+        // Filters may overshoot (e.g. an alpha-beta filter after a step), but the corrections only cover the measurable range.
+        measuredValue = std::min(std::max(measurementSample_(n), minimalMeasurableValue_), maximalMeasurableValue_);
+      } else {
+        // Selects the median in-place, averaging both middle samples for an even number of samples (as `arma::median` does).
+        double* const samples = measurementSamples_.colptr(n);
+        std::nth_element(samples, samples + middleSampleIndex, samples + numberOfSamples);
+        measuredValue = samples[middleSampleIndex];
+        if (numberOfSamples % 2 == 0) {
+          measuredValue = (measuredValue + *std::max_element(samples, samples + middleSampleIndex)) / 2.0;
+        }
+      }
+
+      measuredValues(n) = correct(n, measuredValue);
     }
-    
-    return measuredValues;
+  }
+
+  void Sensors::measureImplementationInto(
+      arma::Row<double>& measurements,
+      std::chrono::steady_clock::time_point& sampleTime) {
+    static_cast<void>(sampleTime);
+    measurements = measureImplementation();
+  }
+
+  void Sensors::moveMeasurementSettings(
+      Sensors& sensors) {
+    setMeasurementCorrections(sensors.measurementCorrections_);
+    setAdaptiveNumberOfSamplesPerMeasurement(sensors.minimalNumberOfSamplesPerMeasurement_, sensors.numberOfSamplesPerMeasuement_, sensors.standardErrorTolerance_);
+    setSampleFilter(std::move(sensors.sampleFilter_));
+    setSampleHistoryCapacity(sensors.sampleHistoryTimes_.size());
+  }
+
+  double Sensors::correct(
+      const std::size_t n,
+      const double sample) const {
+    const double measurementIndex = (sample - minimalMeasurableValue_) * measurementCorrectionIndexScale_;
+    const std::size_t lowerMeasurementIndex = std::min(static_cast<std::size_t>(measurementIndex), static_cast<std::size_t>(measurementCorrections_.n_rows - 1));
+    return measurementCorrections_(lowerMeasurementIndex, n) + (measurementIndex - static_cast<double>(lowerMeasurementIndex)) * measurementCorrectionSlopes_(lowerMeasurementIndex, n);
   }
 
   void Sensors::setMeasurementCorrections(
@@ -81,6 +177,14 @@ namespace demo {
     }
 
     measurementCorrections_ = measurementCorrections;
+
+    measurementCorrectionSlopes_.zeros(measurementCorrections_.n_rows, numberOfSensors_);
+    for (std::size_t n = 0; n + 1 < measurementCorrections_.n_rows; ++n) {
+      measurementCorrectionSlopes_.row(n) = measurementCorrections_.row(n + 1) - measurementCorrections_.row(n);
+    }
+
+    // All values are mapped to the first row if there is only one measurable value.
+    measurementCorrectionIndexScale_ = (maximalMeasurableValue_ > minimalMeasurableValue_ ? static_cast<double>(measurementCorrections_.n_rows - 1) / (maximalMeasurableValue_ - minimalMeasurableValue_) : 0.0);
   }
 
   arma::Mat<double> Sensors::getMeasurementCorrections() const {
@@ -93,10 +197,149 @@ namespace demo {
       throw std::domain_error("Sensors.setNumberOfSamplesPerMeasurment: The number of samples per measurement must be greater than 0.");
     }
 
-    numberOfSamplesPerMeasuement_ = numberOfSamplesPerMeasuement;
+    setAdaptiveNumberOfSamplesPerMeasurement(numberOfSamplesPerMeasuement, numberOfSamplesPerMeasuement, 0.0);
   }
 
   std::size_t Sensors::getNumberOfSamplesPerMeasuement() const {
     return numberOfSamplesPerMeasuement_;
   }
+
+  void Sensors::setAdaptiveNumberOfSamplesPerMeasurement(
+      const std::size_t minimalNumberOfSamples,
+      const std::size_t maximalNumberOfSamples,
+      const double standardErrorTolerance) {
+    if (minimalNumberOfSamples == 0) {
+      throw std::domain_error("Sensors.setAdaptiveNumberOfSamplesPerMeasurement: The minimal number of samples must be greater than 0.");
+    } else if (maximalNumberOfSamples < minimalNumberOfSamples) {
+      throw std::logic_error("Sensors.setAdaptiveNumberOfSamplesPerMeasurement: The maximal number of samples must be greater than or equal to the minimal one.");
+    } else if (!std::isfinite(standardErrorTolerance) || standardErrorTolerance < 0) {
+      throw std::domain_error("Sensors.setAdaptiveNumberOfSamplesPerMeasurement: The standard error tolerance must be finite and greater than or equal to 0.");
+    }
+
+    minimalNumberOfSamplesPerMeasurement_ = minimalNumberOfSamples;
+    numberOfSamplesPerMeasuement_ = maximalNumberOfSamples;
+    standardErrorTolerance_ = standardErrorTolerance;
+    measurementSamples_.set_size(numberOfSamplesPerMeasuement_, numberOfSensors_);
+    measurementSample_.set_size(numberOfSensors_);
+  }
+
+  std::size_t Sensors::getMinimalNumberOfSamplesPerMeasurement() const {
+    return minimalNumberOfSamplesPerMeasurement_;
+  }
+
+  double Sensors::getStandardErrorTolerance() const {
+    return standardErrorTolerance_;
+  }
+
+  arma::Row<double> Sensors::getNoiseStandardDeviations() const {
+    if (noiseDegreesOfFreedom_ == 0) {
+      return arma::zeros<arma::Row<double>>(numberOfSensors_);
+    }
+
+    return arma::sqrt(noiseSumsOfSquares_ / static_cast<double>(noiseDegreesOfFreedom_));
+  }
+
+  arma::Row<double> Sensors::getExpectedNumbersOfSamplesPerMeasurement() const {
+    const arma::Row<double>& noiseStandardDeviations = getNoiseStandardDeviations();
+    const double minimalNumberOfSamples = static_cast<double>(minimalNumberOfSamplesPerMeasurement_ < numberOfSamplesPerMeasuement_ ? std::max<std::size_t>(minimalNumberOfSamplesPerMeasurement_, 2) : numberOfSamplesPerMeasuement_);
+    const double maximalNumberOfSamples = static_cast<double>(numberOfSamplesPerMeasuement_);
+
+    arma::Row<double> expectedNumbersOfSamples(numberOfSensors_);
+    for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+      if (standardErrorTolerance_ > 0) {
+        expectedNumbersOfSamples(n) = std::min(std::max(std::ceil(std::pow(noiseStandardDeviations(n) / standardErrorTolerance_, 2.0)), minimalNumberOfSamples), maximalNumberOfSamples);
+      } else {
+        expectedNumbersOfSamples(n) = (noiseStandardDeviations(n) > 0 ? maximalNumberOfSamples : minimalNumberOfSamples);
+      }
+    }
+
+    return expectedNumbersOfSamples;
+  }
+
+  double Sensors::getAverageNumberOfSamplesPerMeasurement() const {
+    if (numberOfMeasurements_ == 0) {
+      return 0.0;
+    }
+
+    return static_cast<double>(numberOfSamples_) / static_cast<double>(numberOfMeasurements_);
+  }
+
+  void Sensors::resetNoiseStatistics() {
+    noiseSumsOfSquares_.zeros(numberOfSensors_);
+    noiseDegreesOfFreedom_ = 0;
+    numberOfMeasurements_ = 0;
+    numberOfSamples_ = 0;
+  }
+
+  void Sensors::setSampleFilter(
+      std::unique_ptr<SampleFilter> sampleFilter) {
+    if (sampleFilter && sampleFilter->numberOfSensors_ != numberOfSensors_) {
+      throw std::invalid_argument("Sensors.setSampleFilter: The number of filtered sensors must be equal to the number of sensors.");
+    }
+
+    sampleFilter_ = std::move(sampleFilter);
+  }
+
+  void Sensors::setSampleHistoryCapacity(
+      const std::size_t sampleHistoryCapacity) {
+    if (sampleHistoryCapacity < 2) {
+      throw std::domain_error("Sensors.setSampleHistoryCapacity: The sample history capacity must be at least 2.");
+    }
+
+    sampleHistory_.set_size(sampleHistoryCapacity, numberOfSensors_);
+    sampleHistoryTimes_.assign(sampleHistoryCapacity, std::chrono::steady_clock::time_point());
+    numberOfRecordedSamples_ = 0;
+  }
+
+  std::size_t Sensors::getSampleHistoryCapacity() const {
+    return sampleHistoryTimes_.size();
+  }
+
+  std::chrono::steady_clock::time_point Sensors::getOldestSampleTime() const {
+    if (numberOfRecordedSamples_ == 0) {
+      throw std::logic_error("Sensors.getOldestSampleTime: No sample was recorded yet.");
+    }
+
+    return sampleHistoryTimes_.at(numberOfRecordedSamples_ > sampleHistoryTimes_.size() ? numberOfRecordedSamples_ % sampleHistoryTimes_.size() : 0);
+  }
+
+  std::chrono::steady_clock::time_point Sensors::getLatestSampleTime() const {
+    if (numberOfRecordedSamples_ == 0) {
+      throw std::logic_error("Sensors.getLatestSampleTime: No sample was recorded yet.");
+    }
+
+    return sampleHistoryTimes_.at((numberOfRecordedSamples_ - 1) % sampleHistoryTimes_.size());
+  }
+
+  arma::Row<double> Sensors::sampleAt(
+      const std::chrono::steady_clock::time_point time) const {
+    if (numberOfRecordedSamples_ == 0 || time < getOldestSampleTime() || time > getLatestSampleTime()) {
+      throw std::out_of_range("Sensors.sampleAt: The time must be within the time range of the sample history.");
+    }
+
+    // Searches backwards from the latest sample, as queries are usually about the recent past.
+    const std::size_t capacity = sampleHistoryTimes_.size();
+    std::uint64_t upperSampleNumber = numberOfRecordedSamples_ - 1;
+    while (upperSampleNumber > 0 && upperSampleNumber + capacity > numberOfRecordedSamples_ && sampleHistoryTimes_.at((upperSampleNumber - 1) % capacity) >= time) {
+      --upperSampleNumber;
+    }
+
+    arma::Row<double> values(numberOfSensors_);
+    const std::size_t upperIndex = upperSampleNumber % capacity;
+    // Also covers the oldest sample, which has no predecessor.
+    if (sampleHistoryTimes_.at(upperIndex) == time) {
+      for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+        values(n) = correct(n, sampleHistory_(upperIndex, n));
+      }
+      return values;
+    }
+
+    const std::size_t lowerIndex = (upperSampleNumber - 1) % capacity;
+    const double weight = std::chrono::duration<double>(time - sampleHistoryTimes_.at(lowerIndex)).count() / std::chrono::duration<double>(sampleHistoryTimes_.at(upperIndex) - sampleHistoryTimes_.at(lowerIndex)).count();
+    for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+      values(n) = correct(n, sampleHistory_(lowerIndex, n) + weight * (sampleHistory_(upperIndex, n) - sampleHistory_(lowerIndex, n)));
+    }
+
+    return values;
+  }
 }
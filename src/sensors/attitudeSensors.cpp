@@ -2,6 +2,7 @@
 
 // C++ standard library
 #include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <stdexcept>
 #include <string>
@@ -11,6 +12,9 @@
 #include <stdio.h>
 #include <unistd.h>
 
+// Demonstrator
+#include "demonstrator_bits/gpio.hpp"
+
 /* More information on how to use termios can be found here:
  * http://www.tldp.org/HOWTO/Serial-Programming-HOWTO/x115.html
  */
@@ -31,8 +35,7 @@ namespace demo {
   AttitudeSensors::AttitudeSensors(
       AttitudeSensors&& attitudeSensors)
       : AttitudeSensors(std::move(attitudeSensors.uart_), attitudeSensors.minimalMeasurableValue_, attitudeSensors.maximalMeasurableValue_) {
-    setMeasurementCorrections(attitudeSensors.measurementCorrections_);
-    setNumberOfSamplesPerMeasurment(attitudeSensors.numberOfSamplesPerMeasuement_);
+    moveMeasurementSettings(attitudeSensors);
   }
 
   AttitudeSensors& AttitudeSensors::operator=(
@@ -45,26 +48,39 @@ namespace demo {
 
   AttitudeSensors::~AttitudeSensors() {
     if (continuousMeasurementThread_.joinable()) {
+      // Stops the thread before closing the port it reads from.
+      killContinuousMeasurementThread_ = true;
+      continuousMeasurementThread_.join();
+
       // reset port to previous state
       if (fileDescriptor_ != -1) {
         ::tcsetattr(fileDescriptor_, TCSANOW, &oldSerial_);
         ::close(fileDescriptor_);
       }
-    
-      killContinuousMeasurementThread_ = true;
-      continuousMeasurementThread_.join();
     }
   }
 
   arma::Row<double> AttitudeSensors::measureImplementation() {
+    std::lock_guard<std::mutex> lock(attitudesMutex_);
     return attitudes_;
   }
+
+  void AttitudeSensors::measureImplementationInto(
+      arma::Row<double>& measurements,
+      std::chrono::steady_clock::time_point& sampleTime) {
+    std::lock_guard<std::mutex> lock(attitudesMutex_);
+    for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+      measurements(n) = attitudes_(n);
+    }
+    sampleTime = attitudesTime_;
+  }
   
   void AttitudeSensors::runAsynchronous() {
-    // try to open /dev/ttyAMA0; this must be explicitly enabled! (search for "/dev/ttyAMA0 raspberry pi" on the web)
-    fileDescriptor_ = ::open("/dev/ttyAMA0", O_RDWR | O_NOCTTY | O_NDELAY);
+    // try to open the UART (usually /dev/ttyAMA0); this must be explicitly enabled! (search for "/dev/ttyAMA0 raspberry pi" on the web)
+    const std::string uartDevicePath = Gpio::getBackend().getUartDevicePath();
+    fileDescriptor_ = ::open(uartDevicePath.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
     if (fileDescriptor_ < 0) {
-      throw std::runtime_error("AttitudeSensors: Could not access /dev/ttyAMA0");
+      throw std::runtime_error("AttitudeSensors: Could not access " + uartDevicePath);
     }
 
     // set up serial port settings
@@ -110,22 +126,32 @@ namespace demo {
       char buffer[64];
 
       int numberOfReceivedChars = 0;
-      while (numberOfReceivedChars <= 1) {
+      while (numberOfReceivedChars <= 1 && !killContinuousMeasurementThread_) {
         numberOfReceivedChars = ::read(fileDescriptor_, buffer, 63);
       }
+      if (numberOfReceivedChars <= 1) {
+        break;
+      }
+      const auto receiveTime = std::chrono::steady_clock::now();
       buffer[numberOfReceivedChars] = '\0';
 
       std::string text = buffer;
       text = text.substr(text.find_first_of("=") + 1);
       
+      arma::Row<double>::fixed<3> attitudes;
       try {
-        attitudes_(0) = std::stod(text.substr(0, text.find_first_of(",")));
-        attitudes_(1) = std::stod(text.substr(text.find_first_of(",") + 1, text.find_last_of(",")));
-        attitudes_(2) = std::stod(text.substr(text.find_last_of(",") + 1));
-        attitudes_ *= arma::datum::pi / 180.0;
+        attitudes(0) = std::stod(text.substr(0, text.find_first_of(",")));
+        attitudes(1) = std::stod(text.substr(text.find_first_of(",") + 1, text.find_last_of(",")));
+        attitudes(2) = std::stod(text.substr(text.find_last_of(",") + 1));
+        attitudes *= arma::datum::pi / 180.0;
       } catch (...) {
         continue;
       }
+
+      // Publishes all three attitudes at once, together with their time.
+      std::lock_guard<std::mutex> lock(attitudesMutex_);
+      attitudes_ = attitudes;
+      attitudesTime_ = receiveTime;
     }
   }
 
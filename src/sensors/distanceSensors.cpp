@@ -2,62 +2,492 @@
 
 // C++ standard library
 #include <algorithm>
+#include <cerrno>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <chrono>
+#include <exception>
+#include <functional>
 #include <ratio>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <utility>
 // IWYU pragma: no_include <ext/alloc_traits.h>
 
+// Unix library
+#include <time.h>
+
+// Demonstrator
+#include "demonstrator_bits/backend.hpp"
+#include "demonstrator_bits/edgeEventSource.hpp"
+#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/timing.hpp"
+#include "demonstrator_bits/trace.hpp"
+
 namespace demo {
+  namespace {
+    /**
+     * 58 microseconds per centimetre, as stated in the data sheet.
+     */
+    const double echoDurationPerMetre = 5800.0e-6;
+
+    /**
+     * The echo starts after the sensor sent its 8-cycle 40 kHz burst, i.e. a few hundred microseconds after the trigger. A sensor that doesn't respond within this time (e.g. as it is still waiting for a previous echo) reads as the maximal distance.
+     */
+    const std::chrono::milliseconds echoStartTimeout(5);
+  }
+
   DistanceSensors::DistanceSensors(
       std::vector<Pin>&& pins,
       const double minimalDistance,
       const double maximalDistance)
       : Sensors(pins.size(), minimalDistance, maximalDistance),
-        pins_(std::move(pins)) {
+        pins_(std::move(pins)),
+        maximalEchoDuration_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(0.0, maximalDistance) * echoDurationPerMetre))),
+        rangingGroupGuardTime_(0),
+        isDefaultRangingGroupGuardTime_(true),
+        echoStates_(numberOfSensors_, EchoState::Completed),
+        echoStarts_(numberOfSensors_),
+        rangingInterval_(0),
+        killRangingThread_(false),
+        rangedDistances_(numberOfSensors_),
+        rangeBegun_(0),
+        rangeCompleted_(0) {
+    pollFileDescriptors_.reserve(numberOfSensors_);
+    for (std::size_t k = 0; k < latestDistances_.size(); ++k) {
+      latestDistances_.at(k).reset(new std::atomic<double>[numberOfSensors_]);
+      latestRangeTimes_.at(k) = 0;
+    }
+
+    std::vector<std::vector<std::size_t>> rangingGroups;
     for (std::size_t n = 0; n < numberOfSensors_; ++n) {
       pins_.at(n).set(Pin::Digital::Low);
-      std::this_thread::sleep_for(std::chrono::microseconds(2));
+      timing::wait(std::chrono::microseconds(2));
+      rangingGroups.push_back({n});
     }
+    setRangingGroups(rangingGroups);
   }
 
   DistanceSensors::DistanceSensors(
       DistanceSensors&& distanceSensors)
-      : DistanceSensors(std::move(distanceSensors.pins_), distanceSensors.minimalMeasurableValue_, distanceSensors.maximalMeasurableValue_) {
-    setMeasurementCorrections(distanceSensors.measurementCorrections_);
-    setNumberOfSamplesPerMeasurment(distanceSensors.numberOfSamplesPerMeasuement_);
+      : DistanceSensors(releasePins(distanceSensors), distanceSensors.minimalMeasurableValue_, distanceSensors.maximalMeasurableValue_) {
+    moveMeasurementSettings(distanceSensors);
+    setRangingGroups(distanceSensors.rangingGroups_);
+    rangingGroupGuardTime_ = distanceSensors.rangingGroupGuardTime_;
+    isDefaultRangingGroupGuardTime_ = distanceSensors.isDefaultRangingGroupGuardTime_;
+    subscribers_ = std::move(distanceSensors.subscribers_);
+
+    if (distanceSensors.rangingInterval_.count() > 0) {
+      runAsynchronous(distanceSensors.rangingInterval_);
+      distanceSensors.rangingInterval_ = std::chrono::microseconds(0);
+    }
   }
 
   DistanceSensors& DistanceSensors::operator=(
       DistanceSensors&& distanceSensors) {
-    pins_ = std::move(distanceSensors.pins_);
+    stopAsynchronous();
+    pins_ = releasePins(distanceSensors);
+    setRangingGroups(distanceSensors.rangingGroups_);
+    rangingGroupGuardTime_ = distanceSensors.rangingGroupGuardTime_;
+    isDefaultRangingGroupGuardTime_ = distanceSensors.isDefaultRangingGroupGuardTime_;
+    subscribers_ = std::move(distanceSensors.subscribers_);
     
     Sensors::operator=(std::move(distanceSensors));
+
+    if (distanceSensors.rangingInterval_.count() > 0) {
+      runAsynchronous(distanceSensors.rangingInterval_);
+      distanceSensors.rangingInterval_ = std::chrono::microseconds(0);
+    }
+
     return *this;
   }
 
+  DistanceSensors::~DistanceSensors() {
+    stopRangingThread();
+  }
+
+  void DistanceSensors::useGpioChipEdgeEvents(
+      const std::string& gpioChipPath) {
+    if (isRunningAsynchronous()) {
+      throw std::logic_error("DistanceSensors.useGpioChipEdgeEvents: The edge events can't be changed while ranging asynchronously.");
+    }
+
+    for (auto& pin : pins_) {
+      pin.useGpioChipEdgeEvents(gpioChipPath);
+    }
+  }
+
+  void DistanceSensors::setRangingGroups(
+      const std::vector<std::vector<std::size_t>>& rangingGroups) {
+    if (isRunningAsynchronous()) {
+      throw std::logic_error("DistanceSensors.setRangingGroups: The ranging groups can't be changed while ranging asynchronously.");
+    }
+
+    std::vector<unsigned int> numberOfGroupsPerSensor(numberOfSensors_, 0);
+    for (const auto& rangingGroup : rangingGroups) {
+      if (rangingGroup.empty()) {
+        throw std::invalid_argument("DistanceSensors.setRangingGroups: The ranging groups must not be empty.");
+      }
+
+      for (const auto n : rangingGroup) {
+        if (n >= numberOfSensors_) {
+          throw std::out_of_range("DistanceSensors.setRangingGroups: The sensor number (" + std::to_string(n) + ") must be less than the number of sensors (" + std::to_string(numberOfSensors_) + ").");
+        }
+
+        ++numberOfGroupsPerSensor.at(n);
+      }
+    }
+
+    if (std::any_of(numberOfGroupsPerSensor.cbegin(), numberOfGroupsPerSensor.cend(), [](const unsigned int numberOfGroups) {return numberOfGroups != 1;})) {
+      throw std::invalid_argument("DistanceSensors.setRangingGroups: Each sensor must be part of exactly one ranging group.");
+    }
+
+    rangingGroups_ = rangingGroups;
+
+    if (isDefaultRangingGroupGuardTime_) {
+      if (std::all_of(rangingGroups_.cbegin(), rangingGroups_.cend(), [](const std::vector<std::size_t>& rangingGroup) {return rangingGroup.size() == 1;})) {
+        rangingGroupGuardTime_ = std::chrono::microseconds(0);
+      } else {
+        // Rounded up, so that the guard time covers the whole echo.
+        rangingGroupGuardTime_ = std::chrono::duration_cast<std::chrono::microseconds>(maximalEchoDuration_ + std::chrono::microseconds(1) - std::chrono::steady_clock::duration(1));
+      }
+    }
+  }
+
+  std::vector<std::vector<std::size_t>> DistanceSensors::getRangingGroups() const {
+    return rangingGroups_;
+  }
+
+  void DistanceSensors::setRangingGroupGuardTime(
+      const std::chrono::microseconds rangingGroupGuardTime) {
+    if (isRunningAsynchronous()) {
+      throw std::logic_error("DistanceSensors.setRangingGroupGuardTime: The guard time can't be changed while ranging asynchronously.");
+    } else if (rangingGroupGuardTime.count() < 0) {
+      throw std::domain_error("DistanceSensors.setRangingGroupGuardTime: The guard time must not be negative.");
+    }
+
+    rangingGroupGuardTime_ = rangingGroupGuardTime;
+    isDefaultRangingGroupGuardTime_ = false;
+  }
+
+  std::chrono::microseconds DistanceSensors::getRangingGroupGuardTime() const {
+    return rangingGroupGuardTime_;
+  }
+
+  void DistanceSensors::subscribe(
+      std::function<void(const std::size_t, const double)> subscriber) {
+    if (isRunningAsynchronous()) {
+      throw std::logic_error("DistanceSensors.subscribe: Subscribers can only be added while not ranging asynchronously.");
+    }
+
+    subscribers_.push_back(std::move(subscriber));
+  }
+
+  void DistanceSensors::runAsynchronous(
+      const std::chrono::microseconds rangingInterval) {
+    if (rangingInterval.count() <= 0) {
+      throw std::domain_error("DistanceSensors.runAsynchronous: The ranging interval must be greater than 0.");
+    }
+
+    stopRangingThread();
+    rangingInterval_ = rangingInterval;
+
+    recentRanges_.set_size(getNumberOfSamplesPerMeasuement(), numberOfSensors_);
+    numbersOfRecentRanges_.assign(numberOfSensors_, 0);
+    sortedRecentRanges_.resize(recentRanges_.n_rows);
+
+    // Ranges the first round in the calling thread, so that the snapshot is valid as soon as this returns.
+    killRangingThread_ = false;
+    rangeAllGroups();
+
+    rangingThread_ = std::thread(&DistanceSensors::rangeContinuously, this);
+  }
+
+  void DistanceSensors::stopAsynchronous() {
+    stopRangingThread();
+    rangingInterval_ = std::chrono::microseconds(0);
+  }
+
+  bool DistanceSensors::isRunningAsynchronous() const {
+    return rangingThread_.joinable();
+  }
+
+  bool DistanceSensors::getLatestDistances(
+      arma::Row<double>& distances,
+      std::chrono::steady_clock::time_point& rangeTime) const {
+    if (distances.n_elem != numberOfSensors_) {
+      throw std::invalid_argument("DistanceSensors.getLatestDistances: The number of distances (" + std::to_string(distances.n_elem) + ") must be equal to the number of sensors (" + std::to_string(numberOfSensors_) + ").");
+    }
+
+    std::uint64_t rangeNumber;
+    std::chrono::steady_clock::rep rangeTimeCount;
+    do {
+      rangeNumber = rangeCompleted_.load(std::memory_order_acquire);
+      if (rangeNumber == 0) {
+        return false;
+      }
+
+      for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+        distances(n) = latestDistances_.at(rangeNumber % 2)[n].load(std::memory_order_relaxed);
+      }
+      rangeTimeCount = latestRangeTimes_.at(rangeNumber % 2).load(std::memory_order_relaxed);
+      // Orders the copy before the check, pairing with the fence in `rangeAllGroups()`.
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (rangeBegun_.load(std::memory_order_relaxed) > rangeNumber + 1);
+
+    rangeTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(rangeTimeCount));
+    return true;
+  }
+
+  std::uint64_t DistanceSensors::getNumberOfAsynchronousRanges() const {
+    return rangeCompleted_.load(std::memory_order_relaxed);
+  }
+
   arma::Row<double> DistanceSensors::measureImplementation() {
+    arma::Row<double> distances(numberOfSensors_);
+    std::chrono::steady_clock::time_point sampleTime;
+    measureImplementationInto(distances, sampleTime);
+    return distances;
+  }
+
+  void DistanceSensors::measureImplementationInto(
+      arma::Row<double>& measurements,
+      std::chrono::steady_clock::time_point& sampleTime) {
+    if (rangingThread_.joinable()) {
+      getLatestDistances(measurements, sampleTime);
+      return;
+    }
+
+    for (const auto& rangingGroup : rangingGroups_) {
+      range(rangingGroup, measurements);
+    }
+  }
+
+  void DistanceSensors::range(
+      const std::vector<std::size_t>& rangingGroup,
+      arma::Row<double>& distances) {
     /*
-     * 1. Send 10us pulse trigger.
-     * 2. Wait for echo signal. Abort after 250 milliseconds because TODO EXPLAIN THIS
-     * 3. Calculate the distance in meter using the equation in the data sheet: distance [cm] = us/58
-     * 4. Reset the pin to its initial state for the next measurement.
+     * 0. Wait until the guard time passed since the previous group was completed.
+     * 1. Send a 10us trigger pulse on all pins of the group at once.
+     * 2. Watch all echo pins, until each echo was completed or timed out:
+     *    - Edges are taken from the pin's edge event source (if any), or derived from the levels of all polled pins, read at once. A polled pin must read low before its echo can start, so that a previous echo isn't timed as a new one.
+     *    - An echo that doesn't start within `echoStartTimeout`, or lasts longer than `maximalEchoDuration_`, reads as the maximal distance.
+     * 3. Calculate the distances in meter using the equation in the data sheet: distance [cm] = us/58
      */
+    Backend& backend = Gpio::getBackend();
 
-    arma::Row<double> distances(numberOfSensors_);
-    for (std::size_t n = 0; n < numberOfSensors_; ++n) {
-      pins_.at(n).set(Pin::Digital::High);
-      std::this_thread::sleep_for(std::chrono::microseconds(10));
-      pins_.at(n).set(Pin::Digital::Low);
+    timing::sleepUntil(previousRangeEnd_ + rangingGroupGuardTime_);
+
+    std::uint32_t triggerMask = 0;
+    for (const auto n : rangingGroup) {
+      const unsigned int pinNumber = pins_.at(n).getPinNumber();
+      backend.setMode(pinNumber, Backend::Mode::Output);
+      triggerMask |= 1u << pinNumber;
+    }
+
+    // All trigger pulses start and end at once (on the same edge, if the GPIO registers are accessed directly).
+    for (const auto n : rangingGroup) {
+      trace::record(trace::Component::Pin, trace::Operation::Set, pins_.at(n).getPinNumber(), 1);
+    }
+    backend.set(triggerMask);
+    timing::wait(std::chrono::microseconds(10));
+    backend.clear(triggerMask);
+    const auto triggered = std::chrono::steady_clock::now();
+    for (const auto n : rangingGroup) {
+      trace::record(trace::Component::Pin, trace::Operation::Set, pins_.at(n).getPinNumber(), 0);
+    }
+
+    timing::wait(std::chrono::microseconds(20));
+
+    bool hasPolledPins = false;
+    for (const auto n : rangingGroup) {
+      Pin& pin = pins_.at(n);
+      EdgeEventSource* edgeEventSource = pin.getEdgeEventSource();
+      backend.setMode(pin.getPinNumber(), Backend::Mode::Input);
+      trace::record(trace::Component::Pin, trace::Operation::WaitForSignalEdge, pin.getPinNumber(), static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::microseconds>(echoStartTimeout + maximalEchoDuration_).count()));
+
+      echoStates_.at(n) = (edgeEventSource ? EchoState::Listening : EchoState::Triggered);
+      // Polled pins must be checked continuously, while sources without a file descriptor are checked without waiting.
+      hasPolledPins |= (!edgeEventSource || edgeEventSource->getFileDescriptor() < 0);
+    }
+
+    std::size_t numberOfPendingEchoes = rangingGroup.size();
+    while (numberOfPendingEchoes > 0) {
+      // The levels of all polled pins are read at once, so they share a timestamp.
+      const std::uint32_t levels = hasPolledPins ? backend.getLevels() : 0;
+      const auto now = std::chrono::steady_clock::now();
 
-      std::this_thread::sleep_for(std::chrono::microseconds(20));
-      pins_.at(n).waitForSignalEdge(std::chrono::milliseconds(50));
+      auto nextDeadline = std::chrono::steady_clock::time_point::max();
+      pollFileDescriptors_.clear();
+      for (const auto n : rangingGroup) {
+        if (echoStates_.at(n) == EchoState::Completed) {
+          continue;
+        }
 
-      // TODO: If we can set `maximalMeasurableDistance_`, we need to adjust the wait time to a dynamic value, too.
-      distances(n) = pins_.at(n).waitForSignalEdge(std::chrono::milliseconds(2)).count() / 5800.0;
+        Pin& pin = pins_.at(n);
+        EdgeEventSource* edgeEventSource = pin.getEdgeEventSource();
+        bool isCompleted = false;
+        SignalEdge signalEdge;
+        if (edgeEventSource) {
+          // Drains all queued edges, without waiting. Edges caused by the trigger pulse are skipped.
+          while (!isCompleted && edgeEventSource->waitForSignalEdge(triggered, signalEdge)) {
+            if (signalEdge.timestamp >= triggered) {
+              isCompleted = updateEcho(n, signalEdge, distances);
+            }
+          }
+        } else {
+          signalEdge.isRising = ((levels >> pin.getPinNumber()) & 1u) != 0;
+          signalEdge.timestamp = now;
+          if (echoStates_.at(n) != EchoState::Triggered) {
+            isCompleted = updateEcho(n, signalEdge, distances);
+          } else if (!signalEdge.isRising) {
+            echoStates_.at(n) = EchoState::Listening;
+          }
+        }
+
+        const auto deadline = (echoStates_.at(n) == EchoState::Started ? echoStarts_.at(n) + maximalEchoDuration_ : triggered + echoStartTimeout);
+        if (!isCompleted && now >= deadline) {
+          distances(n) = maximalMeasurableValue_;
+          echoStates_.at(n) = EchoState::Completed;
+          trace::record(trace::Component::Pin, trace::Operation::Timeout, pin.getPinNumber(), 0);
+          isCompleted = true;
+        }
+
+        if (isCompleted) {
+          --numberOfPendingEchoes;
+        } else {
+          nextDeadline = std::min(nextDeadline, deadline);
+          if (edgeEventSource && edgeEventSource->getFileDescriptor() >= 0) {
+            struct ::pollfd pollFileDescriptor;
+            pollFileDescriptor.fd = edgeEventSource->getFileDescriptor();
+            pollFileDescriptor.events = POLLIN;
+            pollFileDescriptor.revents = 0;
+            pollFileDescriptors_.push_back(pollFileDescriptor);
+          }
+        }
+      }
+
+      if (numberOfPendingEchoes == 0) {
+        break;
+      } else if (hasPolledPins) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(500));
+      } else {
+        // Sleeps until any of the pending pins reports an edge, or the next echo times out.
+        const std::chrono::nanoseconds remainingTime = std::max(std::chrono::nanoseconds(0), std::chrono::duration_cast<std::chrono::nanoseconds>(nextDeadline - std::chrono::steady_clock::now()));
+        struct ::timespec timeout;
+        timeout.tv_sec = static_cast<decltype(timeout.tv_sec)>(remainingTime.count() / 1000000000);
+        timeout.tv_nsec = static_cast<decltype(timeout.tv_nsec)>(remainingTime.count() % 1000000000);
+
+        if (::ppoll(pollFileDescriptors_.data(), pollFileDescriptors_.size(), &timeout, nullptr) < 0 && errno != EINTR) {
+          throw std::runtime_error("DistanceSensors.measure: " + static_cast<std::string>(std::strerror(errno)));
+        }
+      }
+    }
+
+    for (const auto n : rangingGroup) {
       pins_.at(n).set(Pin::Digital::Low);
     }
+    previousRangeEnd_ = std::chrono::steady_clock::now();
+  }
+
+  bool DistanceSensors::updateEcho(
+      const std::size_t n,
+      const SignalEdge& signalEdge,
+      arma::Row<double>& distances) {
+    // A falling edge before the echo started is the end of the trigger pulse, depending on when the pin was switched to input mode.
+    if (echoStates_.at(n) == EchoState::Listening && signalEdge.isRising) {
+      echoStarts_.at(n) = signalEdge.timestamp;
+      echoStates_.at(n) = EchoState::Started;
+      trace::record(trace::Component::Pin, trace::Operation::SignalEdge, pins_.at(n).getPinNumber(), 1);
+    } else if (echoStates_.at(n) == EchoState::Started && !signalEdge.isRising) {
+      // The echo duration is taken from the edges' timestamps, which (if provided by the kernel) are independent of when this thread was woken up.
+      distances(n) = std::min(std::chrono::duration<double>(signalEdge.timestamp - echoStarts_.at(n)).count() / echoDurationPerMetre, maximalMeasurableValue_);
+      echoStates_.at(n) = EchoState::Completed;
+      trace::record(trace::Component::Pin, trace::Operation::SignalEdge, pins_.at(n).getPinNumber(), 0);
+      return true;
+    }
 
-    return distances;
+    return false;
+  }
+
+  void DistanceSensors::rangeAllGroups() {
+    for (const auto& rangingGroup : rangingGroups_) {
+      if (killRangingThread_) {
+        return;
+      }
+
+      range(rangingGroup, rangedDistances_);
+      const auto rangeTime = std::chrono::steady_clock::now();
+      for (const auto n : rangingGroup) {
+        recentRanges_(numbersOfRecentRanges_.at(n) % recentRanges_.n_rows, n) = std::max(rangedDistances_(n), minimalMeasurableValue_);
+        ++numbersOfRecentRanges_.at(n);
+
+        // The median of an even number of ranges is the mean of both middle ones.
+        const std::size_t numberOfRecentRanges = std::min<std::size_t>(numbersOfRecentRanges_.at(n), recentRanges_.n_rows);
+        for (std::size_t k = 0; k < numberOfRecentRanges; ++k) {
+          sortedRecentRanges_.at(k) = recentRanges_(k, n);
+        }
+        const auto middle = sortedRecentRanges_.begin() + static_cast<std::ptrdiff_t>(numberOfRecentRanges / 2);
+        std::nth_element(sortedRecentRanges_.begin(), middle, sortedRecentRanges_.begin() + static_cast<std::ptrdiff_t>(numberOfRecentRanges));
+        rangedDistances_(n) = (numberOfRecentRanges % 2 == 0 ? (*middle + *std::max_element(sortedRecentRanges_.begin(), middle)) / 2.0 : *middle);
+      }
+
+      const std::uint64_t rangeNumber = rangeCompleted_.load(std::memory_order_relaxed) + 1;
+      rangeBegun_.store(rangeNumber, std::memory_order_relaxed);
+      // Orders the announcement before overwriting the buffer, pairing with the fence in `getLatestDistances()`.
+      std::atomic_thread_fence(std::memory_order_release);
+      for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+        latestDistances_.at(rangeNumber % 2)[n].store(rangedDistances_(n), std::memory_order_relaxed);
+      }
+      latestRangeTimes_.at(rangeNumber % 2).store(rangeTime.time_since_epoch().count(), std::memory_order_relaxed);
+      rangeCompleted_.store(rangeNumber, std::memory_order_release);
+
+      // Subscribers are notified after publishing, so that they already find the new distances in the snapshot.
+      for (const auto n : rangingGroup) {
+        for (const auto& subscriber : subscribers_) {
+          try {
+            subscriber(n, rangedDistances_(n));
+          } catch (const std::exception&) {
+            // A failing subscriber (e.g. an indicator rejecting the distance) must neither keep the others from being notified, nor stop the ranging.
+            continue;
+          }
+        }
+      }
+    }
+  }
+
+  void DistanceSensors::rangeContinuously() {
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (!killRangingThread_) {
+      deadline += rangingInterval_;
+      timing::sleepUntil(deadline);
+
+      try {
+        rangeAllGroups();
+      } catch (const std::exception&) {
+        // A failed wait for the echoes (e.g. an invalid file descriptor) only drops the remaining groups of this round, as an exception would otherwise terminate the program.
+        continue;
+      }
+
+      if (std::chrono::steady_clock::now() - deadline >= rangingInterval_) {
+        deadline = std::chrono::steady_clock::now();
+      }
+    }
+  }
+
+  void DistanceSensors::stopRangingThread() {
+    if (rangingThread_.joinable()) {
+      killRangingThread_ = true;
+      rangingThread_.join();
+    }
+  }
+
+  std::vector<Pin> DistanceSensors::releasePins(
+      DistanceSensors& distanceSensors) {
+    distanceSensors.stopRangingThread();
+    return std::move(distanceSensors.pins_);
   }
 }
@@ -3,10 +3,13 @@
 // C++ standard library
 #include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <stdexcept>
+#include <string>
 
 // Demonstrator
 #include "demonstrator_bits/spi.hpp"
+#include "demonstrator_bits/timing.hpp"
 
 namespace demo {
   ExtensionSensors::ExtensionSensors(
@@ -16,14 +19,47 @@ namespace demo {
       const double maximalExtension)
       : Sensors(channels.size(), minimalExtension, maximalExtension),
         spi_(std::move(spi)),
-        channels_(channels) {
+        channels_(channels),
+        commands_(3 * channels.size(), 0),
+        responses_(3 * channels.size(), 0),
+        samplingInterval_(0),
+        killSamplingThread_(false),
+        sampleBegun_(0),
+        sampleCompleted_(0) {
+    for (auto& samples : samples_) {
+      samples.reset(new std::atomic<std::uint16_t>[numberOfSensors_]);
+    }
+
+    // The MCP3008 supports SPI mode 0 and 3, sending the most significant bit first.
+    spi_.setMode(Spi::Mode::Mode0);
+    spi_.setBitOrder(Spi::BitOrder::MostSignificantBitFirst);
+
+    for (std::size_t n = 0; n < channels_.size(); ++n) {
+      if (channels_.at(n) >= 8 * spi_.getNumberOfSlaves()) {
+        throw std::domain_error("ExtensionSensors: The channels must be within [0, " + std::to_string(8 * spi_.getNumberOfSlaves() - 1) + "].");
+      }
+
+      // The start bit is sent as the last bit of the first byte, so that the 10-bit result ends with the third byte.
+      commands_.at(3 * n) = 0x01;
+      commands_.at(3 * n + 1) = static_cast<std::uint8_t>((0x08 | (channels_.at(n) % 8)) << 4);
+      transfers_.push_back({&commands_.at(3 * n), &responses_.at(3 * n), 3, channels_.at(n) / 8});
+    }
+
+    // Groups the conversions by ADC, so that all conversions of an ADC at `CE0` or `CE1` are submitted as a single message. The responses remain in the order of `channels`.
+    std::stable_sort(transfers_.begin(), transfers_.end(), [](const Backend::SpiTransfer& first, const Backend::SpiTransfer& second) {
+      return first.slave < second.slave;
+    });
   }
 
   ExtensionSensors::ExtensionSensors(
       ExtensionSensors&& extensionSensors)
-      : ExtensionSensors(std::move(extensionSensors.spi_), extensionSensors.channels_, extensionSensors.minimalMeasurableValue_, extensionSensors.maximalMeasurableValue_) {
-    setMeasurementCorrections(extensionSensors.measurementCorrections_);
-    setNumberOfSamplesPerMeasurment(extensionSensors.numberOfSamplesPerMeasuement_);
+      : ExtensionSensors(releaseSpi(extensionSensors), extensionSensors.channels_, extensionSensors.minimalMeasurableValue_, extensionSensors.maximalMeasurableValue_) {
+    moveMeasurementSettings(extensionSensors);
+
+    if (extensionSensors.samplingInterval_.count() > 0) {
+      runAsynchronous(extensionSensors.samplingInterval_);
+      extensionSensors.samplingInterval_ = std::chrono::microseconds(0);
+    }
   }
 
   ExtensionSensors& ExtensionSensors::operator=(
@@ -32,49 +68,143 @@ namespace demo {
       throw std::invalid_argument("ExtensionSensors.operator=: The channels must be equal.");
     }
 
-    spi_ = std::move(extensionSensors.spi_);
+    stopAsynchronous();
+    spi_ = releaseSpi(extensionSensors);
 
     Sensors::operator=(std::move(extensionSensors));
+
+    if (extensionSensors.samplingInterval_.count() > 0) {
+      runAsynchronous(extensionSensors.samplingInterval_);
+      extensionSensors.samplingInterval_ = std::chrono::microseconds(0);
+    }
+
     return *this;
   }
 
-  arma::Row<double> ExtensionSensors::measureImplementation() {
-    arma::Row<double> extensions(numberOfSensors_);
+  ExtensionSensors::~ExtensionSensors() {
+    stopSamplingThread();
+  }
+
+  void ExtensionSensors::runAsynchronous(
+      const std::chrono::microseconds samplingInterval) {
+    if (samplingInterval.count() <= 0) {
+      throw std::domain_error("ExtensionSensors.runAsynchronous: The sampling interval must be greater than 0.");
+    }
+
+    stopSamplingThread();
+    samplingInterval_ = samplingInterval;
+
+    // Takes the first sample in the calling thread, so that measurements are valid as soon as this returns.
+    sampleTimes_.at(0).store(convert().time_since_epoch().count(), std::memory_order_relaxed);
+    sampleBegun_ = 0;
+    sampleCompleted_ = 0;
     for (std::size_t n = 0; n < numberOfSensors_; ++n) {
-      spi_.set(Spi::Pin::ChipSelect, Spi::Digital::High);
-      spi_.set(Spi::Pin::Clock, Spi::Digital::Low);
-      spi_.set(Spi::Pin::ChipSelect, Spi::Digital::Low);
+      samples_.at(0)[n].store(getConversionResult(n), std::memory_order_relaxed);
+    }
 
-      // TODO Using a std::bitset instead for `commandOut`?
-      unsigned int commandOut = channels_.at(n) | 0x18;
-      commandOut <<= 3;
+    killSamplingThread_ = false;
+    samplingThread_ = std::thread(&ExtensionSensors::sample, this);
+  }
 
-      for (int i = 0; i < 5; i++) {
-        spi_.set(Spi::Pin::Mosi, (commandOut & 0x80) ? Spi::Digital::High : Spi::Digital::Low);
+  void ExtensionSensors::stopAsynchronous() {
+    stopSamplingThread();
+    samplingInterval_ = std::chrono::microseconds(0);
+  }
 
-        commandOut <<= 1;
-        spi_.set(Spi::Pin::Clock, Spi::Digital::High);
-        spi_.set(Spi::Pin::Clock, Spi::Digital::Low);
-      }
+  bool ExtensionSensors::isRunningAsynchronous() const {
+    return samplingThread_.joinable();
+  }
+
+  std::uint64_t ExtensionSensors::getNumberOfAsynchronousSamples() const {
+    return sampleCompleted_.load(std::memory_order_relaxed);
+  }
 
-      int adcout = 0;
-      for (int i = 0; i < 12; i++) {
-        spi_.set(Spi::Pin::Clock, Spi::Digital::High);
-        spi_.set(Spi::Pin::Clock, Spi::Digital::Low);
+  arma::Row<double> ExtensionSensors::measureImplementation() {
+    arma::Row<double> extensions(numberOfSensors_);
+    std::chrono::steady_clock::time_point sampleTime;
+    measureImplementationInto(extensions, sampleTime);
+    return extensions;
+  }
 
-        adcout <<= 1;
-        if (spi_.get(Spi::Pin::Miso) == Spi::Digital::High) {
-          adcout |= 0x1;
+  void ExtensionSensors::measureImplementationInto(
+      arma::Row<double>& measurements,
+      std::chrono::steady_clock::time_point& sampleTime) {
+    if (samplingThread_.joinable()) {
+      std::uint64_t sampleNumber;
+      do {
+        sampleNumber = sampleCompleted_.load(std::memory_order_acquire);
+        for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+          measurements(n) = static_cast<double>(samples_.at(sampleNumber % 2)[n].load(std::memory_order_relaxed));
         }
+        sampleTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(sampleTimes_.at(sampleNumber % 2).load(std::memory_order_relaxed)));
+        // Orders the copy before the check, pairing with the fence in `sample()`.
+        std::atomic_thread_fence(std::memory_order_acquire);
+      } while (sampleBegun_.load(std::memory_order_relaxed) > sampleNumber + 1);
+    } else {
+      sampleTime = convert();
+      for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+        measurements(n) = static_cast<double>(getConversionResult(n));
+      }
+    }
+
+    // Element-wise expressions are evaluated directly into the (equally sized) destination, without a temporary.
+    measurements = minimalMeasurableValue_ + measurements / 1023.0 * (maximalMeasurableValue_ - minimalMeasurableValue_);
+  }
+
+  std::chrono::steady_clock::time_point ExtensionSensors::convert() {
+    const auto conversionStart = std::chrono::steady_clock::now();
+    spi_.transfer(transfers_);
+    return conversionStart + (std::chrono::steady_clock::now() - conversionStart) / 2;
+  }
+
+  std::uint16_t ExtensionSensors::getConversionResult(
+      const std::size_t n) const {
+    // The second byte ends with the null bit and the two most significant bits of the result.
+    return static_cast<std::uint16_t>(((responses_.at(3 * n + 1) & 0x03u) << 8) | responses_.at(3 * n + 2));
+  }
+
+  void ExtensionSensors::sample() {
+    std::uint64_t sampleNumber = sampleCompleted_.load(std::memory_order_relaxed);
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (!killSamplingThread_) {
+      deadline += samplingInterval_;
+      timing::sleepUntil(deadline);
+
+      std::chrono::steady_clock::time_point sampleTime;
+      try {
+        sampleTime = convert();
+      } catch (const std::exception&) {
+        // A failed transfer (e.g. an interrupted `ioctl`) only drops this sample, as an exception would otherwise terminate the program.
+        continue;
       }
 
-      spi_.set(Spi::Pin::ChipSelect, Spi::Digital::High);
+      ++sampleNumber;
+      sampleBegun_.store(sampleNumber, std::memory_order_relaxed);
+      // Orders the announcement before overwriting the buffer, pairing with the fence in `measureImplementationInto()`.
+      std::atomic_thread_fence(std::memory_order_release);
+      for (std::size_t n = 0; n < numberOfSensors_; ++n) {
+        samples_.at(sampleNumber % 2)[n].store(getConversionResult(n), std::memory_order_relaxed);
+      }
+      sampleTimes_.at(sampleNumber % 2).store(sampleTime.time_since_epoch().count(), std::memory_order_relaxed);
+      sampleCompleted_.store(sampleNumber, std::memory_order_release);
 
-      adcout >>= 1;
+      if (std::chrono::steady_clock::now() - deadline >= samplingInterval_) {
+        deadline = std::chrono::steady_clock::now();
+      }
+    }
+  }
 
-      extensions(n) = static_cast<double>(adcout) / 1023.0;
+  void ExtensionSensors::stopSamplingThread() {
+    if (samplingThread_.joinable()) {
+      killSamplingThread_ = true;
+      samplingThread_.join();
     }
+  }
 
-    return minimalMeasurableValue_ + extensions * (maximalMeasurableValue_ - minimalMeasurableValue_);
+  Spi ExtensionSensors::releaseSpi(
+      ExtensionSensors& extensionSensors) {
+    extensionSensors.stopSamplingThread();
+    return std::move(extensionSensors.spi_);
   }
 }
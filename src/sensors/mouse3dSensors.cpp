@@ -25,8 +25,7 @@ namespace demo {
   Mouse3dSensors::Mouse3dSensors(
       Mouse3dSensors&& mouse3d)
       : Sensors(8, mouse3d.minimalMeasurableValue_, mouse3d.maximalMeasurableValue_) {
-    setMeasurementCorrections(mouse3d.measurementCorrections_);
-    setNumberOfSamplesPerMeasurment(mouse3d.numberOfSamplesPerMeasuement_);
+    moveMeasurementSettings(mouse3d);
     
     fileDescriptor_ = mouse3d.fileDescriptor_;
     mouse3d.fileDescriptor_ = -1;
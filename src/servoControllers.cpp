@@ -2,27 +2,49 @@
 
 // C++ standard library
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <ratio>
 #include <stdexcept>
-#include <thread>
 // IWYU pragma: no_include <ext/alloc_traits.h>
 
+// Demonstrator
+#include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/timing.hpp"
+
 namespace demo {
   ServoControllers::ServoControllers(
       std::vector<Pin>&& directionPins,
       I2c&& i2c,
       const std::vector<unsigned int>& channels,
-      const double maximalSpeed)
-      : numberOfControllers_(directionPins.size()),
+      const double maximalSpeed,
+      const BoardTimings& boardTimings)
+      : ServoControllers(Gpio::allocatePinGroup(std::move(directionPins)), std::move(i2c), channels, maximalSpeed, boardTimings) {
+  }
+
+  ServoControllers::ServoControllers(
+      PinGroup&& directionPins,
+      I2c&& i2c,
+      const std::vector<unsigned int>& channels,
+      const double maximalSpeed,
+      const BoardTimings& boardTimings)
+      : numberOfControllers_(directionPins.getNumberOfPins()),
         directionPins_(std::move(directionPins)),
         i2c_(std::move(i2c)),
+        boardTimings_(boardTimings),
         channels_(channels),
-        maximalSpeed_(maximalSpeed) {
+        maximalSpeed_(maximalSpeed),
+        knownLedRegisters_(0),
+        directions_(0),
+        areDirectionsKnown_(false),
+        isStoppedImmediately_(false),
+        numberOfIssuedRegisterWrites_(0),
+        numberOfSuppressedRegisterWrites_(0) {
     if (numberOfControllers_ == 0) {
       throw std::domain_error("ServoControllers: The number of controllers must be greater than 0.");
-    } else if (directionPins_.size() != numberOfControllers_) {
+    } else if (directionPins_.getNumberOfPins() != numberOfControllers_) {
       throw std::invalid_argument("ServoControllers: The number of direction pins must be equal to the number of controllers.");
     }
     if (channels_.size() != numberOfControllers_) {
@@ -37,15 +59,18 @@ namespace demo {
     i2c_.set(0x00, 0x00);
     unsigned int oldmode = i2c_.get(0x00);
     i2c_.set(0x00, (oldmode & 0x7F) | 0x10);
-    i2c_.set(0xFE, 5);
+    i2c_.set(0xFE, boardTimings_.pwmPrescale);
     i2c_.set(0x00, oldmode);
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    // The oscillator needs to stabilise after waking up, counted from the actual write.
+    i2c_.flush();
+    timing::wait(boardTimings_.pwmOscillatorStartup);
     i2c_.set(0x00, oldmode | 0xa1);
   }
 
   ServoControllers::ServoControllers(
       ServoControllers&& servoControllers)
-      : ServoControllers(std::move(servoControllers.directionPins_), std::move(servoControllers.i2c_), servoControllers.channels_, servoControllers.maximalSpeed_) {
+      : ServoControllers(std::move(servoControllers.directionPins_), std::move(servoControllers.i2c_), servoControllers.channels_, servoControllers.maximalSpeed_, servoControllers.boardTimings_) {
+    isStoppedImmediately_ = servoControllers.isStoppedImmediately_.load();
   }
 
   ServoControllers& ServoControllers::operator=(
@@ -60,6 +85,11 @@ namespace demo {
 
     directionPins_ = std::move(servoControllers.directionPins_);
     i2c_ = std::move(servoControllers.i2c_);
+    boardTimings_ = servoControllers.boardTimings_;
+    // The shadowed values belong to the previously used controllers.
+    knownLedRegisters_ = 0;
+    areDirectionsKnown_ = false;
+    isStoppedImmediately_ = servoControllers.isStoppedImmediately_.load();
 
     return *this;
   }
@@ -75,19 +105,111 @@ namespace demo {
       throw std::domain_error("ServoControllers.run: All speeds must be within [0, 1].");
     }
 
+    if (isStoppedImmediately_) {
+      return;
+    }
+
+    update(forwards, speeds, I2cBus::Priority::Routine);
+
+    // If `stopImmediately()` was called meanwhile, its write might have been executed before the ones above, turning some outputs on again.
+    if (isStoppedImmediately_) {
+      stopImmediately();
+    }
+  }
+
+  void ServoControllers::update(
+      const std::vector<bool>& forwards,
+      const arma::Row<double>& speeds,
+      const I2cBus::Priority priority) {
     const arma::Row<double>& limitedSpeeds = arma::clamp(speeds, 0, maximalSpeed_);
 
+    std::uint32_t directions = 0;
     for (std::size_t n = 0; n < numberOfControllers_; ++n) {
-      directionPins_.at(n).set(forwards.at(n) ? Pin::Digital::Low : Pin::Digital::High);
+      directions |= (forwards.at(n) ? 0u : 1u) << n;
+    }
+    if (!areDirectionsKnown_ || directions != directions_) {
+      directionPins_.write(directions);
+      directions_ = directions;
+      areDirectionsKnown_ = true;
+    }
 
-      i2c_.set(0x06 + 4 * channels_.at(n), 0);
-      i2c_.set(0x07 + 4 * channels_.at(n), 0);
-      i2c_.set(0x08 + 4 * channels_.at(n), static_cast<unsigned int>(4095.0 * limitedSpeeds(n)) & 0xFF);
-      i2c_.set(0x09 + 4 * channels_.at(n), static_cast<unsigned int>(4095.0 * limitedSpeeds(n)) >> 8);
+    // Each output turns on at the beginning of the PWM period and off after its duty cycle.
+    std::uint64_t changedLedRegisters = 0;
+    for (std::size_t n = 0; n < numberOfControllers_; ++n) {
+      const unsigned int dutyCycle = static_cast<unsigned int>(4095.0 * limitedSpeeds(n));
+      const std::array<std::uint8_t, 4> values = {{0, 0, static_cast<std::uint8_t>(dutyCycle & 0xFF), static_cast<std::uint8_t>(dutyCycle >> 8)}};
+      for (unsigned int k = 0; k < 4; ++k) {
+        const unsigned int registerIndex = 4 * channels_.at(n) + k;
+        if (((knownLedRegisters_ >> registerIndex) & 1u) == 0 || ledRegisters_.at(registerIndex) != values.at(k)) {
+          ledRegisters_.at(registerIndex) = values.at(k);
+          changedLedRegisters |= std::uint64_t(1) << registerIndex;
+        }
+      }
     }
+
+    std::uint64_t numberOfIssuedRegisterWrites = 0;
+    std::uint64_t writtenLedRegisters = 0;
+    // Writes each run of changed registers as a single block, relying on the auto-increment bit set by the constructor. Runs separated by up to 2 known registers are merged, as rewriting these is cheaper than the slave address and register number of another transaction.
+    for (unsigned int registerIndex = 0; registerIndex < ledRegisters_.size();) {
+      if (((changedLedRegisters >> registerIndex) & 1u) == 0) {
+        ++registerIndex;
+        continue;
+      }
+
+      unsigned int lastRegisterIndex = registerIndex;
+      for (unsigned int nextRegisterIndex = registerIndex + 1; nextRegisterIndex < ledRegisters_.size() && nextRegisterIndex <= lastRegisterIndex + 3; ++nextRegisterIndex) {
+        if (((knownLedRegisters_ >> nextRegisterIndex) & 1u) == 0 && ((changedLedRegisters >> nextRegisterIndex) & 1u) == 0) {
+          break;
+        } else if (((changedLedRegisters >> nextRegisterIndex) & 1u) != 0) {
+          lastRegisterIndex = nextRegisterIndex;
+        }
+      }
+
+      i2c_.set(0x06 + registerIndex, &ledRegisters_.at(registerIndex), lastRegisterIndex - registerIndex + 1, priority);
+      numberOfIssuedRegisterWrites += lastRegisterIndex - registerIndex + 1;
+      for (; registerIndex <= lastRegisterIndex; ++registerIndex) {
+        writtenLedRegisters |= std::uint64_t(1) << registerIndex;
+      }
+    }
+    knownLedRegisters_ |= changedLedRegisters;
+
+    // Only registers left out of all transactions count as suppressed. Unchanged registers within a merged block were written anyway.
+    std::uint64_t numberOfSuppressedRegisterWrites = 0;
+    for (const auto channel : channels_) {
+      for (unsigned int k = 0; k < 4; ++k) {
+        if (((writtenLedRegisters >> (4 * channel + k)) & 1u) == 0) {
+          ++numberOfSuppressedRegisterWrites;
+        }
+      }
+    }
+
+    numberOfIssuedRegisterWrites_ += numberOfIssuedRegisterWrites;
+    numberOfSuppressedRegisterWrites_ += numberOfSuppressedRegisterWrites;
   }
 
   void ServoControllers::stop() {
-    run(std::vector<bool>(numberOfControllers_, true), arma::zeros<arma::Row<double>>(numberOfControllers_));
+    // Forgets the shadowed values, as `stopImmediately()` overwrote all channels, and in case the controllers were changed by someone else (or reset) meanwhile.
+    knownLedRegisters_ = 0;
+    areDirectionsKnown_ = false;
+    isStoppedImmediately_ = false;
+
+    // Only writes the channels of these controllers, which (on an asynchronous I2C bus) preempts and discards all pending updates.
+    update(std::vector<bool>(numberOfControllers_, true), arma::zeros<arma::Row<double>>(numberOfControllers_), I2cBus::Priority::Stop);
+  }
+
+  bool ServoControllers::stopImmediately() noexcept {
+    // ALL_LED_ON_L, ALL_LED_ON_H, ALL_LED_OFF_L and ALL_LED_OFF_H, loaded into the registers of all 16 channels, with bit 4 of the last one turning the outputs fully off.
+    static const std::array<std::uint8_t, 4> allLedRegisters = {{0, 0, 0, 0x10}};
+
+    isStoppedImmediately_ = true;
+    return i2c_.trySet(0xFA, allLedRegisters.data(), allLedRegisters.size(), I2cBus::Priority::Stop);
+  }
+
+  std::uint64_t ServoControllers::getNumberOfIssuedRegisterWrites() const {
+    return numberOfIssuedRegisterWrites_;
+  }
+
+  std::uint64_t ServoControllers::getNumberOfSuppressedRegisterWrites() const {
+    return numberOfSuppressedRegisterWrites_;
   }
 }
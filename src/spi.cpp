@@ -2,73 +2,336 @@
 #include "demonstrator_bits/config.hpp"
 
 // C++ standard library
+#include <initializer_list>
 #include <iostream>
 #include <stdexcept>
-
-// WiringPi
-#include <wiringPi.h>
+#include <string>
 
 // Demonstrator
 #include "demonstrator_bits/gpio.hpp"
+#include "demonstrator_bits/trace.hpp"
 
 namespace demo {
-  Spi::Spi()
-      : ownsSpi_(true) {}
+  namespace {
+    std::uint8_t reverseBits(
+        std::uint8_t byte) {
+      byte = static_cast<std::uint8_t>(((byte & 0xF0) >> 4) | ((byte & 0x0F) << 4));
+      byte = static_cast<std::uint8_t>(((byte & 0xCC) >> 2) | ((byte & 0x33) << 2));
+      return static_cast<std::uint8_t>(((byte & 0xAA) >> 1) | ((byte & 0x55) << 1));
+    }
+  }
+
+  Spi::Spi(
+      std::vector<::demo::Pin>&& chipSelectPins)
+      : ownsSpi_(true),
+        chipSelectPins_(std::move(chipSelectPins)),
+        chipSelectMasks_({1u << static_cast<unsigned int>(Pin::ChipSelect), 1u << static_cast<unsigned int>(Pin::ChipSelect1)}),
+        spiDeviceHandles_({{-1, -1}}),
+        clockFrequency_(0),
+        mode_(Mode::Mode0),
+        bitOrder_(BitOrder::MostSignificantBitFirst),
+        arePinDirectionsConfigured_(false) {
+    for (const auto& chipSelectPin : chipSelectPins_) {
+      chipSelectMasks_.push_back(1u << chipSelectPin.pinNumber_);
+    }
+  }
 
   Spi::Spi(Spi&& other)
-      : ownsSpi_(other.ownsSpi_) {
+      : ownsSpi_(other.ownsSpi_),
+        chipSelectPins_(std::move(other.chipSelectPins_)),
+        chipSelectMasks_(other.chipSelectMasks_),
+        spiDeviceHandles_(other.spiDeviceHandles_),
+        clockFrequency_(other.clockFrequency_),
+        mode_(other.mode_),
+        bitOrder_(other.bitOrder_),
+        arePinDirectionsConfigured_(other.arePinDirectionsConfigured_) {
     other.ownsSpi_ = false;
+    other.spiDeviceHandles_ = {{-1, -1}};
   }
 
   Spi& Spi::operator=(Spi&& other) {
     if (ownsSpi_) {
+      closeSpiDevices();
       Gpio::deallocate(*this);
     }
 
     ownsSpi_ = other.ownsSpi_;
+    chipSelectPins_ = std::move(other.chipSelectPins_);
+    chipSelectMasks_ = other.chipSelectMasks_;
+    spiDeviceHandles_ = other.spiDeviceHandles_;
+    clockFrequency_ = other.clockFrequency_;
+    mode_ = other.mode_;
+    bitOrder_ = other.bitOrder_;
+    arePinDirectionsConfigured_ = other.arePinDirectionsConfigured_;
 
     other.ownsSpi_ = false;
+    other.spiDeviceHandles_ = {{-1, -1}};
     return *this;
   }
 
   void Spi::set(
       const Pin pin,
       const Spi::Digital value) {
-    if (::demo::isVerbose) {
-      std::cout << "Setting pin " << static_cast<unsigned int>(pin) << " to " << static_cast<unsigned int>(value) << std::endl;
-    }
+    trace::record(trace::Component::Spi, trace::Operation::Set, static_cast<unsigned int>(pin), static_cast<unsigned int>(value));
 
     if (!ownsSpi_) {
       throw std::runtime_error("SPI must be owned to be accessed.");
     }
 
-    ::pinMode(static_cast<int>(pin), OUTPUT);
-    ::digitalWrite(static_cast<int>(pin), static_cast<int>(value));
+    Backend& backend = Gpio::getBackend();
+    backend.setMode(static_cast<unsigned int>(pin), Backend::Mode::Output);
+    arePinDirectionsConfigured_ = false;
+    if (value == Digital::High) {
+      backend.set(1u << static_cast<unsigned int>(pin));
+    } else {
+      backend.clear(1u << static_cast<unsigned int>(pin));
+    }
   }
 
   Spi::Digital Spi::get(
       const Pin pin) {
-    if (::demo::isVerbose) {
-      std::cout << "Reading pin " << static_cast<unsigned int>(pin) << ". ";
+    if (!ownsSpi_) {
+      throw std::runtime_error("SPI must be owned to be accessed.");
+    }
+
+    Backend& backend = Gpio::getBackend();
+    backend.setMode(static_cast<unsigned int>(pin), Backend::Mode::Input);
+    arePinDirectionsConfigured_ = false;
+    Digital output = (backend.get(static_cast<unsigned int>(pin)) ? Digital::High : Digital::Low);
+    trace::record(trace::Component::Spi, trace::Operation::Get, static_cast<unsigned int>(pin), static_cast<unsigned int>(output));
+
+    return output;
+  }
+
+  void Spi::transfer(
+      const std::uint8_t* transmitted,
+      std::uint8_t* received,
+      const std::size_t length) {
+    transfer({{transmitted, received, length}});
+  }
+
+  void Spi::transfer(
+      const std::vector<Backend::SpiTransfer>& transfers) {
+    if (!ownsSpi_) {
+      throw std::runtime_error("SPI must be owned to be accessed.");
+    }
+
+    for (const auto& transfer : transfers) {
+      if (transfer.slave >= chipSelectMasks_.size()) {
+        throw std::invalid_argument("Spi.transfer: The slave must be less than the number of slaves (" + std::to_string(chipSelectMasks_.size()) + ").");
+      }
+      trace::record(trace::Component::Spi, trace::Operation::Transfer, transfer.slave, static_cast<unsigned int>(transfer.length));
+    }
+
+    if (bitOrder_ == BitOrder::MostSignificantBitFirst) {
+      transferMostSignificantBitFirst(transfers);
+      return;
+    }
+
+    // Not all controllers (including the Raspberry Pi's) support sending the least significant bit first, so the bytes are reversed beforehand, respectively afterwards.
+    std::vector<std::vector<std::uint8_t>> reversedBytes;
+    std::vector<Backend::SpiTransfer> reversedTransfers;
+    reversedBytes.reserve(transfers.size());
+    for (const auto& transfer : transfers) {
+      reversedBytes.emplace_back(transfer.length);
+      for (std::size_t n = 0; n < transfer.length; ++n) {
+        reversedBytes.back().at(n) = reverseBits(transfer.transmitted[n]);
+      }
+      reversedTransfers.push_back({reversedBytes.back().data(), (transfer.received != nullptr ? reversedBytes.back().data() : nullptr), transfer.length, transfer.slave});
+    }
+
+    transferMostSignificantBitFirst(reversedTransfers);
+
+    for (std::size_t k = 0; k < transfers.size(); ++k) {
+      if (transfers.at(k).received != nullptr) {
+        for (std::size_t n = 0; n < transfers.at(k).length; ++n) {
+          transfers.at(k).received[n] = reverseBits(reversedBytes.at(k).at(n));
+        }
+      }
     }
+  }
 
+  void Spi::setMode(
+      const Mode mode) {
     if (!ownsSpi_) {
       throw std::runtime_error("SPI must be owned to be accessed.");
     }
 
-    ::pinMode(static_cast<int>(pin), INPUT);
-    Digital output = (::digitalRead(static_cast<int>(pin)) == 0 ? Digital::Low : Digital::High);
+    if (mode == mode_) {
+      return;
+    }
+
+    mode_ = mode;
+    if (spiDeviceHandles_.at(0) != -1) {
+      useSpiDevice(clockFrequency_);
+    }
+  }
+
+  Spi::Mode Spi::getMode() const {
+    return mode_;
+  }
+
+  void Spi::setBitOrder(
+      const BitOrder bitOrder) {
+    bitOrder_ = bitOrder;
+  }
+
+  Spi::BitOrder Spi::getBitOrder() const {
+    return bitOrder_;
+  }
+
+  std::size_t Spi::getNumberOfSlaves() const {
+    return chipSelectMasks_.size();
+  }
+
+  void Spi::useSpiDevice(
+      const unsigned int clockFrequency) {
+    if (!ownsSpi_) {
+      throw std::runtime_error("SPI must be owned to be accessed.");
+    }
+
+    Backend& backend = Gpio::getBackend();
+    const int spiDeviceHandle = backend.openSpiDevice(0, clockFrequency, mode_);
+    closeSpiDevices();
+    spiDeviceHandles_.at(0) = spiDeviceHandle;
+    try {
+      spiDeviceHandles_.at(1) = backend.openSpiDevice(1, clockFrequency, mode_);
+    } catch (const std::runtime_error& exception) {
+      if (::demo::isVerbose) {
+        std::cout << exception.what() << " Bit-banging the transfers to CE1." << std::endl;
+      }
+    }
+    clockFrequency_ = clockFrequency;
+
+    // Reconnects the pins to the controller, in case they were bit-banged before.
+    connectPinsToController();
 
     if (::demo::isVerbose) {
-      std::cout << "Received " << static_cast<unsigned int>(output) << "." << std::endl;
+      std::cout << "Using the hardware SPI controller at " << clockFrequency << "Hz in mode " << static_cast<unsigned int>(mode_) << "." << std::endl;
     }
+  }
 
-    return output;
+  bool Spi::isUsingSpiDevice() const {
+    return spiDeviceHandles_.at(0) != -1;
   }
 
   Spi::~Spi() {
     if (ownsSpi_) {
+      closeSpiDevices();
       Gpio::deallocate(*this);
     }
   }
+
+  void Spi::transferMostSignificantBitFirst(
+      const std::vector<Backend::SpiTransfer>& transfers) {
+    Backend& backend = Gpio::getBackend();
+
+    for (std::size_t n = 0; n < transfers.size();) {
+      const unsigned int slave = transfers.at(n).slave;
+      if (slave >= spiDeviceHandles_.size() || spiDeviceHandles_.at(slave) == -1) {
+        bitBang(transfers.at(n));
+        ++n;
+        continue;
+      }
+
+      // Submits all consecutive transfers to the same slave as a single message.
+      std::size_t end = n + 1;
+      while (end < transfers.size() && transfers.at(end).slave == slave) {
+        ++end;
+      }
+
+      if (arePinDirectionsConfigured_) {
+        connectPinsToController();
+      }
+
+      if (n == 0 && end == transfers.size()) {
+        backend.transferSpi(spiDeviceHandles_.at(slave), transfers);
+      } else {
+        backend.transferSpi(spiDeviceHandles_.at(slave), std::vector<Backend::SpiTransfer>(transfers.cbegin() + static_cast<std::ptrdiff_t>(n), transfers.cbegin() + static_cast<std::ptrdiff_t>(end)));
+      }
+      n = end;
+    }
+  }
+
+  void Spi::bitBang(
+      const Backend::SpiTransfer& transfer) {
+    Backend& backend = Gpio::getBackend();
+
+    const std::uint32_t chipSelectMask = chipSelectMasks_.at(transfer.slave);
+    const std::uint32_t clockMask = 1u << static_cast<unsigned int>(Pin::Clock);
+    const std::uint32_t mosiMask = 1u << static_cast<unsigned int>(Pin::Mosi);
+    const unsigned int misoPinNumber = static_cast<unsigned int>(Pin::Miso);
+
+    // The clock idles high for clock polarity 1 (mode 2 and 3). With clock phase 0 (mode 0 and 2), the data is sampled on the leading clock edge, otherwise on the trailing one.
+    const bool isClockIdleHigh = (static_cast<unsigned int>(mode_) & 0b10) != 0;
+    const bool isSampledOnLeadingEdge = (static_cast<unsigned int>(mode_) & 0b01) == 0;
+    const auto setClockIdle = [&]() {isClockIdleHigh ? backend.set(clockMask) : backend.clear(clockMask);};
+    const auto setClockActive = [&]() {isClockIdleHigh ? backend.clear(clockMask) : backend.set(clockMask);};
+
+    if (!arePinDirectionsConfigured_) {
+      // Deselects all slaves before their chip selects are driven, so that only the selected one answers on MISO.
+      std::uint32_t chipSelectsMask = 0;
+      for (const auto mask : chipSelectMasks_) {
+        chipSelectsMask |= mask;
+      }
+      for (unsigned int pinNumber = 0; pinNumber < 32; ++pinNumber) {
+        if ((chipSelectsMask >> pinNumber) & 1u) {
+          backend.setMode(pinNumber, Backend::Mode::Output);
+        }
+      }
+      backend.set(chipSelectsMask);
+
+      for (const auto pin : {Pin::Mosi, Pin::Clock}) {
+        backend.setMode(static_cast<unsigned int>(pin), Backend::Mode::Output);
+      }
+      backend.setMode(misoPinNumber, Backend::Mode::Input);
+      arePinDirectionsConfigured_ = true;
+    }
+
+    setClockIdle();
+    backend.clear(chipSelectMask);
+
+    for (std::size_t n = 0; n < transfer.length; ++n) {
+      const unsigned int transmitted = transfer.transmitted[n];
+      unsigned int received = 0;
+
+      for (unsigned int bit = 8; bit > 0; --bit) {
+        const bool isHigh = ((transmitted >> (bit - 1)) & 1u) != 0;
+        if (isSampledOnLeadingEdge) {
+          isHigh ? backend.set(mosiMask) : backend.clear(mosiMask);
+          setClockActive();
+          received = (received << 1) | (backend.get(misoPinNumber) ? 1u : 0u);
+          setClockIdle();
+        } else {
+          setClockActive();
+          isHigh ? backend.set(mosiMask) : backend.clear(mosiMask);
+          setClockIdle();
+          received = (received << 1) | (backend.get(misoPinNumber) ? 1u : 0u);
+        }
+      }
+
+      if (transfer.received != nullptr) {
+        transfer.received[n] = static_cast<std::uint8_t>(received);
+      }
+    }
+
+    backend.set(chipSelectMask);
+  }
+
+  void Spi::connectPinsToController() {
+    Backend& backend = Gpio::getBackend();
+    for (const auto pin : {Pin::ChipSelect, Pin::ChipSelect1, Pin::Miso, Pin::Mosi, Pin::Clock}) {
+      backend.setMode(static_cast<unsigned int>(pin), Backend::Mode::Alternate0);
+    }
+    arePinDirectionsConfigured_ = false;
+  }
+
+  void Spi::closeSpiDevices() {
+    for (auto& spiDeviceHandle : spiDeviceHandles_) {
+      if (spiDeviceHandle != -1) {
+        Gpio::getBackend().closeSpiDevice(spiDeviceHandle);
+        spiDeviceHandle = -1;
+      }
+    }
+  }
 }
@@ -0,0 +1,119 @@
+#include "demonstrator_bits/timing.hpp"
+#include "demonstrator_bits/config.hpp"
+
+// C++ standard library
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <ratio>
+
+// Unix library
+#include <time.h>
+
+namespace demo {
+  namespace timing {
+    namespace {
+      std::once_flag isCalibrated;
+      std::atomic<std::chrono::nanoseconds::rep> clockReadDuration(0);
+      std::atomic<std::chrono::nanoseconds::rep> wakeUpLatency(0);
+
+      void sleepUntilUncalibrated(
+          const std::chrono::steady_clock::time_point deadline) {
+        const std::chrono::nanoseconds sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+        struct ::timespec absoluteDeadline;
+        absoluteDeadline.tv_sec = static_cast<decltype(absoluteDeadline.tv_sec)>(sinceEpoch.count() / 1000000000);
+        absoluteDeadline.tv_nsec = static_cast<decltype(absoluteDeadline.tv_nsec)>(sinceEpoch.count() % 1000000000);
+
+        // As the deadline is absolute, an interrupted sleep can simply be restarted with the same arguments.
+        while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &absoluteDeadline, nullptr) == EINTR) {
+        }
+      }
+
+      void measureTiming() {
+        const std::size_t numberOfClockReads = 1000;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t n = 0; n < numberOfClockReads; ++n) {
+          // The result is discarded, as only the time it takes is of interest.
+          static_cast<void>(std::chrono::steady_clock::now());
+        }
+        clockReadDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / static_cast<std::chrono::nanoseconds::rep>(numberOfClockReads);
+
+        // Uses a high percentile instead of the maximum, as a single preemption would otherwise turn every `waitUntil` into a busy-wait.
+        std::array<std::chrono::nanoseconds::rep, 32> overshoots;
+        for (auto& overshoot : overshoots) {
+          const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(100);
+          sleepUntilUncalibrated(deadline);
+          overshoot = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - deadline).count();
+        }
+        std::sort(overshoots.begin(), overshoots.end());
+        wakeUpLatency = overshoots.at(overshoots.size() * 9 / 10);
+
+        if (::demo::isVerbose) {
+          std::cout << "Calibrated timing: Clock read takes " << clockReadDuration << "ns, wake-up latency is " << wakeUpLatency << "ns." << std::endl;
+        }
+      }
+
+      void ensureCalibrated() {
+        std::call_once(isCalibrated, measureTiming);
+      }
+    }
+
+    void calibrate() {
+      // The first calibration shares the once-flag with the automatic one, so that it doesn't measure twice.
+      bool hasMeasured = false;
+      std::call_once(isCalibrated, [&hasMeasured] {
+        measureTiming();
+        hasMeasured = true;
+      });
+
+      if (!hasMeasured) {
+        measureTiming();
+      }
+    }
+
+    std::chrono::nanoseconds getClockReadDuration() {
+      ensureCalibrated();
+      return std::chrono::nanoseconds(clockReadDuration);
+    }
+
+    std::chrono::nanoseconds getWakeUpLatency() {
+      ensureCalibrated();
+      return std::chrono::nanoseconds(wakeUpLatency);
+    }
+
+    void busyWait(
+        const std::chrono::nanoseconds duration) {
+      busyWaitUntil(std::chrono::steady_clock::now() + duration);
+    }
+
+    void busyWaitUntil(
+        const std::chrono::steady_clock::time_point deadline) {
+      // Never stops early, as protocol delays (such as the HC-SR04's trigger pulse) are minimal durations.
+      while (std::chrono::steady_clock::now() < deadline) {
+      }
+    }
+
+    void sleepUntil(
+        const std::chrono::steady_clock::time_point deadline) {
+      sleepUntilUncalibrated(deadline);
+    }
+
+    void waitUntil(
+        const std::chrono::steady_clock::time_point deadline) {
+      const auto wakeUp = deadline - getWakeUpLatency();
+      if (std::chrono::steady_clock::now() < wakeUp) {
+        sleepUntil(wakeUp);
+      }
+      busyWaitUntil(deadline);
+    }
+
+    void wait(
+        const std::chrono::nanoseconds duration) {
+      waitUntil(std::chrono::steady_clock::now() + duration);
+    }
+  }
+}
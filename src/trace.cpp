@@ -0,0 +1,248 @@
+#include "demonstrator_bits/trace.hpp"
+
+// C++ standard library
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace demo {
+  namespace trace {
+    std::atomic<bool> isStarted(false);
+
+    namespace {
+      // The trace file starts with this magic number, followed by the record size (as a 32-bit integer) and all records.
+      const char fileMagicNumber[8] = {'D', 'E', 'M', 'O', 'T', 'R', 'C', '1'};
+
+      std::mutex mutex;
+      std::vector<std::shared_ptr<Ring>> rings;
+      std::uint32_t numberOfThreads = 0;
+      // Dropped records of rings that were already removed, as their thread exited.
+      std::uint64_t numberOfDroppedRecordsOfRemovedRings = 0;
+
+      std::mutex drainMutex;
+      std::condition_variable drainCondition;
+      bool killDrainThread = false;
+      std::thread drainThread;
+      std::ofstream file;
+
+      /**
+       * Writes the records of all rings to the file and removes the rings of exited threads. Must be called while holding `drainMutex`.
+       */
+      void drainRings() {
+        std::vector<Record> records;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          for (auto ring = rings.begin(); ring != rings.end();) {
+            (*ring)->drain(records);
+
+            // Only the registry holds the ring, after its thread exited.
+            if (ring->use_count() == 1) {
+              numberOfDroppedRecordsOfRemovedRings += (*ring)->getNumberOfDroppedRecords();
+              ring = rings.erase(ring);
+            } else {
+              ++ring;
+            }
+          }
+        }
+
+        if (!records.empty()) {
+          file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+          file.flush();
+        }
+      }
+
+      void runDrainThread(
+          const std::chrono::milliseconds drainInterval) {
+        std::unique_lock<std::mutex> lock(drainMutex);
+        while (!killDrainThread) {
+          drainCondition.wait_for(lock, drainInterval);
+          drainRings();
+        }
+      }
+    }
+
+    Ring::Ring(
+        const std::uint32_t threadNumber)
+        : threadNumber_(threadNumber),
+          head_(0),
+          tail_(0),
+          numberOfDroppedRecords_(0) {}
+
+    std::size_t Ring::drain(
+        std::vector<Record>& records) {
+      const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+      const std::uint64_t head = head_.load(std::memory_order_acquire);
+
+      for (std::uint64_t n = tail; n < head; ++n) {
+        records.push_back(records_[n % CAPACITY]);
+      }
+      // Releases the drained slots to the producer.
+      tail_.store(head, std::memory_order_release);
+
+      return static_cast<std::size_t>(head - tail);
+    }
+
+    void Ring::clear() {
+      tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+      numberOfDroppedRecords_.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t Ring::getNumberOfDroppedRecords() const {
+      return numberOfDroppedRecords_.load(std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<Ring> registerThread() {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      std::shared_ptr<Ring> ring = std::make_shared<Ring>(numberOfThreads++);
+      rings.push_back(ring);
+      return ring;
+    }
+
+    void start(
+        const std::string& path,
+        const std::chrono::milliseconds drainInterval) {
+#if defined(USE_TRACE)
+      std::lock_guard<std::mutex> lock(drainMutex);
+
+      if (drainThread.joinable()) {
+        throw std::logic_error("trace.start: Tracing was already started.");
+      }
+
+      file.open(path, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        file.clear();
+        throw std::runtime_error("trace.start: Could not open " + path + ".");
+      }
+      const std::uint32_t recordSize = sizeof(Record);
+      file.write(fileMagicNumber, sizeof(fileMagicNumber));
+      file.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+
+      {
+        // Discards everything recorded before, e.g. by threads that passed the check in `record()` while the previous trace was stopped.
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& ring : rings) {
+          ring->clear();
+        }
+        numberOfDroppedRecordsOfRemovedRings = 0;
+      }
+
+      if (::demo::isVerbose) {
+        std::cout << "Tracing to " << path << "." << std::endl;
+      }
+
+      killDrainThread = false;
+      isStarted = true;
+      drainThread = std::thread(runDrainThread, drainInterval);
+#else
+      static_cast<void>(path);
+      static_cast<void>(drainInterval);
+      throw std::logic_error("trace.start: The Demonstrator library must be built with `USE_TRACE` to record traces.");
+#endif
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        if (!drainThread.joinable()) {
+          return;
+        }
+
+        isStarted = false;
+        killDrainThread = true;
+      }
+      drainCondition.notify_one();
+      drainThread.join();
+
+      std::lock_guard<std::mutex> lock(drainMutex);
+      // Drains the records pushed after the last interval.
+      drainRings();
+      file.close();
+
+      if (::demo::isVerbose) {
+        std::cout << "Stopped tracing (" << getNumberOfDroppedRecords() << " records dropped)." << std::endl;
+      }
+    }
+
+    std::uint64_t getNumberOfDroppedRecords() {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      std::uint64_t numberOfDroppedRecords = numberOfDroppedRecordsOfRemovedRings;
+      for (const auto& ring : rings) {
+        numberOfDroppedRecords += ring->getNumberOfDroppedRecords();
+      }
+
+      return numberOfDroppedRecords;
+    }
+
+    std::vector<Record> readFile(
+        const std::string& path) {
+      std::ifstream input(path, std::ios::binary);
+      if (!input) {
+        throw std::runtime_error("trace.readFile: Could not open " + path + ".");
+      }
+
+      char magicNumber[sizeof(fileMagicNumber)];
+      std::uint32_t recordSize = 0;
+      input.read(magicNumber, sizeof(magicNumber));
+      input.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+      if (!input || std::memcmp(magicNumber, fileMagicNumber, sizeof(fileMagicNumber)) != 0 || recordSize != sizeof(Record)) {
+        throw std::runtime_error("trace.readFile: " + path + " is not a trace file (or was written by an incompatible version).");
+      }
+
+      const std::vector<char> content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+      // A truncated last record (e.g. if the traced program crashed while writing it) is ignored.
+      std::vector<Record> records(content.size() / sizeof(Record));
+      std::memcpy(records.data(), content.data(), records.size() * sizeof(Record));
+
+      // Each ring is drained in order, but the rings of different threads are interleaved per drain.
+      std::stable_sort(records.begin(), records.end(), [](const Record& first, const Record& second) {
+        return first.timestamp < second.timestamp;
+      });
+
+      return records;
+    }
+
+    std::string getComponentName(
+        const Component component) {
+      switch (component) {
+        case Component::Pin:
+          return "Pin";
+        case Component::Spi:
+          return "SPI";
+        case Component::I2c:
+          return "I2C";
+        case Component::PinGroup:
+          return "Pin group";
+      }
+
+      return "Unknown (" + std::to_string(static_cast<unsigned int>(component)) + ")";
+    }
+
+    std::string getOperationName(
+        const Operation operation) {
+      switch (operation) {
+        case Operation::Set:
+          return "Set";
+        case Operation::Get:
+          return "Get";
+        case Operation::WaitForSignalEdge:
+          return "Wait for signal edge";
+        case Operation::SignalEdge:
+          return "Signal edge";
+        case Operation::Timeout:
+          return "Timeout";
+        case Operation::Transfer:
+          return "Transfer";
+      }
+
+      return "Unknown (" + std::to_string(static_cast<unsigned int>(operation)) + ")";
+    }
+  }
+}